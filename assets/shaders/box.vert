@@ -0,0 +1,51 @@
+#version 450
+
+// Scene boxes pulled from the culling output list, 36 vertices per box
+
+struct Box {
+    vec4 center;
+    vec4 halfExtent;
+};
+
+layout(std430, binding = 0) readonly buffer Boxes { Box boxes[]; };
+layout(std430, binding = 3) readonly buffer Lists { uint lists[]; };
+
+layout(push_constant) uniform Parameters {
+    mat4 viewProjection;
+    uint listOffset;
+};
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec3 fragColor;
+layout(location = 2) out vec3 fragPosition;
+
+// Corner i is at (i & 1, i & 2, i & 4) on the x, y and z axes, faces are counter clockwise seen from outside
+const int indices[36] = int[](
+    1, 3, 7, 1, 7, 5,
+    0, 6, 2, 0, 4, 6,
+    2, 6, 7, 2, 7, 3,
+    0, 1, 5, 0, 5, 4,
+    4, 5, 7, 4, 7, 6,
+    0, 3, 1, 0, 2, 3
+);
+
+const vec3 normals[6] = vec3[](
+    vec3(1.0, 0.0, 0.0),
+    vec3(-1.0, 0.0, 0.0),
+    vec3(0.0, 1.0, 0.0),
+    vec3(0.0, -1.0, 0.0),
+    vec3(0.0, 0.0, 1.0),
+    vec3(0.0, 0.0, -1.0)
+);
+
+void main() {
+    const Box box = boxes[lists[listOffset + gl_VertexIndex / 36]];
+    const int vertex = gl_VertexIndex % 36;
+    const int corner = indices[vertex];
+    const vec3 position = vec3((corner & 1) != 0 ? 1.0 : -1.0, (corner & 2) != 0 ? 1.0 : -1.0, (corner & 4) != 0 ? 1.0 : -1.0);
+
+    fragPosition = box.center.xyz + position * box.halfExtent.xyz;
+    gl_Position = viewProjection * vec4(fragPosition, 1.0);
+    fragNormal = normals[vertex / 6];
+    fragColor = unpackUnorm4x8(floatBitsToUint(box.halfExtent.w)).rgb;
+}
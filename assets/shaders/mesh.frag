@@ -0,0 +1,72 @@
+#version 450
+
+layout(location = 0) in vec3 fragNormal;
+layout(location = 1) in vec3 fragColor;
+layout(location = 2) in vec3 fragPosition;
+
+layout(location = 0) out vec4 outColor;
+
+// Lighting model the pipeline is specialized with: 0 unlit, 1 directional, 2 directional and clustered lights
+layout(constant_id = 0) const uint LightingModel = 2;
+
+// Clustered lights, see light_cluster.comp
+const uint MaxLightsPerCluster = 128;
+
+struct Light {
+    vec4 positionRange;
+    vec4 colorSpotCosine;
+    vec4 direction;
+};
+
+layout(std140, set = 0, binding = 0) uniform Parameters {
+    mat4 view;
+    vec4 projection;
+    uvec4 grid;
+    vec4 screen;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Lights { Light lights[]; };
+layout(std430, set = 0, binding = 2) readonly buffer Counts { uint counts[]; };
+layout(std430, set = 0, binding = 3) readonly buffer Indices { uint indices[]; };
+
+vec3 clusteredLighting(const vec3 position, const vec3 normal) {
+    const float depth = -(view * vec4(position, 1.0)).z;
+    const uvec2 tile = min(uvec2(gl_FragCoord.xy / screen.xy * vec2(grid.xy)), grid.xy - 1);
+    const uint slice = uint(clamp(log(max(depth, projection.z)) * screen.z + screen.w, 0.0, float(grid.z - 1)));
+    const uint cluster = tile.x + grid.x * (tile.y + grid.y * slice);
+
+    vec3 color = vec3(0.0);
+
+    for (uint i = 0; i != counts[cluster]; ++i) {
+        const Light light = lights[indices[cluster * MaxLightsPerCluster + i]];
+        const vec3 toLight = light.positionRange.xyz - position;
+        const float lightDistance = length(toLight);
+        const vec3 direction = toLight / max(lightDistance, 1e-4);
+
+        // Smooth falloff to zero at the range, and to the cone edge for spot lights
+        const float falloff = clamp(1.0 - lightDistance / light.positionRange.w, 0.0, 1.0);
+        const float cosine = light.colorSpotCosine.w;
+        const float cone = cosine <= -1.0 ? 1.0 : smoothstep(cosine, mix(cosine, 1.0, 0.2), dot(-direction, light.direction.xyz));
+
+        color += light.colorSpotCosine.rgb * max(dot(normal, direction), 0.0) * falloff * falloff * cone;
+    }
+
+    return color;
+}
+
+void main() {
+    const vec3 normal = normalize(fragNormal);
+    const vec3 lightDirection = normalize(vec3(0.4, 1.0, 0.6));
+    vec3 light = vec3(1.0);
+
+    // Branches on the constant are removed when the pipeline is created
+    if (LightingModel >= 1) {
+        light = vec3(0.35 + 0.65 * max(dot(normal, lightDirection), 0.0));
+    }
+
+    if (LightingModel >= 2) {
+        light += clusteredLighting(fragPosition, normal);
+    }
+
+    outColor = vec4(fragColor * light, 1.0);
+}
@@ -0,0 +1,23 @@
+#version 450
+
+// Model instances, placed by a position and a uniform scale
+
+layout(push_constant) uniform Parameters {
+    mat4 viewProjection;
+};
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec4 instancePositionScale;
+layout(location = 3) in vec4 instanceColor;
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec3 fragColor;
+layout(location = 2) out vec3 fragPosition;
+
+void main() {
+    fragPosition = instancePositionScale.xyz + instancePositionScale.w * inPosition;
+    gl_Position = viewProjection * vec4(fragPosition, 1.0);
+    fragNormal = inNormal;
+    fragColor = instanceColor.rgb;
+}
@@ -0,0 +1,14 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec2 fragOffset;
+layout(location = 1) in float fragAge;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    float falloff = max(1.0 - dot(fragOffset, fragOffset), 0.0);
+    vec3 color = mix(vec3(1.0, 0.8, 0.3), vec3(0.8, 0.1, 0.05), fragAge);
+
+    outColor = vec4(color * (1.0 - fragAge), falloff);
+}
@@ -0,0 +1,46 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+struct Particle {
+    vec4 position;
+    vec4 velocity;
+};
+
+layout(std430, binding = 0) readonly buffer Particles {
+    Particle particles[];
+};
+
+layout(std430, binding = 1) readonly buffer Alive {
+    uint alive[];
+};
+
+// Particle half size in normalized device coordinates
+layout(push_constant) uniform Constants {
+    vec2 scale;
+} constants;
+
+layout(location = 0) out vec2 fragOffset;
+layout(location = 1) out float fragAge;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+const vec2 corners[6] = vec2[](
+    vec2(-1.0, -1.0),
+    vec2(1.0, -1.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(-1.0, 1.0),
+    vec2(-1.0, -1.0)
+);
+
+// Vertices are pulled from the alive list, six per particle
+void main() {
+    Particle particle = particles[alive[gl_VertexIndex / 6]];
+    vec2 corner = corners[gl_VertexIndex % 6];
+
+    gl_Position = vec4(particle.position.xy + corner * constants.scale, 0.0, 1.0);
+    fragOffset = corner;
+    fragAge = clamp(particle.position.w / particle.velocity.w, 0.0, 1.0);
+}
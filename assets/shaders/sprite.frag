@@ -0,0 +1,20 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 0) uniform sampler2D atlas;
+
+layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) in vec4 fragColor;
+
+layout(location = 0) out vec4 outColor;
+
+// Opaque sprites discard their transparent texels instead of blending them
+layout(constant_id = 1) const uint AlphaTest = 0;
+
+void main() {
+    outColor = texture(atlas, fragTexCoord) * fragColor;
+
+    if (AlphaTest != 0 && outColor.a < 0.5) {
+        discard;
+    }
+}
\ No newline at end of file
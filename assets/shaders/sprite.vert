@@ -0,0 +1,24 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Pixels to normalized device coordinates
+layout(push_constant) uniform Constants {
+    vec2 scale;
+} constants;
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in vec4 inColor;
+
+layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) out vec4 fragColor;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+void main() {
+    gl_Position = vec4(inPosition * constants.scale - 1.0, 0.0, 1.0);
+    fragTexCoord = inTexCoord;
+    fragColor = inColor;
+}
\ No newline at end of file
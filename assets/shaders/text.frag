@@ -0,0 +1,18 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 0) uniform sampler2D atlas;
+
+layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) in vec4 fragColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // The glyph edge is at 0.5, smoothed over about one screen pixel whatever the text size
+    float distance = texture(atlas, fragTexCoord).r;
+    float width = max(fwidth(distance), 1e-4) * 0.75;
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+
+    outColor = vec4(fragColor.rgb, fragColor.a * alpha);
+}
\ No newline at end of file
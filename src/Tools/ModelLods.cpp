@@ -0,0 +1,35 @@
+#include "Utilities/Model.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+// Build time step of the model assets: import an OBJ file, generate its levels of detail and write them
+// where Utilities::Model::Load looks for them.
+int main(const int argc, const char* argv[]) {
+	if (argc != 3) {
+		std::cerr << "usage: " << argv[0] << " <model.obj> <model.obj.lod>" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	try {
+		auto model = Utilities::Model::ImportObj(argv[1]);
+		model.GenerateLods();
+		model.WriteLods(argv[2]);
+
+		std::cout << argv[1] << ":";
+		for (const auto& lod : model.Lods()) {
+			std::cout << " " << lod.IndexCount / 3;
+		}
+		std::cout << " triangles" << std::endl;
+
+		if (model.Lods().size() < Utilities::Model::MinLods)
+			std::cerr << "WARNING: " << argv[1] << " cannot be simplified past " << model.Lods().size() << " levels of detail" << std::endl;
+	}
+	catch (const std::exception& exception) {
+		std::cerr << "FATAL: " << exception.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -1,5 +1,23 @@
 #include "TriangleApp.hpp"
 
+#include "Vulkan/ClusteredLighting.hpp"
+#include "Vulkan/LodMesh.hpp"
+#include "Vulkan/SpriteAtlas.hpp"
+#include "Vulkan/SpriteBatch.hpp"
+#include "Vulkan/SwapChain.hpp"
+#include "Vulkan/TextRenderer.hpp"
+
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string>
+#include <vector>
+
 namespace
 {
 	const bool EnableValidationLayers =
@@ -8,12 +26,250 @@ namespace
 #else
 		true;
 #endif
+
+	constexpr uint32_t SpriteImageSize = 32;
+	constexpr float SpriteSize = 8.0f;
+	// One sprite in that many is labelled when a font is set
+	constexpr uint32_t LabelInterval = 16;
+
+	// White shape with an antialiased edge, the sprite color tints it. Covered between the inner and outer radius.
+	std::vector<unsigned char> SpriteImage(const float innerRadius, const float outerRadius) {
+		std::vector<unsigned char> pixels(SpriteImageSize * SpriteImageSize * 4);
+		const float center = SpriteImageSize * 0.5f;
+
+		for (uint32_t y = 0; y != SpriteImageSize; ++y) {
+			for (uint32_t x = 0; x != SpriteImageSize; ++x) {
+				const float distance = std::hypot(x + 0.5f - center, y + 0.5f - center) / center;
+				const float coverage = std::fmin(std::fmax(std::fmin(outerRadius - distance, distance - innerRadius) * center, 0.0f), 1.0f);
+
+				unsigned char* const pixel = &pixels[(y * SpriteImageSize + x) * 4];
+				pixel[0] = pixel[1] = pixel[2] = 255;
+				pixel[3] = static_cast<unsigned char>(coverage * 255.0f);
+			}
+		}
+
+		return pixels;
+	}
+
+	// Distance between two city blocks, buildings take most of it and leave streets in between
+	constexpr float BlockSize = 6.0f;
+
+	// Model instances, scaled to a unit bounding sphere, per side of their grid and distance between them
+	constexpr uint32_t ModelGridSize = 64;
+	constexpr float ModelSpacing = 3.0f;
+
+	float Random(uint32_t x) {
+		x ^= x >> 16;
+		x *= 0x7feb352du;
+		x ^= x >> 15;
+		x *= 0x846ca68bu;
+		x ^= x >> 16;
+		return static_cast<float>(x) / 4294967296.0f;
+	}
+
+	uint32_t SpriteColor(const uint32_t i) {
+		const uint32_t r = 128 + (i * 37) % 128;
+		const uint32_t g = 128 + (i * 73) % 128;
+		const uint32_t b = 128 + (i * 151) % 128;
+		return 0xFF000000 | (b << 16) | (g << 8) | r;
+	}
 }
 
-TriangleApp::TriangleApp(const Vulkan::WindowConfig& windowConfig) :
-	Vulkan::Application("Vulkan triangle test", windowConfig, VK_PRESENT_MODE_MAILBOX_KHR, EnableValidationLayers)
+// Low latency pacing relies on FIFO presentation, images are then never discarded and present waits are meaningful
+TriangleApp::TriangleApp(const Vulkan::WindowConfig& windowConfig, const bool lowLatency, const bool hostAllocator) :
+	Vulkan::Application("Vulkan triangle test", windowConfig, lowLatency ? VK_PRESENT_MODE_FIFO_KHR : VK_PRESENT_MODE_MAILBOX_KHR, EnableValidationLayers, lowLatency, hostAllocator),
+	start_(std::chrono::steady_clock::now())
 {}
 
 TriangleApp::~TriangleApp() {
 	TriangleApp::DeleteSwapChain();
 }
+
+void TriangleApp::SetCitySize(const uint32_t size) {
+	if (size == 0)
+		return;
+
+	// Mostly low buildings and a few towers, the same city on every run
+	std::vector<Vulkan::OcclusionCulling::Box> boxes;
+	boxes.reserve(size_t(size) * size);
+	cityExtent_ = size * BlockSize;
+
+	for (uint32_t z = 0; z != size; ++z) {
+		for (uint32_t x = 0; x != size; ++x) {
+			const uint32_t i = z * size + x;
+			const float height = 2.0f + 28.0f * std::pow(Random(3 * i), 3.0f);
+			const float shade = 0.5f + 0.5f * Random(3 * i + 1);
+			const float width = 2.0f + 0.5f * Random(3 * i + 2);
+
+			Vulkan::OcclusionCulling::Box box = {};
+			box.Center[0] = (static_cast<float>(x) + 0.5f) * BlockSize - 0.5f * cityExtent_;
+			box.Center[1] = height;
+			box.Center[2] = (static_cast<float>(z) + 0.5f) * BlockSize - 0.5f * cityExtent_;
+			box.HalfExtent[0] = width;
+			box.HalfExtent[1] = height;
+			box.HalfExtent[2] = width;
+			box.Color = 0xFF000000 | static_cast<uint32_t>(shade * 255.0f) * 0x010101;
+			boxes.push_back(box);
+		}
+	}
+
+	SetSceneBoxes(std::move(boxes));
+}
+
+void TriangleApp::OnDeviceSet() {
+	if (spriteCount_ == 0)
+		return;
+
+	spriteAtlas_.reset(new Vulkan::SpriteAtlas(Device(), 128));
+
+	const auto disc = SpriteImage(-1.0f, 1.0f);
+	const auto ring = SpriteImage(0.6f, 1.0f);
+	spriteAtlas_->Add(SpriteImageSize, SpriteImageSize, disc.data());
+	spriteAtlas_->Add(SpriteImageSize, SpriteImageSize, ring.data());
+
+	spriteAtlas_->Build(CommandPool());
+}
+
+void TriangleApp::Render(VkCommandBuffer commandBuffer, const uint32_t imageIndex) {
+	if (spriteAtlas_) {
+		const float time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start_).count();
+		const auto extent = SwapChain().Extent();
+		const float width = static_cast<float>(extent.width) - SpriteSize;
+		const float height = static_cast<float>(extent.height) - SpriteSize;
+
+		// Discs are alpha blended, rings added on top of them: two draws whatever the count
+		for (uint32_t i = 0; i != spriteCount_; ++i) {
+			const float phase = static_cast<float>(i) * 0.618f;
+			const float x = 0.5f + 0.5f * std::sin(time * (0.3f + 0.0001f * (i % 977)) + phase);
+			const float y = 0.5f + 0.5f * std::cos(time * (0.2f + 0.0001f * (i % 613)) + phase * 1.3f);
+			const bool isRing = i % 4 == 0;
+
+			Sprites().Draw(
+				isRing ? 1 : 0, *spriteAtlas_, isRing ? 1 : 0, { x * width, y * height, SpriteSize, SpriteSize },
+				SpriteColor(i), isRing ? Vulkan::BlendMode::Additive : Vulkan::BlendMode::Alpha);
+
+			// Label strings are stable, they are shaped once and then reused from the run cache
+			if (HasText() && i % LabelInterval == 0)
+				Text().Draw(std::to_string(i), x * width + SpriteSize, y * height, 10.0f, SpriteColor(i));
+		}
+
+		if (HasText())
+			Text().Draw(std::to_string(spriteCount_) + " sprites", 10.0f, static_cast<float>(extent.height) - 12.0f, 20.0f);
+	}
+
+	if (HasSceneBoxes() || HasModel()) {
+		const float time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start_).count();
+		const auto extent = SwapChain().Extent();
+		const float gridExtent = ModelGridSize * ModelSpacing;
+		glm::mat4 view;
+		float farPlane;
+
+		if (HasSceneBoxes()) {
+			// Low over the streets, looking across the city
+			const float angle = 0.05f * time;
+			const float radius = 0.4f * cityExtent_;
+
+			const glm::vec3 eye(radius * std::cos(angle), 4.0f, radius * std::sin(angle));
+			view = glm::lookAt(eye, glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			farPlane = 2.0f * cityExtent_;
+		}
+		else {
+			// Swaying in front of the model grid, looking down its length
+			const glm::vec3 eye(0.25f * gridExtent * std::sin(0.1f * time), 3.0f, -4.0f);
+			view = glm::lookAt(eye, glm::vec3(0.0f, 0.0f, 0.5f * gridExtent), glm::vec3(0.0f, 1.0f, 0.0f));
+			farPlane = 2.0f * gridExtent;
+		}
+
+		glm::mat4 projection = glm::perspective(glm::radians(60.0f), static_cast<float>(extent.width) / static_cast<float>(extent.height), 0.5f, farPlane);
+		// Clip space y points down
+		projection[1][1] *= -1.0f;
+
+		std::array<float, 16> viewMatrix;
+		std::array<float, 16> projectionMatrix;
+		std::copy_n(glm::value_ptr(view), viewMatrix.size(), viewMatrix.begin());
+		std::copy_n(glm::value_ptr(projection), projectionMatrix.size(), projectionMatrix.begin());
+		SetCamera(viewMatrix, projectionMatrix);
+
+		if (HasLighting() && lightCount_ != 0) {
+			// Scattered over the city or the model grid, each one circling around its own spot.
+			// One in four is a spot light pointing down.
+			const float areaWidth = HasSceneBoxes() ? cityExtent_ : gridExtent;
+			const float areaStart = HasSceneBoxes() ? -0.5f * cityExtent_ : 0.0f;
+
+			for (uint32_t i = 0; i != lightCount_; ++i) {
+				const float angle = time * (0.5f + Random(4 * i)) + 6.2831853f * Random(4 * i + 1);
+				const float hue = Random(4 * i + 2);
+				const bool isSpot = i % 4 == 0;
+
+				Vulkan::ClusteredLighting::Light light = {};
+				light.Position[0] = (Random(4 * i + 3) - 0.5f) * areaWidth + 1.5f * std::cos(angle);
+				light.Position[1] = isSpot ? 6.0f : 1.5f + 2.0f * Random(4 * i);
+				light.Position[2] = areaStart + Random(4 * i + 3 + 0x80000000u) * areaWidth + 1.5f * std::sin(angle);
+				light.Range = isSpot ? 10.0f : 5.0f;
+				light.Color[0] = 0.6f + 0.4f * std::cos(6.2831853f * hue);
+				light.Color[1] = 0.6f + 0.4f * std::cos(6.2831853f * (hue - 0.33f));
+				light.Color[2] = 0.6f + 0.4f * std::cos(6.2831853f * (hue - 0.67f));
+				light.SpotCosine = isSpot ? 0.85f : -1.0f;
+				light.Direction[1] = -1.0f;
+				Lights().Add(light);
+			}
+
+			if (HasText())
+				Text().Draw(std::to_string(Lights().LightCount()) + " lights", 10.0f, 72.0f, 20.0f);
+		}
+
+		if (HasModel()) {
+			// Queued again every frame, the level of each instance is picked when the mesh renders
+			const float scale = 1.0f / Models().Radius();
+
+			for (uint32_t z = 0; z != ModelGridSize; ++z) {
+				for (uint32_t x = 0; x != ModelGridSize; ++x) {
+					const uint32_t i = z * ModelGridSize + x;
+					const float shade = 0.6f + 0.4f * Random(i);
+
+					Vulkan::LodMesh::Instance instance = {};
+					instance.Position[0] = (static_cast<float>(x) + 0.5f) * ModelSpacing - 0.5f * gridExtent;
+					instance.Position[1] = 1.0f;
+					instance.Position[2] = static_cast<float>(z) * ModelSpacing;
+					instance.Scale = scale;
+					instance.Color = 0xFF000000 | static_cast<uint32_t>(shade * 255.0f) * 0x010101;
+					Models().Draw(instance);
+				}
+			}
+
+			if (HasText()) {
+				std::string counts;
+				for (const auto count : Models().LodInstanceCounts()) {
+					counts += " " + std::to_string(count);
+				}
+
+				Text().Draw(std::to_string(ModelGridSize * ModelGridSize) + " models, per level:" + counts, 10.0f, 48.0f, 20.0f);
+			}
+		}
+
+		if (HasSceneBoxes() && HasText()) {
+			const auto& statistics = SceneBoxStatistics();
+			Text().Draw(
+				std::to_string(statistics.Objects) + " buildings, " +
+				std::to_string(statistics.FirstPhase) + " + " + std::to_string(statistics.SecondPhase) + " drawn, " +
+				std::to_string(statistics.Culled()) + " culled",
+				10.0f, 24.0f, 20.0f);
+		}
+	}
+
+	Application::Render(commandBuffer, imageIndex);
+}
+
+void TriangleApp::OnKey(const int key, const int scancode, const int action, const int mods) {
+	Application::OnKey(key, scancode, action, mods);
+
+	if (action != GLFW_PRESS)
+		return;
+
+	switch (key) {
+	case GLFW_KEY_F2:
+		isWireFrame_ = !isWireFrame_;
+		break;
+	default:;
+	}
+}
@@ -2,12 +2,43 @@
 
 #include "Vulkan/Application.hpp"
 
+#include <chrono>
+#include <memory>
+
+namespace Vulkan {
+	class SpriteAtlas;
+}
+
 class TriangleApp : public Vulkan::Application {
 public:
 
 	VULKAN_NON_COPIABLE(TriangleApp);
 
-	TriangleApp(const Vulkan::WindowConfig& windowConfig);
+	TriangleApp(const Vulkan::WindowConfig& windowConfig, bool lowLatency, bool hostAllocator);
 	~TriangleApp();
+
+	// Sprites drawn over the triangle every frame, to stress the sprite batch; must be set before the physical device
+	void SetSpriteCount(const uint32_t count) { spriteCount_ = count; }
+
+	// A grid of size x size buildings seen from an orbiting camera, most of them hidden by the nearer ones;
+	// must be set before the physical device
+	void SetCitySize(uint32_t size);
+
+	// Point and spot lights drifting over the city or the model grid; must be set before the physical device
+	void SetLightCount(const uint32_t count) { lightCount_ = count; }
+
+protected:
+
+	void OnDeviceSet() override;
+	void Render(VkCommandBuffer commandBuffer, uint32_t imageIndex) override;
+	void OnKey(int key, int scancode, int action, int mods) override;
+
+private:
+
+	std::unique_ptr<Vulkan::SpriteAtlas> spriteAtlas_;
+	uint32_t spriteCount_{};
+	float cityExtent_{};
+	uint32_t lightCount_{};
+	const std::chrono::steady_clock::time_point start_;
 };
 
@@ -0,0 +1,362 @@
+#include "Log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef WIN32
+#include <Windows.h>
+#endif
+
+namespace Utilities {
+
+	namespace {
+
+		const char* SeverityName(const Severity severity) {
+			switch (severity) {
+			case Severity::Verbose:
+				return "VERBOSE";
+			case Severity::Info:
+				return "INFO";
+			case Severity::Warning:
+				return "WARNING";
+			case Severity::Error:
+				return "ERROR";
+			case Severity::Fatal:
+				return "FATAL";
+			default:
+				return "UNKNOWN";
+			}
+		}
+
+		int SetColorBySeverity(const Severity severity) noexcept {
+#ifdef WIN32
+			const HANDLE hConsole = GetStdHandle(STD_ERROR_HANDLE);
+
+			CONSOLE_SCREEN_BUFFER_INFO info = {};
+			GetConsoleScreenBufferInfo(hConsole, &info);
+
+			switch (severity) {
+			case Severity::Verbose:
+				SetConsoleTextAttribute(hConsole, FOREGROUND_INTENSITY);
+				break;
+			case Severity::Info:
+				SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+				break;
+			case Severity::Warning:
+				SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+				break;
+			case Severity::Error:
+				SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_INTENSITY);
+				break;
+			case Severity::Fatal:
+				SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_INTENSITY);
+				break;
+			default:;
+			}
+
+			return info.wAttributes;
+#else
+			(void)severity;
+			return 0;
+#endif
+		}
+
+		void SetColorByAttributes(const int attributes) noexcept {
+#ifdef WIN32
+			const HANDLE hConsole = GetStdHandle(STD_ERROR_HANDLE);
+			SetConsoleTextAttribute(hConsole, static_cast<WORD>(attributes));
+#else
+			(void)attributes;
+#endif
+		}
+
+		// Single producer (the owning thread) / single consumer (whoever holds the writer lock) ring of records
+		class ThreadBuffer final {
+		public:
+
+			using Slot = std::aligned_storage_t<Log::RecordSize, alignof(std::max_align_t)>;
+
+			ThreadBuffer() : slots_(new Slot[Log::RecordsPerThread]) {}
+
+			void* Begin() {
+				const size_t write = write_.load(std::memory_order_relaxed);
+				if (write - read_.load(std::memory_order_acquire) == Log::RecordsPerThread)
+					return nullptr;
+
+				return &slots_[write % Log::RecordsPerThread];
+			}
+
+			void Commit() {
+				write_.store(write_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			}
+
+			void* Front() {
+				const size_t read = read_.load(std::memory_order_relaxed);
+				if (read == write_.load(std::memory_order_acquire))
+					return nullptr;
+
+				return &slots_[read % Log::RecordsPerThread];
+			}
+
+			void Pop() {
+				read_.store(read_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			}
+
+			bool IsEmpty() const {
+				return read_.load(std::memory_order_acquire) == write_.load(std::memory_order_acquire);
+			}
+
+			// Set once the owning thread has exited, the buffer is released after its last records are written
+			std::atomic<bool> Retired{};
+
+		private:
+
+			const std::unique_ptr<Slot[]> slots_;
+			alignas(64) std::atomic<size_t> write_{};
+			alignas(64) std::atomic<size_t> read_{};
+		};
+
+		class Writer final {
+		public:
+
+			Writer() :
+				start_(std::chrono::steady_clock::now()),
+				thread_([this]() { Run(); })
+			{
+			}
+
+			~Writer() {
+				running_ = false;
+				wakeUp_.notify_one();
+				thread_.join();
+
+				Drain();
+			}
+
+			static Writer& Instance() {
+				static Writer writer;
+				return writer;
+			}
+
+			int64_t Now() const {
+				return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+			}
+
+			std::shared_ptr<ThreadBuffer> Register() {
+				auto buffer = std::make_shared<ThreadBuffer>();
+
+				std::lock_guard<std::mutex> lock(buffersMutex_);
+				buffers_.push_back(buffer);
+
+				return buffer;
+			}
+
+			void Open(const std::string& path) {
+				std::lock_guard<std::mutex> lock(drainMutex_);
+
+				file_.open(path, std::ios::out | std::ios::trunc);
+				if (!file_)
+					throw std::runtime_error("failed to open log file '" + path + "'");
+			}
+
+			void Notify() { wakeUp_.notify_one(); }
+			void OnDropped() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+			uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+			void Drain() {
+				std::lock_guard<std::mutex> drainLock(drainMutex_);
+
+				std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+				{
+					std::lock_guard<std::mutex> lock(buffersMutex_);
+					buffers = buffers_;
+				}
+
+				// Merge the thread rings in time order
+				batch_.clear();
+				for (const auto& buffer : buffers) {
+					for (void* record = buffer->Front(); record != nullptr; record = buffer->Front()) {
+						batch_.push_back(Format(*static_cast<Log::RecordHeader*>(record)));
+						buffer->Pop();
+					}
+				}
+
+				const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+				if (dropped != reportedDropped_) {
+					batch_.push_back(Line{ Now(), Severity::Warning, "[log] " + std::to_string(dropped - reportedDropped_) + " messages dropped, buffers full" });
+					reportedDropped_ = dropped;
+				}
+
+				std::stable_sort(batch_.begin(), batch_.end(), [](const Line& a, const Line& b) { return a.Time < b.Time; });
+
+				WriteBatch();
+
+				{
+					std::lock_guard<std::mutex> lock(buffersMutex_);
+					buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(), [](const std::shared_ptr<ThreadBuffer>& buffer)
+						{
+							return buffer->Retired && buffer->IsEmpty();
+						}), buffers_.end());
+				}
+			}
+
+		private:
+
+			struct Line {
+				int64_t Time;
+				Severity Level;
+				std::string Text;
+			};
+
+			Line Format(Log::RecordHeader& header) {
+				formatter_.str(std::string());
+				formatter_.clear();
+
+				formatter_ << '[' << std::fixed << std::setprecision(6) << std::setw(12) << header.Time / 1e9 << "] " << SeverityName(header.Level) << ": ";
+				formatter_ << std::defaultfloat << std::setprecision(6);
+				header.Print(formatter_, header.Format, &header + 1);
+
+				return Line{ header.Time, header.Level, formatter_.str() };
+			}
+
+			void WriteBatch() {
+				if (batch_.empty())
+					return;
+
+				// One write per run of same severity lines, the console colour only changes between runs
+				size_t begin = 0;
+				while (begin != batch_.size()) {
+					size_t end = begin;
+					output_.clear();
+
+					while (end != batch_.size() && batch_[end].Level == batch_[begin].Level) {
+						output_ += batch_[end].Text;
+						output_ += '\n';
+						++end;
+					}
+
+					const auto attributes = SetColorBySeverity(batch_[begin].Level);
+					std::cerr.write(output_.data(), static_cast<std::streamsize>(output_.size()));
+					SetColorByAttributes(attributes);
+
+					if (file_.is_open())
+						file_.write(output_.data(), static_cast<std::streamsize>(output_.size()));
+
+					begin = end;
+				}
+
+				std::cerr.flush();
+				if (file_.is_open())
+					file_.flush();
+			}
+
+			void Run() {
+				while (running_) {
+					{
+						std::unique_lock<std::mutex> lock(wakeUpMutex_);
+						wakeUp_.wait_for(lock, std::chrono::milliseconds(20));
+					}
+
+					Drain();
+				}
+			}
+
+			const std::chrono::steady_clock::time_point start_;
+
+			std::mutex buffersMutex_;
+			std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+			// Held while draining, the rings only ever have one consumer at a time
+			std::mutex drainMutex_;
+			std::ostringstream formatter_;
+			std::vector<Line> batch_;
+			std::string output_;
+			std::ofstream file_;
+			uint64_t reportedDropped_{};
+
+			std::atomic<uint64_t> dropped_{};
+
+			std::mutex wakeUpMutex_;
+			std::condition_variable wakeUp_;
+			std::atomic<bool> running_{true};
+			std::thread thread_;
+		};
+
+		// Registers the calling thread ring on first use, and retires it when the thread exits
+		struct ThreadBufferHandle final {
+			ThreadBufferHandle() : Buffer(Writer::Instance().Register()) {}
+			~ThreadBufferHandle() { Buffer->Retired = true; }
+
+			std::shared_ptr<ThreadBuffer> Buffer;
+		};
+
+		ThreadBuffer& CurrentThreadBuffer() {
+			thread_local ThreadBufferHandle handle;
+			return *handle.Buffer;
+		}
+	}
+
+	void Log::Open(const std::string& path) {
+		Writer::Instance().Open(path);
+	}
+
+	void Log::Flush() {
+		Writer::Instance().Drain();
+	}
+
+	uint64_t Log::Dropped() {
+		return Writer::Instance().Dropped();
+	}
+
+	void Log::PrintValues(std::ostream& out, const char* const format) {
+		out << format;
+	}
+
+	const char* Log::PrintUntilPlaceholder(std::ostream& out, const char* const format) {
+		const char* const placeholder = std::strstr(format, "{}");
+
+		if (placeholder == nullptr) {
+			// More arguments than placeholders, they are appended
+			out << format << ' ';
+			return format + std::strlen(format);
+		}
+
+		out.write(format, placeholder - format);
+		return placeholder + 2;
+	}
+
+	Log::RecordHeader* Log::BeginRecord() {
+		void* const record = CurrentThreadBuffer().Begin();
+
+		if (record == nullptr) {
+			Writer::Instance().OnDropped();
+			return nullptr;
+		}
+
+		return static_cast<RecordHeader*>(record);
+	}
+
+	void Log::CommitRecord(const Severity severity) {
+		CurrentThreadBuffer().Commit();
+
+		// Errors are written promptly, everything else waits for the next batch
+		if (severity >= Severity::Error)
+			Writer::Instance().Notify();
+	}
+
+	int64_t Log::Now() {
+		return Writer::Instance().Now();
+	}
+
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Vulkan/Vulkan.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Utilities {
+
+	// Values match the debug utils severities, so validation messages convert directly
+	enum class Severity {
+		Verbose = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT,
+		Info = VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT,
+		Warning = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT,
+		Error = VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT,
+		Fatal = VK_DEBUG_UTILS_MESSAGE_SEVERITY_FLAG_BITS_MAX_ENUM_EXT
+	};
+
+	// Messages below this severity are compiled out, override with -DLOG_MIN_SEVERITY=Utilities::Severity::...
+#ifndef LOG_MIN_SEVERITY
+#ifdef NDEBUG
+#define LOG_MIN_SEVERITY Utilities::Severity::Info
+#else
+#define LOG_MIN_SEVERITY Utilities::Severity::Verbose
+#endif
+#endif
+
+	// Asynchronous logger. Each thread writes fixed size records into its own lock-free ring:
+	// a timestamp, the format string and a copy of the arguments. A background writer drains the rings,
+	// formats the records and writes them in batches to stderr and the optional log file.
+	// Format strings use {} placeholders, filled with operator << of the matching argument.
+	class Log final {
+	public:
+
+		static constexpr size_t RecordSize = 256;
+		static constexpr size_t RecordsPerThread = 1024;
+
+		static constexpr bool IsEnabled(const Severity severity) {
+			return static_cast<int>(severity) >= static_cast<int>(LOG_MIN_SEVERITY);
+		}
+
+		// Also write messages to the given file from now on
+		static void Open(const std::string& path);
+		// Block until everything logged so far has been written
+		static void Flush();
+		// Records lost because a thread ring was full
+		static uint64_t Dropped();
+
+		template <class... Args>
+		static void Write(Severity severity, const char* format, Args&&... args);
+
+		using PrintFunction = void (*)(std::ostream& out, const char* format, void* arguments);
+
+		// Start of every record, the copied arguments follow it; Print formats and destroys them
+		struct alignas(std::max_align_t) RecordHeader {
+			int64_t Time;
+			Severity Level;
+			const char* Format;
+			PrintFunction Print;
+		};
+
+	private:
+
+		static constexpr size_t ArgumentsSize = RecordSize - sizeof(RecordHeader);
+
+		// Pointers may not outlive the call site, strings are copied
+		template <class T>
+		using Stored = std::conditional_t<
+			std::is_same<std::decay_t<T>, const char*>::value || std::is_same<std::decay_t<T>, char*>::value,
+			std::string,
+			std::decay_t<T>>;
+
+		template <class Tuple>
+		static void Print(std::ostream& out, const char* format, void* const arguments) {
+			auto& tuple = *static_cast<Tuple*>(arguments);
+			std::apply([&out, &format](const auto&... values) { PrintValues(out, format, values...); }, tuple);
+			tuple.~Tuple();
+		}
+
+		static void PrintValues(std::ostream& out, const char* format);
+
+		template <class T, class... Rest>
+		static void PrintValues(std::ostream& out, const char* format, const T& value, const Rest&... rest) {
+			format = PrintUntilPlaceholder(out, format);
+			out << value;
+			PrintValues(out, format, rest...);
+		}
+
+		template <class... Args>
+		static std::string FormatNow(const char* format, const Args&... args);
+
+		// Print the format string up to the next placeholder, return what follows it
+		static const char* PrintUntilPlaceholder(std::ostream& out, const char* format);
+
+		// Calling thread ring, null when full; the record becomes visible to the writer once committed
+		static RecordHeader* BeginRecord();
+		static void CommitRecord(Severity severity);
+		static int64_t Now();
+	};
+
+	template <class... Args>
+	void Log::Write(const Severity severity, const char* const format, Args&&... args) {
+		using Tuple = std::tuple<Stored<Args>...>;
+
+		RecordHeader* const record = BeginRecord();
+		if (record == nullptr)
+			return;
+
+		record->Time = Now();
+		record->Level = severity;
+
+		if constexpr (sizeof(Tuple) <= ArgumentsSize && alignof(Tuple) <= alignof(std::max_align_t)) {
+			record->Format = format;
+			record->Print = &Print<Tuple>;
+			new (record + 1) Tuple(std::forward<Args>(args)...);
+		}
+		else {
+			// Too large to be deferred, format on the calling thread instead
+			record->Format = "{}";
+			record->Print = &Print<std::tuple<std::string>>;
+			new (record + 1) std::tuple<std::string>(FormatNow(format, args...));
+		}
+
+		CommitRecord(severity);
+	}
+
+	template <class... Args>
+	std::string Log::FormatNow(const char* const format, const Args&... args) {
+		std::ostringstream out;
+		PrintValues(out, format, args...);
+		return out.str();
+	}
+
+}
+
+#define LOG_AT(severity, ...) \
+	do { if constexpr (Utilities::Log::IsEnabled(severity)) Utilities::Log::Write(severity, __VA_ARGS__); } while (false)
+
+#define LOG_VERBOSE(...) LOG_AT(Utilities::Severity::Verbose, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(Utilities::Severity::Info, __VA_ARGS__)
+#define LOG_WARNING(...) LOG_AT(Utilities::Severity::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(Utilities::Severity::Error, __VA_ARGS__)
+#define LOG_FATAL(...) LOG_AT(Utilities::Severity::Fatal, __VA_ARGS__)
@@ -0,0 +1,376 @@
+#include "MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+
+namespace Utilities {
+
+	namespace {
+		constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+		// Border edges weigh that much more than surfaces, open boundaries keep their outline
+		constexpr double BorderWeight = 10.0;
+
+		struct Vector3 {
+			double X, Y, Z;
+
+			Vector3 operator - (const Vector3& other) const { return { X - other.X, Y - other.Y, Z - other.Z }; }
+			double Dot(const Vector3& other) const { return X * other.X + Y * other.Y + Z * other.Z; }
+			Vector3 Cross(const Vector3& other) const { return { Y * other.Z - Z * other.Y, Z * other.X - X * other.Z, X * other.Y - Y * other.X }; }
+			double Length() const { return std::sqrt(Dot(*this)); }
+		};
+
+		struct Edge {
+			uint32_t A, B;
+			bool operator < (const Edge& other) const { return A != other.A ? A < other.A : B < other.B; }
+			bool operator == (const Edge& other) const { return A == other.A && B == other.B; }
+		};
+
+		struct Collapse {
+			uint32_t Source, Target;
+			double Cost;
+		};
+
+		// Compressed lists of the triangles around every vertex
+		struct Adjacency {
+			std::vector<uint32_t> Offsets;
+			std::vector<uint32_t> Triangles;
+
+			Adjacency(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap) :
+				Offsets(remap.size() + 1, 0),
+				Triangles(indices.size())
+			{
+				for (const auto index : indices) {
+					++Offsets[remap[index] + 1];
+				}
+
+				std::partial_sum(Offsets.begin(), Offsets.end(), Offsets.begin());
+				std::vector<uint32_t> fill(Offsets.begin(), Offsets.end() - 1);
+
+				for (size_t i = 0; i != indices.size(); ++i) {
+					Triangles[fill[remap[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+		};
+	}
+
+	struct MeshSimplifier::Quadric {
+		double A00{}, A11{}, A22{}, A01{}, A02{}, A12{};
+		double B0{}, B1{}, B2{};
+		double C{};
+		double Weight{};
+
+		// Squared distance to the plane dot(normal, p) + d = 0, normal being of unit length
+		static Quadric Plane(const Vector3& normal, const double d, const double weight) {
+			Quadric q;
+			q.A00 = weight * normal.X * normal.X;
+			q.A11 = weight * normal.Y * normal.Y;
+			q.A22 = weight * normal.Z * normal.Z;
+			q.A01 = weight * normal.X * normal.Y;
+			q.A02 = weight * normal.X * normal.Z;
+			q.A12 = weight * normal.Y * normal.Z;
+			q.B0 = weight * normal.X * d;
+			q.B1 = weight * normal.Y * d;
+			q.B2 = weight * normal.Z * d;
+			q.C = weight * d * d;
+			q.Weight = weight;
+			return q;
+		}
+
+		Quadric& operator += (const Quadric& other) {
+			A00 += other.A00; A11 += other.A11; A22 += other.A22;
+			A01 += other.A01; A02 += other.A02; A12 += other.A12;
+			B0 += other.B0; B1 += other.B1; B2 += other.B2;
+			C += other.C;
+			Weight += other.Weight;
+			return *this;
+		}
+
+		// Weighted mean of the squared distances to the planes
+		double Error(const Vector3& p) const {
+			const double error =
+				A00 * p.X * p.X + A11 * p.Y * p.Y + A22 * p.Z * p.Z +
+				2.0 * (A01 * p.X * p.Y + A02 * p.X * p.Z + A12 * p.Y * p.Z) +
+				2.0 * (B0 * p.X + B1 * p.Y + B2 * p.Z) + C;
+
+			return Weight > 0.0 ? std::max(error, 0.0) / Weight : 0.0;
+		}
+	};
+
+	MeshSimplifier::MeshSimplifier(const std::vector<float>& positions, const std::vector<float>& normals) :
+		positions_(positions),
+		normals_(normals)
+	{
+		if (positions.size() % 3 != 0 || (!normals.empty() && normals.size() != positions.size()))
+			throw std::invalid_argument("mesh simplifier needs 3 floats per position and per normal");
+
+		const auto vertexCount = static_cast<uint32_t>(positions.size() / 3);
+		const auto position = [&](const uint32_t v) { return std::make_tuple(positions[3 * v], positions[3 * v + 1], positions[3 * v + 2]); };
+
+		// Vertices sorted by position, the first of every run of equal positions represents it
+		std::vector<uint32_t> order(vertexCount);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](const uint32_t a, const uint32_t b) { return position(a) < position(b) || (position(a) == position(b) && a < b); });
+
+		positionRemap_.resize(vertexCount);
+		for (size_t i = 0; i != order.size(); ++i) {
+			positionRemap_[order[i]] = i != 0 && position(order[i]) == position(order[i - 1]) ? positionRemap_[order[i - 1]] : order[i];
+		}
+	}
+
+	std::vector<uint32_t> MeshSimplifier::Simplify(const std::vector<uint32_t>& indices, const size_t targetIndexCount, const float maxError, float& error) const {
+		if (indices.size() % 3 != 0)
+			throw std::invalid_argument("mesh simplifier needs triangle lists");
+
+		const auto vertexCount = static_cast<uint32_t>(positionRemap_.size());
+		const auto& remap = positionRemap_;
+		const auto position = [&](const uint32_t v) { return Vector3{ positions_[3 * v], positions_[3 * v + 1], positions_[3 * v + 2] }; };
+		const auto normal = [&](const uint32_t v) { return normals_.empty() ? Vector3{} : Vector3{ normals_[3 * v], normals_[3 * v + 1], normals_[3 * v + 2] }; };
+		const double maxCost = static_cast<double>(maxError) * maxError;
+
+		// Undirected edges between positions, an edge used by a single triangle is on a border
+		const auto edges = [&](const std::vector<uint32_t>& triangles) {
+			std::vector<Edge> result;
+			result.reserve(triangles.size());
+
+			for (size_t i = 0; i != triangles.size(); i += 3) {
+				for (int corner = 0; corner != 3; ++corner) {
+					const uint32_t a = remap[triangles[i + corner]];
+					const uint32_t b = remap[triangles[i + (corner + 1) % 3]];
+					result.push_back({ std::min(a, b), std::max(a, b) });
+				}
+			}
+
+			std::sort(result.begin(), result.end());
+			return result;
+		};
+
+		// Quadrics of the planes around every position, including the planes along the border edges
+		std::vector<Quadric> quadrics(vertexCount);
+
+		for (size_t i = 0; i != indices.size(); i += 3) {
+			const Vector3 p0 = position(indices[i]), p1 = position(indices[i + 1]), p2 = position(indices[i + 2]);
+			const Vector3 n = (p1 - p0).Cross(p2 - p0);
+			const double length = n.Length();
+
+			if (length == 0.0)
+				continue;
+
+			const Vector3 unit = { n.X / length, n.Y / length, n.Z / length };
+			const auto plane = Quadric::Plane(unit, -unit.Dot(p0), 0.5 * length);
+
+			for (int corner = 0; corner != 3; ++corner) {
+				quadrics[remap[indices[i + corner]]] += plane;
+			}
+		}
+
+		{
+			const auto initialEdges = edges(indices);
+
+			for (size_t i = 0; i != indices.size(); i += 3) {
+				for (int corner = 0; corner != 3; ++corner) {
+					const uint32_t a = remap[indices[i + corner]];
+					const uint32_t b = remap[indices[i + (corner + 1) % 3]];
+					const Edge edge = { std::min(a, b), std::max(a, b) };
+					const auto range = std::equal_range(initialEdges.begin(), initialEdges.end(), edge);
+
+					if (range.second - range.first != 1)
+						continue;
+
+					// Plane through the edge, perpendicular to its triangle
+					const Vector3 pa = position(a), pb = position(b), pc = position(indices[i + (corner + 2) % 3]);
+					const Vector3 side = pb - pa;
+					const Vector3 n = side.Cross(side.Cross(pc - pa));
+					const double length = n.Length();
+
+					if (length == 0.0)
+						continue;
+
+					const Vector3 unit = { n.X / length, n.Y / length, n.Z / length };
+					const auto plane = Quadric::Plane(unit, -unit.Dot(pa), BorderWeight * side.Dot(side));
+					quadrics[a] += plane;
+					quadrics[b] += plane;
+				}
+			}
+		}
+
+		std::vector<uint32_t> result = indices;
+		double largestCost = 0.0;
+
+		std::vector<uint32_t> collapseTarget(vertexCount);
+		std::vector<uint8_t> locked(vertexCount);
+		std::vector<uint8_t> border(vertexCount);
+		std::vector<uint32_t> redirect(vertexCount);
+
+		// Vertices of every position, to redirect the seam vertices of a collapsed position
+		std::vector<uint32_t> memberOffsets(vertexCount + 1, 0);
+		std::vector<uint32_t> members(vertexCount);
+		{
+			for (uint32_t v = 0; v != vertexCount; ++v) {
+				++memberOffsets[remap[v] + 1];
+			}
+
+			std::partial_sum(memberOffsets.begin(), memberOffsets.end(), memberOffsets.begin());
+			std::vector<uint32_t> fill(memberOffsets.begin(), memberOffsets.end() - 1);
+
+			for (uint32_t v = 0; v != vertexCount; ++v) {
+				members[fill[remap[v]]++] = v;
+			}
+		}
+
+		while (result.size() > targetIndexCount) {
+			const Adjacency adjacency(result, remap);
+			const auto resultEdges = edges(result);
+
+			std::fill(border.begin(), border.end(), uint8_t(0));
+			std::vector<Edge> uniqueEdges;
+			std::vector<uint8_t> borderEdges;
+
+			for (size_t i = 0; i != resultEdges.size();) {
+				size_t end = i + 1;
+				while (end != resultEdges.size() && resultEdges[end] == resultEdges[i]) {
+					++end;
+				}
+
+				uniqueEdges.push_back(resultEdges[i]);
+				borderEdges.push_back(end - i == 1);
+
+				if (end - i == 1) {
+					border[resultEdges[i].A] = 1;
+					border[resultEdges[i].B] = 1;
+				}
+
+				i = end;
+			}
+
+			// A border position only collapses along its border, onto another border position
+			std::vector<Collapse> collapses;
+			collapses.reserve(uniqueEdges.size());
+
+			for (size_t i = 0; i != uniqueEdges.size(); ++i) {
+				const auto& edge = uniqueEdges[i];
+				Quadric q = quadrics[edge.A];
+				q += quadrics[edge.B];
+
+				const auto allowed = [&](const uint32_t source, const uint32_t target) {
+					return !border[source] || (border[target] && borderEdges[i]);
+				};
+
+				const double costToB = allowed(edge.A, edge.B) ? q.Error(position(edge.B)) : std::numeric_limits<double>::infinity();
+				const double costToA = allowed(edge.B, edge.A) ? q.Error(position(edge.A)) : std::numeric_limits<double>::infinity();
+
+				if (costToB <= costToA && costToB <= maxCost)
+					collapses.push_back({ edge.A, edge.B, costToB });
+				else if (costToA < costToB && costToA <= maxCost)
+					collapses.push_back({ edge.B, edge.A, costToA });
+			}
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Cost < b.Cost; });
+
+			std::fill(collapseTarget.begin(), collapseTarget.end(), None);
+			std::fill(locked.begin(), locked.end(), uint8_t(0));
+
+			const size_t trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+			size_t removed = 0;
+
+			for (const auto& collapse : collapses) {
+				if (locked[collapse.Source] || locked[collapse.Target])
+					continue;
+
+				// Moving the source must not fold any of its remaining triangles over
+				const Vector3 target = position(collapse.Target);
+				bool flips = false;
+				size_t collapsedTriangles = 0;
+
+				for (uint32_t t = adjacency.Offsets[collapse.Source]; t != adjacency.Offsets[collapse.Source + 1] && !flips; ++t) {
+					const uint32_t* const triangle = &result[3 * adjacency.Triangles[t]];
+					Vector3 corners[3];
+					Vector3 moved[3];
+					bool hasTarget = false;
+
+					for (int corner = 0; corner != 3; ++corner) {
+						corners[corner] = position(triangle[corner]);
+						moved[corner] = remap[triangle[corner]] == collapse.Source ? target : corners[corner];
+						hasTarget |= remap[triangle[corner]] == collapse.Target;
+					}
+
+					if (hasTarget) {
+						++collapsedTriangles;
+						continue;
+					}
+
+					const Vector3 before = (corners[1] - corners[0]).Cross(corners[2] - corners[0]);
+					const Vector3 after = (moved[1] - moved[0]).Cross(moved[2] - moved[0]);
+					flips = before.Dot(after) <= 0.0;
+				}
+
+				if (flips)
+					continue;
+
+				collapseTarget[collapse.Source] = collapse.Target;
+				quadrics[collapse.Target] += quadrics[collapse.Source];
+				largestCost = std::max(largestCost, collapse.Cost);
+
+				// The neighbourhood keeps the positions the fold test saw until the next pass
+				for (uint32_t t = adjacency.Offsets[collapse.Source]; t != adjacency.Offsets[collapse.Source + 1]; ++t) {
+					const uint32_t* const triangle = &result[3 * adjacency.Triangles[t]];
+					locked[remap[triangle[0]]] = locked[remap[triangle[1]]] = locked[remap[triangle[2]]] = 1;
+				}
+
+				removed += collapsedTriangles;
+				if (removed >= trianglesToRemove)
+					break;
+			}
+
+			if (removed == 0)
+				break;
+
+			// Every vertex of a collapsed position moves to the vertex of the target position with the closest normal
+			std::iota(redirect.begin(), redirect.end(), 0);
+
+			for (auto& index : result) {
+				const uint32_t target = collapseTarget[remap[index]];
+				if (target == None)
+					continue;
+
+				if (redirect[index] == index) {
+					uint32_t best = target;
+					double bestDot = -std::numeric_limits<double>::infinity();
+
+					for (uint32_t m = memberOffsets[target]; m != memberOffsets[target + 1]; ++m) {
+						const uint32_t candidate = members[m];
+						const double dot = normal(candidate).Dot(normal(index));
+						if (dot > bestDot) {
+							bestDot = dot;
+							best = candidate;
+						}
+					}
+
+					redirect[index] = best;
+				}
+
+				index = redirect[index];
+			}
+
+			// Triangles with two corners at the same position are gone
+			size_t write = 0;
+			for (size_t i = 0; i != result.size(); i += 3) {
+				const uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+				if (a == b || b == c || a == c)
+					continue;
+
+				std::copy_n(&result[i], 3, &result[write]);
+				write += 3;
+			}
+
+			result.resize(write);
+		}
+
+		error = static_cast<float>(std::sqrt(largestCost));
+		return result;
+	}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Utilities {
+
+	// Triangle mesh simplification by edge collapse, ordered by quadric error (Garland and Heckbert,
+	// "Surface Simplification Using Quadric Error Metrics").
+	// Vertices only ever collapse onto existing vertices, so every simplified index buffer still indexes the
+	// original vertex buffer and all the levels of detail of a mesh can share it. Vertices sharing a position
+	// (attribute seams) collapse together, each one onto the vertex of the target with the closest normal.
+	class MeshSimplifier final {
+	public:
+
+		// Positions and normals are 3 floats per vertex, normals may be empty
+		MeshSimplifier(const std::vector<float>& positions, const std::vector<float>& normals);
+
+		// Collapse edges until at most targetIndexCount indices are left or no collapse stays under maxError.
+		// Returns the simplified triangles and sets error to the largest distance from the original surface
+		// introduced, in position units.
+		std::vector<uint32_t> Simplify(const std::vector<uint32_t>& indices, size_t targetIndexCount, float maxError, float& error) const;
+
+	private:
+
+		struct Quadric;
+
+		std::vector<float> positions_;
+		std::vector<float> normals_;
+		// Lowest vertex index sharing the position of every vertex
+		std::vector<uint32_t> positionRemap_;
+	};
+
+}
@@ -0,0 +1,310 @@
+#include "Model.hpp"
+#include "MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace Utilities {
+
+	namespace {
+		// "LODS", then the format version
+		constexpr uint32_t LodFileMagic = 0x53444F4C;
+		constexpr uint32_t LodFileVersion = 2;
+
+		// Past the minimum chain, levels reducing the triangle count by less than that are not worth their memory
+		constexpr double MinLodReduction = 0.85;
+
+		// OBJ indices start at 1, negative ones count back from the last element read
+		int ObjIndex(const std::string& token, const size_t count, const std::string& path) {
+			const int index = std::stoi(token);
+			const int resolved = index < 0 ? static_cast<int>(count) + index : index - 1;
+
+			if (resolved < 0 || resolved >= static_cast<int>(count))
+				throw std::runtime_error("invalid face index in '" + path + "'");
+
+			return resolved;
+		}
+
+		bool ReadFile(const std::string& path, std::string& data) {
+			std::ifstream file(path, std::ios::binary);
+
+			if (!file.is_open())
+				return false;
+
+			std::ostringstream contents;
+			contents << file.rdbuf();
+			data = contents.str();
+			return true;
+		}
+
+		// FNV-1a of the OBJ file contents, recorded in the level of detail file generated from it
+		uint64_t Hash(const std::string& data) {
+			uint64_t hash = 14695981039346656037ull;
+			for (const char c : data) {
+				hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+			}
+
+			return hash;
+		}
+
+		template <class T>
+		void Read(std::ifstream& file, T* data, const size_t count) {
+			file.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+		}
+
+		template <class T>
+		void Write(std::ofstream& file, const T* data, const size_t count) {
+			file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+		}
+	}
+
+	Model Model::Load(const std::string& path) {
+		if (std::ifstream(path + ".lod", std::ios::binary).is_open()) {
+			Model model = ReadLods(path + ".lod");
+			std::string source;
+
+			// Levels generated from another version of the OBJ file are stale, the OBJ file itself is optional
+			if (!ReadFile(path, source) || (source.size() == model.sourceSize_ && Hash(source) == model.sourceHash_))
+				return model;
+		}
+
+		Model model = ImportObj(path);
+		model.GenerateLods();
+		return model;
+	}
+
+	Model Model::ImportObj(const std::string& path) {
+		std::string source;
+
+		if (!ReadFile(path, source))
+			throw std::runtime_error("failed to open file '" + path + "'");
+
+		std::istringstream file(source);
+
+		std::vector<float> positions;
+		std::vector<float> normals;
+		// One vertex per position and normal pair
+		std::unordered_map<uint64_t, uint32_t> vertexIds;
+		bool hasNormals = true;
+
+		Model model;
+		model.sourceSize_ = source.size();
+		model.sourceHash_ = Hash(source);
+
+		std::string line;
+		std::vector<uint32_t> face;
+
+		while (std::getline(file, line)) {
+			std::istringstream stream(line);
+			std::string keyword;
+			stream >> keyword;
+
+			if (keyword == "v") {
+				float x = 0, y = 0, z = 0;
+				stream >> x >> y >> z;
+				positions.insert(positions.end(), { x, y, z });
+			}
+			else if (keyword == "vn") {
+				float x = 0, y = 0, z = 0;
+				stream >> x >> y >> z;
+				normals.insert(normals.end(), { x, y, z });
+			}
+			else if (keyword == "f") {
+				face.clear();
+				std::string token;
+
+				while (stream >> token) {
+					// v, v/vt, v//vn or v/vt/vn, texture coordinates are not used
+					const auto firstSlash = token.find('/');
+					const auto secondSlash = firstSlash == std::string::npos ? std::string::npos : token.find('/', firstSlash + 1);
+					const int position = ObjIndex(token.substr(0, firstSlash), positions.size() / 3, path);
+					const int normal = secondSlash != std::string::npos && secondSlash + 1 < token.size()
+						? ObjIndex(token.substr(secondSlash + 1), normals.size() / 3, path)
+						: -1;
+
+					hasNormals &= normal >= 0;
+
+					const uint64_t key = (uint64_t(uint32_t(position)) << 32) | uint32_t(normal);
+					const auto vertex = vertexIds.emplace(key, static_cast<uint32_t>(model.vertices_.size()));
+
+					if (vertex.second) {
+						Vertex v = {};
+						std::copy_n(&positions[3 * position], 3, v.Position);
+						if (normal >= 0)
+							std::copy_n(&normals[3 * normal], 3, v.Normal);
+						model.vertices_.push_back(v);
+					}
+
+					face.push_back(vertex.first->second);
+				}
+
+				// Polygons are triangulated as fans
+				for (size_t i = 2; i < face.size(); ++i) {
+					model.indices_.insert(model.indices_.end(), { face[0], face[i - 1], face[i] });
+				}
+			}
+		}
+
+		if (model.indices_.empty())
+			throw std::runtime_error("no triangle in '" + path + "'");
+
+		// Without normals in the file, every vertex gets the area weighted normal of the faces around its position
+		if (!hasNormals) {
+			std::unordered_map<uint32_t, std::array<float, 3>> sums;
+			std::vector<uint32_t> positionIds(model.vertices_.size());
+
+			for (const auto& vertex : vertexIds) {
+				positionIds[vertex.second] = static_cast<uint32_t>(vertex.first >> 32);
+			}
+
+			for (size_t i = 0; i != model.indices_.size(); i += 3) {
+				const float* const p0 = model.vertices_[model.indices_[i]].Position;
+				const float* const p1 = model.vertices_[model.indices_[i + 1]].Position;
+				const float* const p2 = model.vertices_[model.indices_[i + 2]].Position;
+				const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+
+				for (int corner = 0; corner != 3; ++corner) {
+					auto& sum = sums[positionIds[model.indices_[i + corner]]];
+					sum[0] += n[0];
+					sum[1] += n[1];
+					sum[2] += n[2];
+				}
+			}
+
+			for (size_t v = 0; v != model.vertices_.size(); ++v) {
+				const auto& sum = sums[positionIds[v]];
+				const float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+
+				for (int axis = 0; axis != 3; ++axis) {
+					model.vertices_[v].Normal[axis] = length > 0.0f ? sum[axis] / length : 0.0f;
+				}
+			}
+		}
+
+		model.lods_.push_back({ 0, static_cast<uint32_t>(model.indices_.size()), 0.0f });
+		model.UpdateBounds();
+		return model;
+	}
+
+	Model Model::ReadLods(const std::string& path) {
+		std::ifstream file(path, std::ios::binary);
+
+		if (!file.is_open())
+			throw std::runtime_error("failed to open file '" + path + "'");
+
+		uint32_t header[5] = {};
+		Read(file, header, 5);
+
+		if (!file || header[0] != LodFileMagic || header[1] != LodFileVersion)
+			throw std::runtime_error("'" + path + "' is not a level of detail file of this version");
+
+		Model model;
+		model.vertices_.resize(header[2]);
+		model.indices_.resize(header[3]);
+		model.lods_.resize(header[4]);
+
+		Read(file, &model.sourceSize_, 1);
+		Read(file, &model.sourceHash_, 1);
+		Read(file, model.center_, 3);
+		Read(file, &model.radius_, 1);
+		Read(file, model.lods_.data(), model.lods_.size());
+		Read(file, model.vertices_.data(), model.vertices_.size());
+		Read(file, model.indices_.data(), model.indices_.size());
+
+		if (!file)
+			throw std::runtime_error("truncated level of detail file '" + path + "'");
+
+		model.precomputed_ = true;
+		return model;
+	}
+
+	void Model::WriteLods(const std::string& path) const {
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+		const uint32_t header[5] = {
+			LodFileMagic, LodFileVersion,
+			static_cast<uint32_t>(vertices_.size()), static_cast<uint32_t>(indices_.size()), static_cast<uint32_t>(lods_.size())
+		};
+
+		Write(file, header, 5);
+		Write(file, &sourceSize_, 1);
+		Write(file, &sourceHash_, 1);
+		Write(file, center_, 3);
+		Write(file, &radius_, 1);
+		Write(file, lods_.data(), lods_.size());
+		Write(file, vertices_.data(), vertices_.size());
+		Write(file, indices_.data(), indices_.size());
+
+		if (!file)
+			throw std::runtime_error("failed to write level of detail file '" + path + "'");
+	}
+
+	void Model::GenerateLods() {
+		std::vector<float> positions;
+		std::vector<float> normals;
+		positions.reserve(vertices_.size() * 3);
+		normals.reserve(vertices_.size() * 3);
+
+		for (const auto& vertex : vertices_) {
+			positions.insert(positions.end(), vertex.Position, vertex.Position + 3);
+			normals.insert(normals.end(), vertex.Normal, vertex.Normal + 3);
+		}
+
+		const MeshSimplifier simplifier(positions, normals);
+
+		// Every level is simplified from the previous one, its error adds up to the previous error
+		lods_.resize(1);
+		std::vector<uint32_t> previous(indices_.begin(), indices_.begin() + lods_[0].IndexCount);
+		float error = lods_[0].Error;
+
+		while (lods_.size() != MaxLods) {
+			const size_t target = previous.size() / 6 * 3;
+			float lodError = 0.0f;
+			auto lod = simplifier.Simplify(previous, target, std::numeric_limits<float>::max(), lodError);
+
+			// The first MinLods levels are kept as long as they remove triangles at all
+			const bool reduced = lods_.size() < MinLods
+				? lod.size() < previous.size()
+				: static_cast<double>(lod.size()) <= MinLodReduction * static_cast<double>(previous.size());
+
+			if (lod.empty() || !reduced)
+				break;
+
+			error += lodError;
+			lods_.push_back({ static_cast<uint32_t>(indices_.size()), static_cast<uint32_t>(lod.size()), error });
+			indices_.insert(indices_.end(), lod.begin(), lod.end());
+			previous = std::move(lod);
+		}
+	}
+
+	void Model::UpdateBounds() {
+		float lower[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+		float upper[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+		for (const auto& vertex : vertices_) {
+			for (int axis = 0; axis != 3; ++axis) {
+				lower[axis] = std::min(lower[axis], vertex.Position[axis]);
+				upper[axis] = std::max(upper[axis], vertex.Position[axis]);
+			}
+		}
+
+		for (int axis = 0; axis != 3; ++axis) {
+			center_[axis] = 0.5f * (lower[axis] + upper[axis]);
+		}
+
+		radius_ = 0.0f;
+		for (const auto& vertex : vertices_) {
+			const float d[3] = { vertex.Position[0] - center_[0], vertex.Position[1] - center_[1], vertex.Position[2] - center_[2] };
+			radius_ = std::max(radius_, std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]));
+		}
+	}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Utilities {
+
+	// Triangle mesh imported from a Wavefront OBJ file, with its levels of detail.
+	// Every level indexes the same vertices, and the index lists of all levels follow each other from the
+	// most detailed one, so a single vertex buffer and a single index buffer hold the whole chain.
+	class Model final {
+	public:
+
+		struct Vertex {
+			float Position[3];
+			float Normal[3];
+		};
+
+		struct Lod {
+			uint32_t FirstIndex;
+			uint32_t IndexCount;
+			// Bound on the distance from the full detail surface, in model units
+			float Error;
+		};
+
+		static constexpr uint32_t MinLods = 4;
+		static constexpr uint32_t MaxLods = 6;
+
+		// Reads the levels precomputed at build time (<path>.lod) when they are there and were generated from
+		// the current OBJ file (its size and hash are stored with them), imports the OBJ file and generates them otherwise
+		static Model Load(const std::string& path);
+		static Model ImportObj(const std::string& path);
+		static Model ReadLods(const std::string& path);
+		void WriteLods(const std::string& path) const;
+
+		// Halve the triangle count from one level to the next, until MaxLods levels or the simplification stalls;
+		// the chain only ends before MinLods levels when the mesh cannot be simplified any further
+		void GenerateLods();
+
+		const std::vector<Vertex>& Vertices() const { return vertices_; }
+		const std::vector<uint32_t>& Indices() const { return indices_; }
+		const std::vector<Lod>& Lods() const { return lods_; }
+		bool IsPrecomputed() const { return precomputed_; }
+
+		// Bounding sphere
+		const float* Center() const { return center_; }
+		float Radius() const { return radius_; }
+
+	private:
+
+		void UpdateBounds();
+
+		std::vector<Vertex> vertices_;
+		std::vector<uint32_t> indices_;
+		std::vector<Lod> lods_;
+		float center_[3]{};
+		float radius_{};
+		bool precomputed_{};
+		// OBJ file the levels were generated from
+		uint64_t sourceSize_{};
+		uint64_t sourceHash_{};
+	};
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace Utilities {
+
+	// Bounded lock-free multi producers / single consumer queue.
+	// Every cell carries a sequence number telling whether it is free for the producer of a given turn,
+	// or filled for the consumer; producers only contend on the enqueue position.
+	template <class T>
+	class MpscRingBuffer final {
+	public:
+
+		MpscRingBuffer(const MpscRingBuffer&) = delete;
+		MpscRingBuffer(MpscRingBuffer&&) = delete;
+		MpscRingBuffer& operator = (const MpscRingBuffer&) = delete;
+		MpscRingBuffer& operator = (MpscRingBuffer&&) = delete;
+
+		// The capacity is rounded up to a power of two
+		explicit MpscRingBuffer(const size_t capacity) :
+			mask_(RoundUpPowerOfTwo(capacity) - 1),
+			cells_(new Cell[mask_ + 1])
+		{
+			for (size_t i = 0; i != mask_ + 1; ++i) {
+				cells_[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		size_t Capacity() const { return mask_ + 1; }
+
+		// Any thread, false when the buffer is full
+		bool TryPush(T&& value) {
+			size_t position = enqueuePosition_.load(std::memory_order_relaxed);
+
+			for (;;) {
+				Cell& cell = cells_[position & mask_];
+				const size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+				const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+				if (difference == 0) {
+					if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+						cell.Value = std::move(value);
+						cell.Sequence.store(position + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (difference < 0) {
+					return false;
+				}
+				else {
+					position = enqueuePosition_.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// Consumer thread only, false when the buffer is empty
+		bool TryPop(T& value) {
+			Cell& cell = cells_[dequeuePosition_ & mask_];
+			const size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+
+			if (sequence != dequeuePosition_ + 1)
+				return false;
+
+			value = std::move(cell.Value);
+			cell.Sequence.store(dequeuePosition_ + mask_ + 1, std::memory_order_release);
+			++dequeuePosition_;
+
+			return true;
+		}
+
+	private:
+
+		struct Cell {
+			std::atomic<size_t> Sequence;
+			T Value;
+		};
+
+		static size_t RoundUpPowerOfTwo(const size_t value) {
+			size_t result = 2;
+			while (result < value) {
+				result <<= 1;
+			}
+			return result;
+		}
+
+		const size_t mask_;
+		const std::unique_ptr<Cell[]> cells_;
+
+		// Producers and consumer positions live on separate cache lines
+		alignas(64) std::atomic<size_t> enqueuePosition_{};
+		alignas(64) size_t dequeuePosition_{};
+	};
+
+}
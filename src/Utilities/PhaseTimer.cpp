@@ -0,0 +1,48 @@
+#include "PhaseTimer.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Utilities {
+
+	namespace {
+		double Round(const double milliseconds) {
+			return std::round(milliseconds * 10.0) / 10.0;
+		}
+	}
+
+	PhaseTimer::PhaseTimer() :
+		start_(std::chrono::steady_clock::now()),
+		thread_(std::this_thread::get_id())
+	{
+	}
+
+	double PhaseTimer::Elapsed() const {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+	}
+
+	void PhaseTimer::Record(const char* const name, const double begin, const double end) {
+		const bool background = std::this_thread::get_id() != thread_;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		phases_.push_back(Phase{ name, begin, end, background });
+	}
+
+	void PhaseTimer::Report(const char* const title) const {
+		std::vector<Phase> phases;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			phases = phases_;
+		}
+
+		std::stable_sort(phases.begin(), phases.end(), [](const Phase& a, const Phase& b) { return a.Begin < b.Begin; });
+
+		LOG_INFO("{}: {} ms", title, Round(Elapsed()));
+
+		for (const auto& phase : phases) {
+			LOG_INFO("- {}: {} ms, {} to {} ms{}", phase.Name, Round(phase.End - phase.Begin), Round(phase.Begin), Round(phase.End), phase.Background ? " (background)" : "");
+		}
+	}
+
+}
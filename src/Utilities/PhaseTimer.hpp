@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utilities {
+
+	// Wall clock phases measured from the timer creation, phases can be recorded from any thread.
+	class PhaseTimer final {
+	public:
+
+		// Records the phase from its construction to its destruction
+		class Scope final {
+		public:
+
+			Scope(const Scope&) = delete;
+			Scope(Scope&&) = delete;
+			Scope& operator = (const Scope&) = delete;
+			Scope& operator = (Scope&&) = delete;
+
+			Scope(PhaseTimer& timer, const char* name) : timer_(timer), name_(name), begin_(timer.Elapsed()) {}
+			~Scope() { timer_.Record(name_, begin_, timer_.Elapsed()); }
+
+		private:
+
+			PhaseTimer& timer_;
+			const char* const name_;
+			const double begin_;
+		};
+
+		PhaseTimer();
+
+		Scope Measure(const char* name) { return Scope(*this, name); }
+
+		// Milliseconds since the timer creation
+		double Elapsed() const;
+		void Record(const char* name, double begin, double end);
+
+		// Log every phase in start order, the ones run on other threads than the creating one are marked
+		void Report(const char* title) const;
+
+	private:
+
+		struct Phase {
+			const char* Name;
+			double Begin;
+			double End;
+			bool Background;
+		};
+
+		const std::chrono::steady_clock::time_point start_;
+		const std::thread::id thread_;
+
+		mutable std::mutex mutex_;
+		std::vector<Phase> phases_;
+	};
+
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// imgui compiles its own static copy of stb_rect_pack, this one is for the application
+#include <imstb_rectpack.h>
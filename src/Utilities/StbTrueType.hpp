@@ -0,0 +1,4 @@
+#pragma once
+
+// imgui compiles its own static copy of stb_truetype, this one is for the application
+#include <imstb_truetype.h>
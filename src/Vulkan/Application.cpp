@@ -1,49 +1,141 @@
 #include "Application.hpp"
 
 
+#include "ClusteredLighting.hpp"
 #include "CommandPool.hpp"
 #include "CommandBuffers.hpp"
 #include "DebugUtilsMessenger.hpp"
+#include "DepthBuffer.hpp"
+#include "DrawQueue.hpp"
 #include "Device.hpp"
+#include "FrameAllocator.hpp"
 #include "FrameBuffer.hpp"
+#include "FrameCapture.hpp"
+#include "FramePacer.hpp"
 #include "GraphicsPipeline.hpp"
+#include "GraphicsPipelineCache.hpp"
+#include "HostAllocator.hpp"
+#include "PerformanceOverlay.hpp"
+#include "ImageView.hpp"
+#include "LodMesh.hpp"
+#include "MemoryStatistics.hpp"
+#include "OcclusionCulling.hpp"
+#include "ParticleSystem.hpp"
 #include "Instance.hpp"
+#include "PipelineCache.hpp"
+#include "PipelineCompiler.hpp"
 #include "PipelineLayout.hpp"
+#include "PostProcess.hpp"
+#include "QueueSubmission.hpp"
 #include "RenderPass.hpp"
 #include "Semaphore.hpp"
+#include "ShaderModule.hpp"
+#include "SpriteBatch.hpp"
+#include "TextRenderer.hpp"
 #include "Surface.hpp"
 #include "SwapChain.hpp"
+#include "TimelineSemaphore.hpp"
+#include "TimestampQueryPool.hpp"
 #include "Window.hpp"
-#include "Fence.hpp"
 #include "Strings.hpp"
+#include "../Utilities/Log.hpp"
+#include "../Utilities/Model.hpp"
 
-#include <array>
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
 
 namespace Vulkan {
 
-Application::Application(const char* applicationName, const WindowConfig& windowConfig, const VkPresentModeKHR presentMode, const bool enableValidationLayers) :
-	presentMode_(presentMode), framebufferResized_(false)
+	namespace {
+		// GPU timestamps written in every frame command buffer
+		enum Timestamp : uint32_t {
+			FrameBegin,
+			OverlayBegin,
+			FrameEnd,
+			TimestampCount
+		};
+
+		const char* const PipelineCacheFile = "pipeline_cache.bin";
+		const char* const PipelineManifestFile = "pipeline_manifest.txt";
+		const char* const CaptureDirectory = "captures";
+		constexpr double TimeToFirstFrameTarget = 200.0;
+		// Sprites drawn per frame, about 5 MiB of vertices per frame in flight
+		constexpr uint32_t MaxSprites = 65536;
+		// Model instances drawn per frame, 1.25 MiB of instance data per frame in flight
+		constexpr uint32_t MaxModelInstances = 65536;
+		// Lights assigned to the clusters per frame, 384 KiB of the frame allocations
+		constexpr uint32_t MaxLights = 8192;
+		// Uniform and storage data allocated per frame in flight
+		constexpr VkDeviceSize FrameAllocatorSize = 4 * 1024 * 1024;
+		// Longest particle step, a stalled frame does not throw the particles across the screen
+		constexpr double MaxParticleStep = 1.0 / 20.0;
+
+		double MillisecondsSince(const std::chrono::steady_clock::time_point start) {
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		std::shared_future<std::vector<char>> ReadFileAsync(
+			Utilities::PhaseTimer& timer,
+			const char* const phase,
+			std::vector<char> (*read)(const std::string&),
+			const std::string& filename)
+		{
+			return std::async(std::launch::async, [&timer, phase, read, filename]()
+			{
+				const auto scope = timer.Measure(phase);
+				return read(filename);
+			});
+		}
+	}
+
+Application::Application(const char* applicationName, const WindowConfig& windowConfig, const VkPresentModeKHR presentMode, const bool enableValidationLayers, const bool lowLatency, const bool hostAllocator) :
+	presentMode_(presentMode), lowLatency_(lowLatency), framebufferResized_(false)
 {
+	// Only needed once the device exists, reading them overlaps with the window and instance creation
+	vertShaderCode_ = ReadFileAsync(startupTimer_, "read vertex shader", ShaderModule::ReadFile, "../assets/shaders/triangle.vert.spv");
+	fragShaderCode_ = ReadFileAsync(startupTimer_, "read fragment shader", ShaderModule::ReadFile, "../assets/shaders/triangle.frag.spv");
+	pipelineCacheData_ = ReadFileAsync(startupTimer_, "read pipeline cache", PipelineCache::ReadFile, PipelineCacheFile);
+
+	// Must outlive the instance and the device, every object is created and destroyed through it
+	hostAllocator_.reset(hostAllocator ? new HostAllocator() : nullptr);
+
 	const auto validationLayers = enableValidationLayers
 		? std::vector<const char*>{"VK_LAYER_KHRONOS_validation"}
 		: std::vector<const char*>();
 
-	window_.reset(new class Window(windowConfig));
-	instance_.reset(new Instance(applicationName , *window_, validationLayers));
-	debugUtilsMessenger_.reset(enableValidationLayers ? new DebugUtilsMessenger(*instance_, VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT) : nullptr);
-	surface_.reset(new Surface(*instance_));
+	{
+		const auto phase = startupTimer_.Measure("window");
+		window_.reset(new class Window(windowConfig));
+	}
+
+	{
+		const auto phase = startupTimer_.Measure("instance");
+		instance_.reset(new Instance(applicationName , *window_, validationLayers, hostAllocator_ ? hostAllocator_->Callbacks() : nullptr));
+		debugUtilsMessenger_.reset(enableValidationLayers ? new DebugUtilsMessenger(*instance_, VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) : nullptr);
+		surface_.reset(new class Surface(*instance_));
+	}
 }
 
 Application::~Application() {
 	Application::DeleteSwapChain();
 
+	videoStream_.reset();
+	framePacer_.reset();
+	drawQueue_.reset();
+	particleSystem_.reset();
+	computeCommandPool_.reset();
+	pipelineCompiler_.reset();
+	pipelineCache_.reset();
+	computeTimeline_.reset();
+	graphicsTimeline_.reset();
 	commandPool_.reset();
 	device_.reset();
 	surface_.reset();
 	debugUtilsMessenger_.reset();
 	instance_.reset();
 	window_.reset();
+	hostAllocator_.reset();
 }
 
 const std::vector<VkExtensionProperties>& Application::Extensions() const {
@@ -54,19 +146,112 @@ const std::vector<VkPhysicalDevice>& Application::PhysicalDevices() const {
 	return instance_->PhysicalDevices();
 }
 
-void Application::SetPhysicalDevice(VkPhysicalDevice physicalDevice) {
+void Application::SetPostProcessing(const bool enabled) {
+	if (postProcessing_ == enabled)
+		return;
+
+	// Input callbacks may run in the middle of a frame, the swap chain is rebuilt after its present
+	postProcessing_ = enabled;
+	framebufferResized_ = true;
+}
+
+void Application::SetVideoStream(const std::string& path, const VideoStream::Format format) {
+	if (device_)
+		throw std::logic_error("video stream must be set before the physical device");
+
+	videoStreamPath_ = path;
+	videoStreamFormat_ = format;
+}
+
+void Application::SetFont(const std::string& path) {
+	if (device_)
+		throw std::logic_error("font must be set before the physical device");
+
+	fontData_ = ShaderModule::ReadFile(path);
+}
+
+void Application::SetParticleCount(const uint32_t count) {
+	if (device_)
+		throw std::logic_error("particle count must be set before the physical device");
+
+	particleCount_ = count;
+}
+
+void Application::SetSceneBoxes(std::vector<OcclusionCulling::Box> boxes) {
+	if (device_)
+		throw std::logic_error("scene boxes must be set before the physical device");
+
+	sceneBoxes_ = std::move(boxes);
+}
+
+void Application::SetModel(const std::string& path) {
+	if (device_)
+		throw std::logic_error("model must be set before the physical device");
+
+	const auto phase = startupTimer_.Measure("model");
+	model_.reset(new Utilities::Model(Utilities::Model::Load(path)));
+
+	if (!model_->IsPrecomputed())
+		LOG_WARNING("[mesh] no up to date precomputed levels of detail for '{}', generated {} at load time", path, model_->Lods().size());
+	if (model_->Lods().size() < Utilities::Model::MinLods)
+		LOG_WARNING("[mesh] '{}' cannot be simplified past {} levels of detail", path, model_->Lods().size());
+}
+
+void Application::SetCamera(const std::array<float, 16>& view, const std::array<float, 16>& projection) {
+	view_ = view;
+	projection_ = projection;
+
+	for (size_t column = 0; column != 4; ++column) {
+		for (size_t row = 0; row != 4; ++row) {
+			float sum = 0.0f;
+			for (size_t k = 0; k != 4; ++k) {
+				sum += projection[k * 4 + row] * view[column * 4 + k];
+			}
+			viewProjection_[column * 4 + row] = sum;
+		}
+	}
+}
+
+void Application::SetPhysicalDevice(const PhysicalDeviceInfo& physicalDevice) {
 	if (device_)
 		throw std::logic_error("physical device has already been set");
 
-	device_.reset(new class Device(physicalDevice, *surface_));
-	commandPool_.reset(new class CommandPool(*device_, device_->GraphicsFamilyIndex(), false));
+	{
+		const auto phase = startupTimer_.Measure("device");
+		device_.reset(new class Device(physicalDevice, *surface_));
+		commandPool_.reset(new class CommandPool(*device_, device_->GraphicsFamilyIndex(), true));
+		computeCommandPool_.reset(new class CommandPool(*device_, device_->ComputeFamilyIndex(), true));
+
+		// One timeline per queue, every submission on a queue signals its next value
+		graphicsTimeline_.reset(new TimelineSemaphore(*device_));
+		computeTimeline_.reset(new TimelineSemaphore(*device_));
+		drawQueue_.reset(new DrawQueue(*device_));
+		framePacer_.reset(new FramePacer(*device_));
+	}
+
+	{
+		const auto phase = startupTimer_.Measure("pipeline cache");
+		pipelineCache_.reset(new PipelineCache(*device_, pipelineCacheData_.get()));
+		pipelineCacheData_ = {};
+		pipelineCompiler_.reset(new PipelineCompiler(*pipelineCache_, PipelineManifest::ReadFile(PipelineManifestFile)));
+	}
+
+	if (particleCount_ != 0) {
+		const auto phase = startupTimer_.Measure("particles");
+		particleSystem_.reset(new ParticleSystem(*device_, *pipelineCache_, particleCount_));
+		particleSystem_->SetEmitRate(static_cast<float>(particleCount_) / ParticleSystem::MeanLifetime);
+	}
 
 	OnDeviceSet();
 
-	// Create swap chain
-	CreateSwapChain();
-	// Create command buffers
-	createCommandBuffers();
+	{
+		const auto phase = startupTimer_.Measure("swap chain and pipelines");
+
+		// Create swap chain
+		CreateSwapChain();
+		// Create command buffers
+		createCommandBuffers();
+	}
 }
 
 void Application::Run() {
@@ -81,8 +266,14 @@ void Application::Run() {
 	window_->OnMouseButton = [this](const int button, const int action, const int mods) { OnMouseButton(button, action, mods); };
 	window_->OnScroll = [this](const double xoffset, const double yoffset) { OnScroll(xoffset, yoffset); };
 	window_->OnFramebufferSize = [this](const int width, const int height) { OnFramebufferSize(width, height); };
+
+	firstFrameBegin_ = startupTimer_.Elapsed();
 	window_->Run();
 	device_->WaitIdle();
+
+	// Pipelines compiled during this run are reused by the next one, and the ones it used are prewarmed
+	pipelineCache_->WriteFile(PipelineCacheFile);
+	pipelineCompiler_->Manifest().WriteFile(PipelineManifestFile);
 }
 
 void Application::CreateSwapChain() {
@@ -95,56 +286,161 @@ void Application::CreateSwapChain() {
 
 	swapChain_.reset(new class SwapChain(*device_, presentMode_));
 
-	// Create Semaphores for each swapChain ImageViews and frame for CPU-GPU syncro
+	// Create Semaphores for each swapChain ImageViews, CPU-GPU syncro is done with the graphics timeline
 	for (size_t i = 0; i != swapChain_->ImageViews().size(); ++i) {
 		imageAvailableSemaphores_.emplace_back(*device_);
 		renderFinishedSemaphores_.emplace_back(*device_);
-		inFlightFences_.emplace_back(*device_, true);
 	}
 
-	graphicsPipeline_.reset(new class GraphicsPipeline(*swapChain_, isWireFrame_));
+	frameTimelineValues_.assign(swapChain_->ImageViews().size(), graphicsTimeline_->PendingValue());
+	framePacer_->Reset();
+
+	// The scene goes straight to the swap chain image, or to the HDR target of the post-processing chain
+	const auto sceneFormat = postProcessing_ ? PostProcess::HdrFormat : swapChain_->Format();
+	const auto sceneLayout = postProcessing_ ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	// One depth buffer shared by the frames in flight, their scenes are drawn one after the other on the graphics queue
+	depthBuffer_.reset(new DepthBuffer(*device_, swapChain_->Extent()));
+
+	// Fill and wireframe variants are both prewarmed so toggling between them is free
+	graphicsPipelineCache_.reset(new class GraphicsPipelineCache(*device_, *pipelineCompiler_, sceneFormat, DepthBuffer::Format, sceneLayout, vertShaderCode_.get(), fragShaderCode_.get()));
+	graphicsPipelineCache_->Prewarm({
+		PipelineState(),
+		PipelineState().WithPolygonMode(VK_POLYGON_MODE_LINE)
+	});
+
+	spriteBatch_.reset(new SpriteBatch(*device_, *pipelineCompiler_, graphicsPipelineCache_->RenderPass(), sceneFormat, DepthBuffer::Format, static_cast<uint32_t>(frameTimelineValues_.size()), MaxSprites));
+
+	if (particleSystem_)
+		particleSystem_->SetRenderTarget(*pipelineCompiler_, graphicsPipelineCache_->RenderPass(), sceneFormat, DepthBuffer::Format);
+
+	if (!fontData_.empty())
+		textRenderer_.reset(new TextRenderer(*device_, *pipelineCompiler_, graphicsPipelineCache_->RenderPass(), sceneFormat, DepthBuffer::Format, static_cast<uint32_t>(frameTimelineValues_.size()), fontData_));
+
+	frameAllocator_.reset(new class FrameAllocator(*device_, static_cast<uint32_t>(frameTimelineValues_.size()), FrameAllocatorSize));
+
+	if (!sceneBoxes_.empty() || model_)
+		lighting_.reset(new ClusteredLighting(*device_, *pipelineCache_, *frameAllocator_, MaxLights));
+
+	if (!sceneBoxes_.empty())
+		occlusionCulling_.reset(new OcclusionCulling(*device_, *pipelineCompiler_, *depthBuffer_, *lighting_, graphicsPipelineCache_->RenderPass(), sceneFormat, static_cast<uint32_t>(frameTimelineValues_.size()), sceneBoxes_));
+
+	if (model_)
+		lodMesh_.reset(new LodMesh(*device_, *pipelineCompiler_, graphicsPipelineCache_->RenderPass(), sceneFormat, DepthBuffer::Format, static_cast<uint32_t>(frameTimelineValues_.size()), MaxModelInstances, *model_, *lighting_));
+
+	if (postProcessing_)
+		postProcess_.reset(new PostProcess(*swapChain_, *pipelineCache_, graphicsPipelineCache_->RenderPass(), *depthBuffer_, static_cast<uint32_t>(frameTimelineValues_.size())));
+
+	// FrameBuffers creation (not needed with dynamic rendering)
+	if (!device_->IsDynamicRenderingEnabled() && !postProcessing_) {
+		for (const auto& imageView : swapChain_->ImageViews()) {
+			swapChainFramebuffers_.emplace_back(*imageView, *graphicsPipelineCache_->RenderPass(), swapChain_->Extent(), &depthBuffer_->ImageView());
+		}
+	}
+
+	timestampQueryPool_.reset(new TimestampQueryPool(*device_, device_->GraphicsFamilyIndex(), static_cast<uint32_t>(frameTimelineValues_.size()), TimestampCount));
+	performanceOverlay_.reset(new PerformanceOverlay(*swapChain_, *commandPool_));
 
-	// FrameBuffers creation
-	for (const auto& imageView : swapChain_->ImageViews()) {
-		swapChainFramebuffers_.emplace_back(*imageView, graphicsPipeline_->RenderPass());
+	if (FrameCapture::IsSupported(*swapChain_)) {
+		frameCapture_.reset(new FrameCapture(*swapChain_, *graphicsTimeline_, CaptureDirectory));
+		frameCapture_->SetContinuous(continuousCapture_);
 	}
 
+	// The stream outlives the swap chain, its frame size is the one of the first swap chain
+	if (!videoStreamPath_.empty() && !videoStream_)
+		videoStream_.reset(new VideoStream(*device_, *pipelineCache_, *graphicsTimeline_, videoStreamPath_, videoStreamFormat_, swapChain_->Extent()));
+
+	if (videoStream_)
+		videoStream_->SetSwapChain(swapChain_.get());
 
+	// Prewarmed pipelines compiled on the compiler threads while the rest was created, none is left to the first frame
+	pipelineCompiler_->Wait();
+	pipelineCompiler_->Report();
 }
 
 void Application::DeleteSwapChain() {
+	if (videoStream_)
+		videoStream_->SetSwapChain(nullptr);
+
+	frameCapture_.reset();
+	performanceOverlay_.reset();
+	timestampQueryPool_.reset();
+	presentCommandBuffers_.reset();
+	computeCommandBuffers_.reset();
+	particleCommandBuffers_.reset();
 	commandBuffers_.reset();
+	postProcess_.reset();
 	swapChainFramebuffers_.clear();
-	graphicsPipeline_.reset();
-	inFlightFences_.clear();
+	lodMesh_.reset();
+	occlusionCulling_.reset();
+	lighting_.reset();
+	frameAllocator_.reset();
+	textRenderer_.reset();
+	spriteBatch_.reset();
+	graphicsPipelineCache_.reset();
+	depthBuffer_.reset();
+	frameTimelineValues_.clear();
 	renderFinishedSemaphores_.clear();
 	imageAvailableSemaphores_.clear();
 	swapChain_.reset();
 }
 
 void Application::createCommandBuffers() {
-	commandBuffers_.reset(new CommandBuffers(*commandPool_, static_cast<uint32_t>(swapChainFramebuffers_.size())));
+	// One command buffer per frame in flight, re-recorded every frame in DrawFrame
+	const auto count = static_cast<uint32_t>(frameTimelineValues_.size());
+	commandBuffers_.reset(new CommandBuffers(*commandPool_, count));
+
+	if (particleSystem_)
+		particleCommandBuffers_.reset(new CommandBuffers(*computeCommandPool_, count));
 
-	for (size_t i = 0; i < commandBuffers_->Size(); ++i) {
-		const auto commandBuffer = commandBuffers_->Begin(i);
-		Render(commandBuffer, i);
-		commandBuffers_->End(i);
+	if (postProcess_) {
+		computeCommandBuffers_.reset(new CommandBuffers(*computeCommandPool_, count));
+		presentCommandBuffers_.reset(new CommandBuffers(*commandPool_, count));
 	}
 }
 
 void Application::DrawFrame() {
 	constexpr auto noTimeout = std::numeric_limits<uint64_t>::max();
 
-	auto& inFlightFence = inFlightFences_[currentFrame_];
 	const auto imageAvailableSemaphore = imageAvailableSemaphores_[currentFrame_].Handle();
 	const auto renderFinishedSemaphore = renderFinishedSemaphores_[currentFrame_].Handle();
 
-	inFlightFence.Wait(noTimeout);
+	// In low latency mode, wait until just before the next image is needed and only then sample input
+	if (lowLatency_) {
+		framePacer_->WaitForNextFrame(swapChain_->Handle(), frameStats_);
+		window_->PollEvents();
+	}
+
+	const auto frameStart = std::chrono::steady_clock::now();
+	framePacer_->OnInputSampled();
+
+	// Wait for the last submission using this frame resources, then release what is no longer in use
+	graphicsTimeline_->Wait(frameTimelineValues_[currentFrame_], noTimeout);
+
+	if (frameCapture_)
+		frameCapture_->Collect();
+
+	if (videoStream_)
+		videoStream_->Collect();
+
+	if (occlusionCulling_)
+		occlusionCulling_->Collect(static_cast<uint32_t>(currentFrame_));
+
+	// The GPU timings of this slot previous frame are complete now
+	if (timestampQueryPool_->Fetch(static_cast<uint32_t>(currentFrame_))) {
+		frameStats_.Record(Vulkan::FrameStats::Metric::Gpu, timestampQueryPool_->Elapsed(FrameBegin, FrameEnd));
+		if (showOverlay_)
+			frameStats_.Record(Vulkan::FrameStats::Metric::OverlayGpu, timestampQueryPool_->Elapsed(OverlayBegin, FrameEnd));
+	}
+
+	const auto acquireStart = std::chrono::steady_clock::now();
 
 	uint32_t imageIndex;
-	auto result = vkAcquireNextImageKHR(device_->Handle(), swapChain_->Handle(), noTimeout, imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
+	auto result = device_->Dispatch().vkAcquireNextImageKHR(device_->Handle(), swapChain_->Handle(), noTimeout, imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
+
+	frameStats_.Record(Vulkan::FrameStats::Metric::Acquire, MillisecondsSince(acquireStart));
 
-	if (result == VK_ERROR_OUT_OF_DATE_KHR || isWireFrame_ != graphicsPipeline_->IsWireFrame()) {
+	if (result == VK_ERROR_OUT_OF_DATE_KHR) {
 		RecreateSwapChain();
 		return;
 	}
@@ -153,37 +449,151 @@ void Application::DrawFrame() {
 		throw std::runtime_error(std::string("failed to acquire next image (") + toString(result) + ")");
 	}
 
-	VkSubmitInfo submitInfo = {};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	// The particle step starts once the last frame drawing the particles is done, and this frame scene waits for it
+	uint64_t particleValue = 0;
 
-	VkCommandBuffer commandBuffers[]{ commandBuffers_->get(currentFrame_) };
-	VkSemaphore waitSemaphores[] = { imageAvailableSemaphore };
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-	VkSemaphore signalSemaphores[] = { renderFinishedSemaphore };
+	if (particleSystem_) {
+		const double time = window_->GetTime();
+		const auto deltaTime = static_cast<float>(std::min(time - lastParticleStep_, MaxParticleStep));
+		lastParticleStep_ = time;
 
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = waitSemaphores;
-	submitInfo.pWaitDstStageMask = waitStages;
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = commandBuffers;
-	submitInfo.signalSemaphoreCount = 1;
-	submitInfo.pSignalSemaphores = signalSemaphores;
+		const auto particleCommandBuffer = particleCommandBuffers_->Begin(currentFrame_);
+		particleSystem_->Record(particleCommandBuffer, deltaTime);
+		particleCommandBuffers_->End(currentFrame_);
 
-	inFlightFence.Reset();
+		particleValue = computeTimeline_->NextValue();
+
+		QueueSubmission()
+			.Wait(*graphicsTimeline_, graphicsTimeline_->PendingValue(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT)
+			.Execute(particleCommandBuffer)
+			.Signal(*computeTimeline_, particleValue)
+			.Submit(*device_, device_->ComputeQueue());
+	}
 
-	Check(vkQueueSubmit(device_->GraphicsQueue(), 1, &submitInfo, inFlightFence.Handle()), "submit draw command buffer");
+	const auto frame = static_cast<uint32_t>(currentFrame_);
+	auto commandBuffer = commandBuffers_->Begin(currentFrame_);
+	timestampQueryPool_->Reset(commandBuffer, frame);
+	timestampQueryPool_->Write(commandBuffer, frame, FrameBegin, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+	// Text is written straight into this frame region of the vertex ring, which the timeline wait above freed
+	if (textRenderer_)
+		textRenderer_->BeginFrame(frame);
+
+	// Same for the uniform and storage data of the frame
+	frameAllocator_->Begin(frame);
+
+	Render(commandBuffer, imageIndex);
+
+	// The last submission of the frame touches the swap chain image, and waits for the image to be acquired
+	auto* frameCommandBuffers = commandBuffers_.get();
+	QueueSubmission submission;
+	QueueSubmission sceneSubmission;
+
+	if (particleValue != 0)
+		(postProcess_ ? sceneSubmission : submission).Wait(*computeTimeline_, particleValue, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+
+	if (postProcess_) {
+		// The scene does not touch the swap chain image, it is submitted without waiting for it
+		commandBuffers_->End(currentFrame_);
+
+		const auto sceneValue = graphicsTimeline_->NextValue();
+
+		sceneSubmission
+			.Execute(commandBuffer)
+			.Signal(*graphicsTimeline_, sceneValue)
+			.Submit(*device_, device_->GraphicsQueue());
+
+		// Meanwhile the graphics queue can go on with the next frame scene
+		const auto computeCommandBuffer = computeCommandBuffers_->Begin(currentFrame_);
+		postProcess_->Record(computeCommandBuffer, frame);
+		computeCommandBuffers_->End(currentFrame_);
+
+		const auto postValue = computeTimeline_->NextValue();
+
+		QueueSubmission()
+			.Wait(*graphicsTimeline_, sceneValue, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT)
+			.Execute(computeCommandBuffer)
+			.Signal(*computeTimeline_, postValue)
+			.Submit(*device_, device_->ComputeQueue());
+
+		frameCommandBuffers = presentCommandBuffers_.get();
+		commandBuffer = frameCommandBuffers->Begin(currentFrame_);
+		postProcess_->CopyToSwapChain(commandBuffer, frame, imageIndex);
+
+		submission
+			.Wait(*computeTimeline_, postValue, VK_PIPELINE_STAGE_TRANSFER_BIT)
+			.Wait(imageAvailableSemaphore, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	}
+	else {
+		submission.Wait(imageAvailableSemaphore, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+	}
+
+	timestampQueryPool_->Write(commandBuffer, frame, OverlayBegin, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+	if (showOverlay_) {
+		const auto overlayStart = std::chrono::steady_clock::now();
+
+		performanceOverlay_->Render(commandBuffer, imageIndex, frameStats_);
+		frameStats_.Record(Vulkan::FrameStats::Metric::OverlayCpu, MillisecondsSince(overlayStart));
+	}
+
+	timestampQueryPool_->Write(commandBuffer, frame, FrameEnd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+	// Not part of the measured GPU frame time, the copy only happens while capturing
+	if (frameCapture_)
+		frameCapture_->Record(commandBuffer, imageIndex, graphicsTimeline_->PendingValue() + 1);
+
+	if (videoStream_)
+		videoStream_->Record(commandBuffer, imageIndex, graphicsTimeline_->PendingValue() + 1);
+
+	frameCommandBuffers->End(currentFrame_);
+
+	const auto frameValue = graphicsTimeline_->NextValue();
+
+	submission
+		.Execute(commandBuffer)
+		.Signal(renderFinishedSemaphore)
+		.Signal(*graphicsTimeline_, frameValue)
+		.Submit(*device_, device_->GraphicsQueue());
+
+	frameTimelineValues_[currentFrame_] = frameValue;
+
+	const uint64_t presentId = framePacer_->NextPresentId();
+
+	VkPresentIdKHR presentIdInfo = {};
+	presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+	presentIdInfo.swapchainCount = 1;
+	presentIdInfo.pPresentIds = &presentId;
 
 	VkSwapchainKHR swapChains[] = { swapChain_->Handle() };
 	VkPresentInfoKHR presentInfo = {};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	presentInfo.pNext = presentId != 0 ? &presentIdInfo : nullptr;
 	presentInfo.waitSemaphoreCount = 1;
-	presentInfo.pWaitSemaphores = signalSemaphores;
+	presentInfo.pWaitSemaphores = &renderFinishedSemaphore;
 	presentInfo.swapchainCount = 1;
 	presentInfo.pSwapchains = swapChains;
 	presentInfo.pImageIndices = &imageIndex;
 	presentInfo.pResults = nullptr; // Optional
 
-	result = vkQueuePresentKHR(device_->PresentQueue(), &presentInfo);
+	const auto presentStart = std::chrono::steady_clock::now();
+	result = device_->Dispatch().vkQueuePresentKHR(device_->PresentQueue(), &presentInfo);
+	frameStats_.Record(Vulkan::FrameStats::Metric::Present, MillisecondsSince(presentStart));
+
+	framePacer_->OnPresented(frameStats_);
+	frameStats_.Record(Vulkan::FrameStats::Metric::CpuFrame, MillisecondsSince(frameStart));
+
+	if (!startupReported_)
+		ReportStartup();
+	frameStats_.EndFrame();
+
+	if (statsInterval_ > 0 && frameStats_.Report(window_->GetTime(), statsInterval_)) {
+		device_->MemoryStatistics().UpdateBudget();
+		device_->MemoryStatistics().Report();
+
+		if (hostAllocator_)
+			hostAllocator_->Report();
+	}
 
 	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized_) {
 		framebufferResized_ = false;
@@ -194,42 +604,263 @@ void Application::DrawFrame() {
 	if (result != VK_SUCCESS)
 		throw std::runtime_error(std::string("failed to present next image (") + toString(result) + ")");
 
-	currentFrame_ = (currentFrame_ + 1) % inFlightFences_.size();
+	currentFrame_ = (currentFrame_ + 1) % frameTimelineValues_.size();
 }
 
 void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageIndex) {
-	std::array<VkClearValue, 1> clearValues = {};
-	clearValues[0].color = { {1.0f, 0.0f, 0.0f, 1.0f} };
-
-	VkRenderPassBeginInfo renderPassInfo = {};
-	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassInfo.renderPass = graphicsPipeline_->RenderPass().Handle();
-	renderPassInfo.framebuffer = swapChainFramebuffers_[imageIndex].Handle();
-	renderPassInfo.renderArea.offset = { 0, 0 };
-	renderPassInfo.renderArea.extent = swapChain_->Extent();
-	renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-	renderPassInfo.pClearValues = clearValues.data();
-
-	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	VkClearValue clearValue = {};
+	clearValue.color = { {1.0f, 0.0f, 0.0f, 1.0f} };
+
+	VkViewport viewport = {};
+	viewport.x = 0.0f;
+	viewport.y = 0.0f;
+	viewport.width = static_cast<float>(swapChain_->Extent().width);
+	viewport.height = static_cast<float>(swapChain_->Extent().height);
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+
+	VkRect2D scissor = {};
+	scissor.offset = { 0, 0 };
+	scissor.extent = swapChain_->Extent();
+
+	// The pipeline variant is picked per draw, no swap chain rebuild needed
+	const auto& graphicsPipeline = graphicsPipelineCache_->Get(
+		PipelineState().WithPolygonMode(isWireFrame_ ? VK_POLYGON_MODE_LINE : VK_POLYGON_MODE_FILL));
+
+	const auto& dispatch = device_->Dispatch();
+
+	// Glyphs rasterized while the frame text was queued are copied before rendering starts
+	if (textRenderer_)
+		textRenderer_->Upload(commandBuffer);
+
+	// The triangle goes through the draw queue with whatever the derived application queued
+	drawQueue_->Submit(0, graphicsPipeline, graphicsPipelineCache_->PipelineLayout(), VK_NULL_HANDLE, 1.0f, { 3 });
+
+	// First phase: the boxes visible in the previous frame depth pyramid
+	if (occlusionCulling_)
+		occlusionCulling_->Cull(commandBuffer, 0, viewProjection_);
+
+	if (lighting_)
+		lighting_->Assign(commandBuffer, view_, projection_, swapChain_->Extent());
+
+	BeginRendering(commandBuffer, imageIndex, clearValue);
 	{
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_->Handle());
+		dispatch.vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		dispatch.vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+		drawQueue_->Record(commandBuffer, frameStats_);
+
+		if (occlusionCulling_)
+			occlusionCulling_->Draw(commandBuffer, 0, viewProjection_, frameStats_);
+
+		// Model instances are not occlusion culled, with the scene boxes they are drawn once both phases are done
+		if (lodMesh_ && !occlusionCulling_)
+			lodMesh_->Render(commandBuffer, static_cast<uint32_t>(currentFrame_), viewProjection_, swapChain_->Extent(), frameStats_);
+	}
+
+	// Second phase: the boxes rejected above that the pyramid of this frame depth shows, the overlays go on top of them
+	if (occlusionCulling_) {
+		EndRendering(commandBuffer, imageIndex);
+
+		occlusionCulling_->BuildPyramid(commandBuffer);
+		occlusionCulling_->Cull(commandBuffer, 1, viewProjection_);
+		occlusionCulling_->Readback(commandBuffer, static_cast<uint32_t>(currentFrame_));
+
+		ResumeRendering(commandBuffer, imageIndex);
+
+		dispatch.vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		dispatch.vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-		uint32_t vertexOffset = 0;
-		uint32_t vertexCount = 3;
+		occlusionCulling_->Draw(commandBuffer, 1, viewProjection_, frameStats_);
 
-		vkCmdDraw(commandBuffer, vertexCount, 1, vertexOffset, 0);
+		if (lodMesh_)
+			lodMesh_->Render(commandBuffer, static_cast<uint32_t>(currentFrame_), viewProjection_, swapChain_->Extent(), frameStats_);
 	}
-	vkCmdEndRenderPass(commandBuffer);
+
+	if (particleSystem_)
+		particleSystem_->Render(commandBuffer, swapChain_->Extent(), frameStats_);
+
+	spriteBatch_->Render(commandBuffer, static_cast<uint32_t>(currentFrame_), swapChain_->Extent(), frameStats_);
+
+	if (textRenderer_)
+		textRenderer_->Render(commandBuffer, swapChain_->Extent(), frameStats_);
+
+	EndRendering(commandBuffer, imageIndex);
+}
+
+void Application::BeginRendering(VkCommandBuffer commandBuffer, const uint32_t imageIndex, const VkClearValue& clearValue) {
+	StartRendering(commandBuffer, imageIndex, &clearValue);
+}
+
+void Application::ResumeRendering(VkCommandBuffer commandBuffer, const uint32_t imageIndex) {
+	StartRendering(commandBuffer, imageIndex, nullptr);
 }
 
+void Application::StartRendering(VkCommandBuffer commandBuffer, const uint32_t imageIndex, const VkClearValue* const clearValue) {
+	const auto frame = static_cast<uint32_t>(currentFrame_);
+
+	if (!device_->IsDynamicRenderingEnabled()) {
+		// Depth is cleared to the far plane
+		VkClearValue clearValues[2] = {};
+		if (clearValue != nullptr)
+			clearValues[0] = *clearValue;
+		clearValues[1].depthStencil = { 1.0f, 0 };
+
+		VkRenderPassBeginInfo renderPassInfo = {};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = clearValue != nullptr ? graphicsPipelineCache_->RenderPass()->Handle() : graphicsPipelineCache_->ResumeRenderPass()->Handle();
+		renderPassInfo.framebuffer = postProcess_ ? postProcess_->HdrFrameBuffer(frame)->Handle() : swapChainFramebuffers_[imageIndex].Handle();
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = swapChain_->Extent();
+		renderPassInfo.clearValueCount = clearValue != nullptr ? 2 : 0;
+		renderPassInfo.pClearValues = clearValues;
+
+		device_->Dispatch().vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		return;
+	}
+
+	// Without a render pass, the layout transitions done by its attachment descriptions are explicit.
+	// Resuming keeps the color EndRendering left in its final layout, and the depth the culling left as an attachment.
+	const auto finalLayout = postProcess_ ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	VkImageMemoryBarrier barriers[2] = {};
+	barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barriers[0].srcAccessMask = clearValue != nullptr ? 0 : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	barriers[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | (clearValue != nullptr ? 0 : VK_ACCESS_COLOR_ATTACHMENT_READ_BIT);
+	barriers[0].oldLayout = clearValue != nullptr ? VK_IMAGE_LAYOUT_UNDEFINED : finalLayout;
+	barriers[0].newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barriers[0].image = postProcess_ ? postProcess_->HdrImage(frame) : swapChain_->Images()[imageIndex];
+	barriers[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	// The previous frame depth tests are done before the depth is cleared
+	barriers[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barriers[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	barriers[1].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barriers[1].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	barriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barriers[1].image = depthBuffer_->Image();
+	barriers[1].subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+
+	// The transition to the final layout ended at the bottom of the pipe, resuming waits for all of it
+	const VkPipelineStageFlags srcStages = clearValue != nullptr
+		? VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+		: VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+	device_->Dispatch().vkCmdPipelineBarrier(commandBuffer,
+		srcStages,
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+		0, 0, nullptr, 0, nullptr, clearValue != nullptr ? 2 : 1, barriers);
+
+	VkRenderingAttachmentInfoKHR colorAttachment = {};
+	colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+	colorAttachment.imageView = postProcess_ ? postProcess_->HdrImageView(frame).Handle() : swapChain_->ImageViews()[imageIndex]->Handle();
+	colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	colorAttachment.loadOp = clearValue != nullptr ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	if (clearValue != nullptr)
+		colorAttachment.clearValue = *clearValue;
+
+	VkRenderingAttachmentInfoKHR depthAttachment = {};
+	depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+	depthAttachment.imageView = depthBuffer_->ImageView().Handle();
+	depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	depthAttachment.loadOp = clearValue != nullptr ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	depthAttachment.clearValue.depthStencil = { 1.0f, 0 };
+
+	VkRenderingInfoKHR renderingInfo = {};
+	renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+	renderingInfo.renderArea.offset = { 0, 0 };
+	renderingInfo.renderArea.extent = swapChain_->Extent();
+	renderingInfo.layerCount = 1;
+	renderingInfo.colorAttachmentCount = 1;
+	renderingInfo.pColorAttachments = &colorAttachment;
+	renderingInfo.pDepthAttachment = &depthAttachment;
+
+	device_->CmdBeginRendering(commandBuffer, renderingInfo);
+}
+
+void Application::EndRendering(VkCommandBuffer commandBuffer, const uint32_t imageIndex) {
+	if (!device_->IsDynamicRenderingEnabled()) {
+		device_->Dispatch().vkCmdEndRenderPass(commandBuffer);
+		return;
+	}
+
+	device_->CmdEndRendering(commandBuffer);
+
+	// The post-processing chain samples the HDR target on the compute queue
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	barrier.dstAccessMask = 0;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	barrier.newLayout = postProcess_ ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = postProcess_ ? postProcess_->HdrImage(static_cast<uint32_t>(currentFrame_)) : swapChain_->Images()[imageIndex];
+	barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	device_->Dispatch().vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void Application::OnKey(const int key, const int scancode, const int action, const int mods) {
+	if (action != GLFW_PRESS)
+		return;
+
+	switch (key) {
+	case GLFW_KEY_F1:
+		showOverlay_ = !showOverlay_;
+		break;
+	case GLFW_KEY_F3:
+		continuousCapture_ = !continuousCapture_;
+		if (frameCapture_)
+			frameCapture_->SetContinuous(continuousCapture_);
+		LOG_INFO("continuous frame capture {}", continuousCapture_ ? "started" : "stopped");
+		break;
+	case GLFW_KEY_F4:
+		SetPostProcessing(!postProcessing_);
+		LOG_INFO("post-processing {}", postProcessing_ ? "enabled" : "disabled");
+		break;
+	case GLFW_KEY_F12:
+		if (frameCapture_)
+			frameCapture_->CaptureNext();
+		else
+			LOG_WARNING("the swap chain images cannot be captured on this device");
+		break;
+	default:;
+	}
+}
 
 void Application::OnFramebufferSize(int width, int height) {
 	framebufferResized_ = true;
 }
+void Application::ReportStartup() {
+	const double elapsed = startupTimer_.Elapsed();
+
+	startupReported_ = true;
+	startupTimer_.Record("first frame", firstFrameBegin_, elapsed);
+	startupTimer_.Report("Time to first frame");
+
+	if (elapsed > TimeToFirstFrameTarget)
+		LOG_WARNING("time to first frame is over its {} ms target", TimeToFirstFrameTarget);
+}
+
 void Application::RecreateSwapChain() {
 	device_->WaitIdle();
 	DeleteSwapChain();
 	CreateSwapChain();
+	createCommandBuffers();
+	currentFrame_ = 0;
+
+	// Driver host memory churn of a full swap chain rebuild
+	if (hostAllocator_)
+		hostAllocator_->Report();
 }
 
 }
@@ -1,11 +1,22 @@
 #pragma once
 
 #include "FrameBuffer.hpp"
+#include "FrameStats.hpp"
+#include "OcclusionCulling.hpp"
+#include "VideoStream.hpp"
 #include "WindowConfig.hpp"
+#include "../Utilities/PhaseTimer.hpp"
 
+#include <array>
+#include <functional>
+#include <future>
+#include <string>
 #include <vector>
 #include <memory>
 
+namespace Utilities {
+	class Model;
+}
 
 namespace Vulkan {
 
@@ -19,23 +30,81 @@ namespace Vulkan {
 		const std::vector<VkExtensionProperties>& Extensions() const;
 		const std::vector<VkPhysicalDevice>& PhysicalDevices() const;
 
+		const class Instance& Instance() const { return *instance_; }
+		const class Surface& Surface() const { return *surface_; }
+		const class Device& Device() const { return *device_; }
 		const class SwapChain& SwapChain() const { return *swapChain_; }
 		class Window& Window() { return *window_; }
 		const class Window& Window() const { return *window_; }
 
 		bool HasSwapChain() const { return swapChain_.operator bool(); }
+		const class FrameStats& FrameStats() const { return frameStats_; }
+		// Startup phases since the application creation, reported once the first frame is presented
+		Utilities::PhaseTimer& StartupTimer() { return startupTimer_; }
+
+		// Print the frame stats once every interval (in seconds), zero disables it
+		void SetStatsInterval(const double interval) { statsInterval_ = interval; }
+
+		// Render to an HDR target post-processed on the compute queue (bloom, tonemapping, sharpening),
+		// switching at run time rebuilds the swap chain
+		void SetPostProcessing(bool enabled);
+		bool IsPostProcessing() const { return postProcessing_; }
+
+		// Stream the presented frames to a file or named pipe, must be set before the physical device
+		void SetVideoStream(const std::string& path, VideoStream::Format format);
+
+		// TrueType font of the text renderer, no text is drawn without one; must be set before the physical device
+		void SetFont(const std::string& path);
+
+		// GPU particles simulated on the compute queue and drawn over the scene, none by default;
+		// must be set before the physical device
+		void SetParticleCount(uint32_t count);
 
-		void SetPhysicalDevice(VkPhysicalDevice physicalDevice);
+		// Boxes drawn before the sprites with depth testing, culled on the device against the frustum and the
+		// previous frame depth; none by default, must be set before the physical device
+		void SetSceneBoxes(std::vector<OcclusionCulling::Box> boxes);
+
+		// OBJ model drawn instanced at the level of detail of every instance, its levels are read from <path>.lod
+		// when the build generated them; must be set before the physical device
+		void SetModel(const std::string& path);
+
+		void SetPhysicalDevice(const class PhysicalDeviceInfo& physicalDevice);
 		void Run();
 
 	protected:
 
-		Application(const char* applicationName, const WindowConfig& windowConfig, VkPresentModeKHR presentMode, bool enableValidationLayers);
+		Application(const char* applicationName, const WindowConfig& windowConfig, VkPresentModeKHR presentMode, bool enableValidationLayers, bool lowLatency = false, bool hostAllocator = false);
 
-		const class Device& Device() const { return *device_; }
 		class CommandPool& CommandPool() { return *commandPool_; }
-		const class GraphicsPipeline& GraphicsPipeline() const { return *graphicsPipeline_; }
+		class GraphicsPipelineCache& GraphicsPipelineCache() { return *graphicsPipelineCache_; }
 		const class FrameBuffer& SwapChainFrameBuffer(const size_t i) const { return swapChainFramebuffers_[i]; }
+		// Sprites queued before Render are drawn over the scene, the batch is recreated with the swap chain
+		class SpriteBatch& Sprites() { return *spriteBatch_; }
+		// Draws sorted by pass, pipeline, material and depth, recorded right after the scene triangle
+		class DrawQueue& Draws() { return *drawQueue_; }
+		// Same for text, only when a font is set
+		bool HasText() const { return textRenderer_.operator bool(); }
+		class TextRenderer& Text() { return *textRenderer_; }
+		// Same for the scene boxes, only when there are some
+		bool HasSceneBoxes() const { return occlusionCulling_.operator bool(); }
+		const OcclusionCulling::Statistics& SceneBoxStatistics() const { return occlusionCulling_->LastStatistics(); }
+		// Same for the model instances, only when a model is set
+		bool HasModel() const { return lodMesh_.operator bool(); }
+		class LodMesh& Models() { return *lodMesh_; }
+		// Point and spot lights queued before Render light the scene boxes and the model,
+		// the lighting exists whenever one of them does
+		bool HasLighting() const { return lighting_.operator bool(); }
+		class ClusteredLighting& Lights() { return *lighting_; }
+		// Column major, depth from 0 to 1 and y pointing down in clip space
+		void SetCamera(const std::array<float, 16>& view, const std::array<float, 16>& projection);
+
+		// Uniform and storage data of the frame being recorded, bound with dynamic offsets; recreated with the swap chain
+		class FrameAllocator& FrameAllocator() { return *frameAllocator_; }
+
+		// Per queue timelines: frame completion (graphics) and async compute.
+		// Uploads are recorded in the frame command buffer, their completion is the frame one.
+		class TimelineSemaphore& GraphicsTimeline() { return *graphicsTimeline_; }
+		class TimelineSemaphore& ComputeTimeline() { return *computeTimeline_; }
 
 		virtual void CreateSwapChain();
 		virtual void DeleteSwapChain();
@@ -43,8 +112,14 @@ namespace Vulkan {
 		virtual void DrawFrame();
 		virtual void Render(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 
+		// Begin/end rendering to a swap chain image, through a render pass or dynamic rendering depending on the device
+		void BeginRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, const VkClearValue& clearValue);
+		// Begin again after an EndRendering of the same frame, keeping what was drawn
+		void ResumeRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+		void EndRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+
 		virtual void OnDeviceSet() { };
-		virtual void OnKey(int key, int scancode, int action, int mods) { }
+		virtual void OnKey(int key, int scancode, int action, int mods);
 		virtual void OnCursorPosition(double xpos, double ypos) { }
 		virtual void OnMouseButton(int button, int action, int mods) { }
 		virtual void OnScroll(double xoffset, double yoffset) { }
@@ -56,22 +131,78 @@ namespace Vulkan {
 	private:
 
 		void RecreateSwapChain();
+		// A null clear value loads the attachments
+		void StartRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, const VkClearValue* clearValue);
+		void ReportStartup();
 
 		const VkPresentModeKHR presentMode_;
-		
+		const bool lowLatency_;
+
+		Utilities::PhaseTimer startupTimer_;
+		double firstFrameBegin_{};
+		bool startupReported_{};
+
+		// Read on background threads while the instance and the device are created
+		std::shared_future<std::vector<char>> vertShaderCode_;
+		std::shared_future<std::vector<char>> fragShaderCode_;
+		std::shared_future<std::vector<char>> pipelineCacheData_;
+
+		std::unique_ptr<class HostAllocator> hostAllocator_;
 		std::unique_ptr<class Window> window_;
 		std::unique_ptr<class Instance> instance_;
 		std::unique_ptr<class DebugUtilsMessenger> debugUtilsMessenger_;
 		std::unique_ptr<class Surface> surface_;
 		std::unique_ptr<class Device> device_;
+		std::unique_ptr<class PipelineCache> pipelineCache_;
+		std::unique_ptr<class PipelineCompiler> pipelineCompiler_;
 		std::unique_ptr<class SwapChain> swapChain_;
-		std::unique_ptr<class GraphicsPipeline> graphicsPipeline_;
+		std::unique_ptr<class DepthBuffer> depthBuffer_;
+		std::unique_ptr<class GraphicsPipelineCache> graphicsPipelineCache_;
 		std::vector<class FrameBuffer> swapChainFramebuffers_;
+		std::unique_ptr<class DrawQueue> drawQueue_;
+		std::unique_ptr<class SpriteBatch> spriteBatch_;
+		std::unique_ptr<class TextRenderer> textRenderer_;
+		std::vector<char> fontData_;
+		// The particle system outlives the swap chain, only its draw pipeline is recreated
+		std::unique_ptr<class ParticleSystem> particleSystem_;
+		std::unique_ptr<class CommandBuffers> particleCommandBuffers_;
+		uint32_t particleCount_{};
+		std::unique_ptr<class OcclusionCulling> occlusionCulling_;
+		std::vector<OcclusionCulling::Box> sceneBoxes_;
+		std::unique_ptr<Utilities::Model> model_;
+		std::unique_ptr<class LodMesh> lodMesh_;
+		std::unique_ptr<class FrameAllocator> frameAllocator_;
+		std::unique_ptr<class ClusteredLighting> lighting_;
+		std::array<float, 16> view_{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+		std::array<float, 16> projection_{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+		std::array<float, 16> viewProjection_{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+		double lastParticleStep_{};
 		std::unique_ptr<class CommandPool> commandPool_;
 		std::unique_ptr<class CommandBuffers> commandBuffers_;
+		std::unique_ptr<class CommandPool> computeCommandPool_;
+		// With post-processing, a frame is split in three submissions: the scene (commandBuffers_),
+		// the chain on the compute queue, and the copy to the swap chain image followed by the overlay
+		std::unique_ptr<class CommandBuffers> computeCommandBuffers_;
+		std::unique_ptr<class CommandBuffers> presentCommandBuffers_;
+		std::unique_ptr<class PostProcess> postProcess_;
 		std::vector<class Semaphore> imageAvailableSemaphores_;
 		std::vector<class Semaphore> renderFinishedSemaphores_;
-		std::vector<class Fence> inFlightFences_;
+		std::unique_ptr<class TimelineSemaphore> graphicsTimeline_;
+		std::unique_ptr<class TimelineSemaphore> computeTimeline_;
+		std::vector<uint64_t> frameTimelineValues_;
+		std::unique_ptr<class FramePacer> framePacer_;
+		std::unique_ptr<class TimestampQueryPool> timestampQueryPool_;
+		std::unique_ptr<class PerformanceOverlay> performanceOverlay_;
+		std::unique_ptr<class FrameCapture> frameCapture_;
+		std::unique_ptr<class VideoStream> videoStream_;
+		std::string videoStreamPath_;
+		VideoStream::Format videoStreamFormat_{};
+
+		class FrameStats frameStats_;
+		double statsInterval_{};
+		bool showOverlay_{};
+		bool continuousCapture_{};
+		bool postProcessing_{};
 
 		size_t currentFrame_{};
 
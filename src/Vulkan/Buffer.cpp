@@ -0,0 +1,56 @@
+#include "Buffer.hpp"
+
+#include "Device.hpp"
+
+#include <algorithm>
+
+namespace Vulkan {
+
+Buffer::Buffer(
+	const class Device& device,
+	const VkDeviceSize size,
+	const VkBufferUsageFlags usage,
+	const VkMemoryPropertyFlags properties,
+	const char* const tag,
+	const VkMemoryPropertyFlags preferredProperties,
+	const std::vector<uint32_t>& queueFamilyIndices) :
+	device_(device),
+	size_(size)
+{
+	std::vector<uint32_t> families = queueFamilyIndices;
+	std::sort(families.begin(), families.end());
+	families.erase(std::unique(families.begin(), families.end()), families.end());
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = usage;
+
+	if (families.size() > 1) {
+		bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(families.size());
+		bufferInfo.pQueueFamilyIndices = families.data();
+	} else {
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	}
+
+	Check(device.Dispatch().vkCreateBuffer(device.Handle(), &bufferInfo, device.Allocator(), &buffer_), "create buffer");
+
+	VkMemoryRequirements requirements;
+	device.Dispatch().vkGetBufferMemoryRequirements(device.Handle(), buffer_, &requirements);
+
+	memory_.reset(new DeviceMemory(device, requirements, properties, tag, preferredProperties));
+
+	Check(device.Dispatch().vkBindBufferMemory(device.Handle(), buffer_, memory_->Handle(), 0), "bind buffer memory");
+}
+
+Buffer::~Buffer() {
+	if (buffer_ != nullptr) {
+		device_.Dispatch().vkDestroyBuffer(device_.Handle(), buffer_, device_.Allocator());
+		buffer_ = nullptr;
+	}
+
+	memory_.reset();
+}
+
+}
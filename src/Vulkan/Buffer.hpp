@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include "DeviceMemory.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace Vulkan {
+	class Device;
+
+	// A buffer bound to its own device memory allocation.
+	class Buffer final {
+	public:
+
+		VULKAN_NON_COPIABLE(Buffer)
+
+		// Buffers used by several queue families are shared concurrently, no ownership transfer is needed
+		Buffer(
+			const Device& device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, const char* tag,
+			VkMemoryPropertyFlags preferredProperties = 0, const std::vector<uint32_t>& queueFamilyIndices = {});
+		~Buffer();
+
+		const class Device& Device() const { return device_; }
+		VkDeviceSize Size() const { return size_; }
+		DeviceMemory& Memory() { return *memory_; }
+		const DeviceMemory& Memory() const { return *memory_; }
+
+	private:
+
+		const class Device& device_;
+		const VkDeviceSize size_;
+
+		VULKAN_HANDLE(VkBuffer, buffer_)
+
+		std::unique_ptr<DeviceMemory> memory_;
+	};
+
+}
@@ -0,0 +1,171 @@
+#include "ClusteredLighting.hpp"
+
+#include "Buffer.hpp"
+#include "ComputePipeline.hpp"
+#include "DescriptorPool.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+#include "FrameAllocator.hpp"
+#include "PipelineLayout.hpp"
+#include "ShaderModule.hpp"
+#include "../Utilities/Log.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace Vulkan {
+
+	namespace {
+		constexpr uint32_t AssignGroupSize = 64;
+		constexpr uint32_t ClusterCount = ClusteredLighting::ClusterCountX * ClusteredLighting::ClusterCountY * ClusteredLighting::ClusterCountZ;
+
+		enum Binding : uint32_t {
+			Parameters,
+			Lights,
+			Counts,
+			Indices,
+			BindingCount
+		};
+	}
+
+ClusteredLighting::ClusteredLighting(const Device& device, const PipelineCache& pipelineCache, FrameAllocator& frameAllocator, const uint32_t maxLights) :
+	device_(device),
+	frameAllocator_(frameAllocator),
+	maxLights_(maxLights)
+{
+	const auto deviceLocal = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+	// The lights are allocated first, the parameters follow them at the next aligned offset
+	const VkDeviceSize alignment = frameAllocator.Alignment();
+	const VkDeviceSize lightsSize = (std::max<VkDeviceSize>(maxLights, 1) * sizeof(Light) + alignment - 1) / alignment * alignment;
+
+	if (lightsSize + sizeof(ClusterParameters) > frameAllocator.FrameSize())
+		throw std::invalid_argument(std::to_string(maxLights) + " lights exceed the frame allocator size");
+
+	// Shared by the frames in flight, every assignment waits for the previous frame fragments
+	counts_.reset(new Buffer(device, ClusterCount * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, deviceLocal, "cluster light counts"));
+	indices_.reset(new Buffer(device, VkDeviceSize(ClusterCount) * MaxLightsPerCluster * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, deviceLocal, "cluster light indices"));
+
+	std::vector<VkDescriptorSetLayoutBinding> bindings;
+	for (uint32_t binding = 0; binding != BindingCount; ++binding) {
+		const auto type =
+			binding == Parameters ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC :
+			binding == Lights ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC :
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings.push_back({ binding, type, 1, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, nullptr });
+	}
+
+	setLayout_.reset(new DescriptorSetLayout(device, bindings));
+	descriptorPool_.reset(new DescriptorPool(device, {
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1 },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 }
+	}, 1, 0));
+
+	descriptorSet_ = descriptorPool_->Allocate(*setLayout_, 1)[0];
+
+	// Infos must stay in place until the update, every write points to one.
+	// The parameters and the lights move with the frame allocations, only their offsets change.
+	const VkDescriptorBufferInfo bufferInfos[] = {
+		frameAllocator.DescriptorInfo(sizeof(ClusterParameters)),
+		frameAllocator.DescriptorInfo(VkDeviceSize(maxLights) * sizeof(Light)),
+		{ counts_->Handle(), 0, VK_WHOLE_SIZE },
+		{ indices_->Handle(), 0, VK_WHOLE_SIZE }
+	};
+
+	std::array<VkWriteDescriptorSet, BindingCount> writes = {};
+	for (uint32_t binding = 0; binding != BindingCount; ++binding) {
+		auto& write = writes[binding];
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = descriptorSet_;
+		write.dstBinding = binding;
+		write.descriptorCount = 1;
+		write.descriptorType = bindings[binding].descriptorType;
+		write.pBufferInfo = &bufferInfos[binding];
+	}
+
+	device.Dispatch().vkUpdateDescriptorSets(device.Handle(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+	pipelineLayout_.reset(new PipelineLayout(device, { setLayout_->Handle() }, {}));
+
+	const ShaderModule assign(device, "../assets/shaders/light_cluster.comp.spv");
+	pipeline_.reset(new ComputePipeline(device, pipelineCache, *pipelineLayout_, assign));
+}
+
+ClusteredLighting::~ClusteredLighting() {
+	pipeline_.reset();
+	pipelineLayout_.reset();
+	descriptorPool_.reset();
+	setLayout_.reset();
+	indices_.reset();
+	counts_.reset();
+}
+
+void ClusteredLighting::Add(const Light& light) {
+	queued_.push_back(light);
+}
+
+void ClusteredLighting::Assign(VkCommandBuffer commandBuffer, const std::array<float, 16>& view, const std::array<float, 16>& projection, const VkExtent2D extent) {
+	lightCount_ = static_cast<uint32_t>(std::min<size_t>(queued_.size(), maxLights_));
+
+	if (lightCount_ != queued_.size() && !reportedDrop_) {
+		LOG_WARNING("[lighting] {} lights dropped, the clusters take {} per frame", queued_.size() - lightCount_, maxLights_);
+		reportedDrop_ = true;
+	}
+
+	// Never empty, the descriptor range starts at the allocation
+	const auto lights = frameAllocator_.Allocate(std::max<size_t>(lightCount_, 1) * sizeof(Light));
+	std::memcpy(lights.Data, queued_.data(), size_t(lightCount_) * sizeof(Light));
+	queued_.clear();
+
+	// Planes of a perspective projection with depth from 0 to 1: z_ndc = (p22 z + p32) / -z
+	float nearPlane = projection[14] / projection[10];
+	float farPlane = projection[14] / (projection[10] + 1.0f);
+
+	// Any other projection leaves no cluster to assign lights to
+	if (!(nearPlane > 0.0f && farPlane > nearPlane)) {
+		nearPlane = 1.0f;
+		farPlane = 2.0f;
+		lightCount_ = 0;
+	}
+
+	const float logRatio = std::log(farPlane / nearPlane);
+
+	ClusterParameters parameters = {};
+	std::copy(view.begin(), view.end(), parameters.View);
+	parameters.Projection[0] = 1.0f / projection[0];
+	parameters.Projection[1] = 1.0f / projection[5];
+	parameters.Projection[2] = nearPlane;
+	parameters.Projection[3] = farPlane;
+	parameters.Grid[0] = ClusterCountX;
+	parameters.Grid[1] = ClusterCountY;
+	parameters.Grid[2] = ClusterCountZ;
+	parameters.Grid[3] = lightCount_;
+	parameters.Screen[0] = static_cast<float>(extent.width);
+	parameters.Screen[1] = static_cast<float>(extent.height);
+	parameters.Screen[2] = ClusterCountZ / logRatio;
+	parameters.Screen[3] = -ClusterCountZ * std::log(nearPlane) / logRatio;
+	dynamicOffsets_ = { frameAllocator_.Push(parameters).Offset, lights.Offset };
+
+	const auto& dispatch = device_.Dispatch();
+
+	// The previous frame fragments are done with the lists before they are overwritten
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		0, nullptr, 0, nullptr, 0, nullptr);
+
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_->Handle());
+	dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout_->Handle(), 0, 1, &descriptorSet_, static_cast<uint32_t>(dynamicOffsets_.size()), dynamicOffsets_.data());
+	dispatch.vkCmdDispatch(commandBuffer, (ClusterCount + AssignGroupSize - 1) / AssignGroupSize, 1, 1);
+
+	VkMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	dispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace Vulkan {
+	class Buffer;
+	class ComputePipeline;
+	class DescriptorPool;
+	class DescriptorSetLayout;
+	class Device;
+	class FrameAllocator;
+	class PipelineCache;
+	class PipelineLayout;
+
+	// Point and spot lights assigned to the clusters of the view frustum on the device.
+	// The frustum is split in screen tiles and exponential depth slices; a compute pass tests every light
+	// against every cluster bounds and writes one index list per cluster, so lit fragments only loop over
+	// the lights of their cluster. Lights are queued every frame and copied to the frame allocator, shaders read
+	// them through DescriptorSet bound with the DynamicOffsets of the last assignment.
+	// Assign is recorded outside of the scene rendering.
+	class ClusteredLighting final {
+	public:
+
+		// Cluster grid, kept in sync with the lit shaders
+		static constexpr uint32_t ClusterCountX = 16;
+		static constexpr uint32_t ClusterCountY = 9;
+		static constexpr uint32_t ClusterCountZ = 24;
+		static constexpr uint32_t MaxLightsPerCluster = 128;
+
+		// A point light has a spot cosine of -1, a spot light lights within the cone of that cosine around its direction
+		struct Light {
+			float Position[3];
+			float Range;
+			float Color[3];
+			float SpotCosine;
+			float Direction[3];
+			float Padding;
+		};
+
+		VULKAN_NON_COPIABLE(ClusteredLighting)
+
+		// The frame allocator holds the lights and the parameters, a frame takes up to maxLights lights
+		ClusteredLighting(const Device& device, const PipelineCache& pipelineCache, FrameAllocator& frameAllocator, uint32_t maxLights);
+		~ClusteredLighting();
+
+		uint32_t MaxLights() const { return maxLights_; }
+		// Lights assigned by the last Assign
+		uint32_t LightCount() const { return lightCount_; }
+
+		// Set 1 of the lit pipelines (set 0 when they have no other), read by fragment shaders
+		const DescriptorSetLayout& SetLayout() const { return *setLayout_; }
+		VkDescriptorSet DescriptorSet() const { return descriptorSet_; }
+		const std::array<uint32_t, 2>& DynamicOffsets() const { return dynamicOffsets_; }
+
+		void Add(const Light& light);
+
+		// Assign and clear the queued lights, lights past MaxLights are dropped.
+		// View and projection are column major, the projection a perspective one with depth from 0 to 1.
+		void Assign(VkCommandBuffer commandBuffer, const std::array<float, 16>& view, const std::array<float, 16>& projection, VkExtent2D extent);
+
+	private:
+
+		// std140, shared by the assignment and the lit shaders
+		struct ClusterParameters {
+			float View[16];
+			// 1 / projection[0][0], 1 / projection[1][1], near and far planes
+			float Projection[4];
+			// Cluster grid and light count
+			uint32_t Grid[4];
+			// Target size in pixels, then the scale and bias from the log of the view depth to the depth slice
+			float Screen[4];
+		};
+
+		const Device& device_;
+		FrameAllocator& frameAllocator_;
+		const uint32_t maxLights_;
+
+		std::unique_ptr<Buffer> counts_;
+		std::unique_ptr<Buffer> indices_;
+
+		std::unique_ptr<DescriptorSetLayout> setLayout_;
+		std::unique_ptr<DescriptorPool> descriptorPool_;
+		VkDescriptorSet descriptorSet_{};
+		// Parameters and lights
+		std::array<uint32_t, 2> dynamicOffsets_{};
+
+		std::unique_ptr<PipelineLayout> pipelineLayout_;
+		std::unique_ptr<ComputePipeline> pipeline_;
+
+		std::vector<Light> queued_;
+		uint32_t lightCount_{};
+		bool reportedDrop_{};
+	};
+
+}
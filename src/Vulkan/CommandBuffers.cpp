@@ -13,12 +13,14 @@ CommandBuffers::CommandBuffers(CommandPool& commandPool, const uint32_t size) :
 
 	commandBuffers_.resize(size);
 
-	Check(vkAllocateCommandBuffers(commandPool.Device().Handle(), &allocInfo, commandBuffers_.data()), "allocate command buffers");
+	const auto& device = commandPool.Device();
+	Check(device.Dispatch().vkAllocateCommandBuffers(device.Handle(), &allocInfo, commandBuffers_.data()), "allocate command buffers");
 }
 
 CommandBuffers::~CommandBuffers() {
 	if (!commandBuffers_.empty()) {
-		vkFreeCommandBuffers(commandPool_.Device().Handle(), commandPool_.Handle(), static_cast<uint32_t>(commandBuffers_.size()), commandBuffers_.data());
+		const auto& device = commandPool_.Device();
+		device.Dispatch().vkFreeCommandBuffers(device.Handle(), commandPool_.Handle(), static_cast<uint32_t>(commandBuffers_.size()), commandBuffers_.data());
 		commandBuffers_.clear();
 	}
 }
@@ -29,13 +31,13 @@ VkCommandBuffer CommandBuffers::Begin(const size_t i) {
 	beginInfo.flags = 0; // Optionnel
 	beginInfo.pInheritanceInfo = nullptr; // Optional
 
-	Check(vkBeginCommandBuffer(commandBuffers_[i], &beginInfo), "begin recording command buffer");
+	Check(commandPool_.Device().Dispatch().vkBeginCommandBuffer(commandBuffers_[i], &beginInfo), "begin recording command buffer");
 
 	return commandBuffers_[i];
 }
 
 void CommandBuffers::End(const size_t i) {
-	Check(vkEndCommandBuffer(commandBuffers_[i]), "record command buffer");
+	Check(commandPool_.Device().Dispatch().vkEndCommandBuffer(commandBuffers_[i]), "record command buffer");
 }
 
 }
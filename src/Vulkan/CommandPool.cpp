@@ -9,12 +9,12 @@ CommandPool::CommandPool(const class Device& device, const uint32_t queueFamilyI
 	poolInfo.queueFamilyIndex = queueFamilyIndex;
 	poolInfo.flags = allowReset ? VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT : 0;
 
-	Check(vkCreateCommandPool(device.Handle(), &poolInfo, nullptr, &commandPool_), "create command pool");
+	Check(device.Dispatch().vkCreateCommandPool(device.Handle(), &poolInfo, device.Allocator(), &commandPool_), "create command pool");
 }
 
 CommandPool::~CommandPool() {
 	if (commandPool_ != nullptr) {
-		vkDestroyCommandPool(device_.Handle(), commandPool_, nullptr);
+		device_.Dispatch().vkDestroyCommandPool(device_.Handle(), commandPool_, device_.Allocator());
 		commandPool_ = nullptr;
 	}
 }
@@ -0,0 +1,33 @@
+#include "ComputePipeline.hpp"
+
+#include "Device.hpp"
+#include "PipelineCache.hpp"
+#include "PipelineLayout.hpp"
+#include "ShaderModule.hpp"
+
+namespace Vulkan {
+
+std::atomic<uint32_t> ComputePipeline::liveCount_{};
+
+ComputePipeline::ComputePipeline(const class Device& device, const PipelineCache& pipelineCache, const class PipelineLayout& pipelineLayout, const ShaderModule& shaderModule) :
+	device_(device),
+	pipelineLayout_(pipelineLayout)
+{
+	VkComputePipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage = shaderModule.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT);
+	pipelineInfo.layout = pipelineLayout.Handle();
+
+	Check(device.Dispatch().vkCreateComputePipelines(device.Handle(), pipelineCache.Handle(), 1, &pipelineInfo, device.Allocator(), &pipeline_), "create compute pipeline");
+	++liveCount_;
+}
+
+ComputePipeline::~ComputePipeline() {
+	if (pipeline_ != nullptr) {
+		device_.Dispatch().vkDestroyPipeline(device_.Handle(), pipeline_, device_.Allocator());
+		pipeline_ = nullptr;
+		--liveCount_;
+	}
+}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <atomic>
+
+namespace Vulkan {
+	class Device;
+	class PipelineCache;
+	class PipelineLayout;
+	class ShaderModule;
+
+	class ComputePipeline final {
+	public:
+
+		VULKAN_NON_COPIABLE(ComputePipeline)
+
+		ComputePipeline(const Device& device, const PipelineCache& pipelineCache, const PipelineLayout& pipelineLayout, const ShaderModule& shaderModule);
+		~ComputePipeline();
+
+		const class PipelineLayout& PipelineLayout() const { return pipelineLayout_; }
+
+		static uint32_t LiveCount() { return liveCount_; }
+
+	private:
+
+		static std::atomic<uint32_t> liveCount_;
+
+		const class Device& device_;
+		const class PipelineLayout& pipelineLayout_;
+
+		VULKAN_HANDLE(VkPipeline, pipeline_)
+	};
+
+}
@@ -0,0 +1,222 @@
+#include "DebugMessageSink.hpp"
+
+#include "Strings.hpp"
+#include "../Utilities/Log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <vector>
+
+namespace Vulkan {
+
+	namespace {
+		constexpr uint64_t NoKey = 0;
+
+		// FNV-1a of a C string, hashed in place on the driver thread
+		uint32_t HashName(const char* name) {
+			uint32_t hash = 2166136261u;
+
+			for (; *name != '\0'; ++name) {
+				hash ^= static_cast<unsigned char>(*name);
+				hash *= 16777619u;
+			}
+
+			return hash;
+		}
+
+		// Message ID number when the layer sets one, otherwise the ID name hash
+		uint64_t MessageKey(const VkDebugUtilsMessengerCallbackDataEXT& callbackData) {
+			if (callbackData.messageIdNumber != 0)
+				return (1ull << 32) | static_cast<uint32_t>(callbackData.messageIdNumber);
+
+			if (callbackData.pMessageIdName != nullptr)
+				return (2ull << 32) | HashName(callbackData.pMessageIdName);
+
+			return NoKey;
+		}
+
+		const char* TypeName(const VkDebugUtilsMessageTypeFlagsEXT type) {
+			switch (type) {
+			case VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT:
+				return "GENERAL: ";
+			case VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT:
+				return "VALIDATION: ";
+			case VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT:
+				return "PERFORMANCE: ";
+			default:
+				return "UNKNOWN: ";
+			}
+		}
+	}
+
+DebugMessageSink::DebugMessageSink() :
+	queue_(QueueCapacity),
+	thread_([this]() { Run(); })
+{
+}
+
+DebugMessageSink::~DebugMessageSink() {
+	running_ = false;
+	wakeUp_.notify_one();
+	thread_.join();
+
+	Drain();
+	WriteSummary();
+}
+
+void DebugMessageSink::Submit(
+	const VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+	const VkDebugUtilsMessageTypeFlagsEXT type,
+	const VkDebugUtilsMessengerCallbackDataEXT& callbackData)
+{
+	received_.fetch_add(1, std::memory_order_relaxed);
+
+	const uint64_t key = MessageKey(callbackData);
+	IdSlot* const slot = key != NoKey ? FindSlot(key) : nullptr;
+
+	// Repeated IDs only cost a few atomics once their allowance is spent
+	if (slot != nullptr) {
+		slot->Count.fetch_add(1, std::memory_order_relaxed);
+
+		if (slot->Allowance.fetch_sub(1, std::memory_order_relaxed) <= 0) {
+			slot->Suppressed.fetch_add(1, std::memory_order_relaxed);
+			suppressed_.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+
+	Message message;
+	message.Severity = severity;
+	message.Type = type;
+	message.Key = key;
+	message.IdName = callbackData.pMessageIdName != nullptr ? callbackData.pMessageIdName : "";
+	message.Text = callbackData.pMessage != nullptr ? callbackData.pMessage : "";
+
+	if (severity > VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT) {
+		message.Objects.reserve(callbackData.objectCount);
+
+		for (uint32_t i = 0; i != callbackData.objectCount; ++i) {
+			const auto& object = callbackData.pObjects[i];
+			message.Objects.push_back({ object.objectType, object.objectHandle, object.pObjectName != nullptr ? object.pObjectName : "" });
+		}
+	}
+
+	if (!queue_.TryPush(std::move(message))) {
+		dropped_.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	wakeUp_.notify_one();
+}
+
+DebugMessageSink::IdSlot* DebugMessageSink::FindSlot(const uint64_t key) {
+	const size_t start = std::hash<uint64_t>()(key) % IdTableSize;
+
+	for (size_t i = 0; i != IdTableSize; ++i) {
+		auto& slot = slots_[(start + i) % IdTableSize];
+		uint64_t slotKey = slot.Key.load(std::memory_order_acquire);
+
+		if (slotKey == NoKey && slot.Key.compare_exchange_strong(slotKey, key, std::memory_order_acq_rel))
+			return &slot;
+
+		if (slotKey == key)
+			return &slot;
+	}
+
+	// Table full, such messages are neither grouped nor limited
+	return nullptr;
+}
+
+void DebugMessageSink::Run() {
+	auto lastRefill = std::chrono::steady_clock::now();
+
+	while (running_) {
+		{
+			// Producers notify without the lock, the timeout bounds any missed wake up
+			std::unique_lock<std::mutex> lock(mutex_);
+			wakeUp_.wait_for(lock, std::chrono::milliseconds(10));
+		}
+
+		Drain();
+
+		const auto now = std::chrono::steady_clock::now();
+		if (now - lastRefill >= std::chrono::seconds(1)) {
+			RefillAllowances();
+			lastRefill = now;
+		}
+	}
+}
+
+void DebugMessageSink::Drain() {
+	Message message;
+
+	while (queue_.TryPop(message)) {
+		Write(message);
+	}
+}
+
+void DebugMessageSink::Write(Message& message) {
+	if (message.Key != NoKey && !message.IdName.empty())
+		idNames_.emplace(message.Key, message.IdName);
+
+	if (!message.Objects.empty()) {
+		std::ostringstream objects;
+		objects << "\n\n  Objects (" << message.Objects.size() << "):\n";
+
+		for (size_t i = 0; i != message.Objects.size(); ++i) {
+			const auto& object = message.Objects[i];
+			objects
+				<< "  - Object[" << i << "]: "
+				<< "Type: " << toString(object.Type) << ", "
+				<< "Handle: " << reinterpret_cast<void*>(object.Handle) << ", "
+				<< "Name: '" << object.Name << "'"
+				<< "\n";
+		}
+
+		message.Text += objects.str();
+	}
+
+	// Debug utils severities share the log ones values
+	Utilities::Log::Write(static_cast<Utilities::Severity>(message.Severity), "{}{}", TypeName(message.Type), std::move(message.Text));
+}
+
+void DebugMessageSink::RefillAllowances() {
+	for (auto& slot : slots_) {
+		const uint64_t key = slot.Key.load(std::memory_order_acquire);
+		if (key == NoKey)
+			continue;
+
+		const uint32_t suppressed = slot.Suppressed.exchange(0, std::memory_order_relaxed);
+		slot.Allowance.store(MessagesPerIdPerSecond, std::memory_order_relaxed);
+
+		if (suppressed != 0) {
+			const auto name = idNames_.find(key);
+			LOG_WARNING("... {} more '{}' messages suppressed", suppressed, name != idNames_.end() ? name->second : std::to_string(static_cast<uint32_t>(key)));
+		}
+	}
+}
+
+void DebugMessageSink::WriteSummary() {
+	if (Received() == 0)
+		return;
+
+	std::vector<std::pair<uint32_t, uint64_t>> counts;
+
+	for (const auto& slot : slots_) {
+		const uint64_t key = slot.Key.load(std::memory_order_acquire);
+		if (key != NoKey)
+			counts.emplace_back(slot.Count.load(std::memory_order_relaxed), key);
+	}
+
+	std::sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+	LOG_INFO("Debug messages: {} received, {} suppressed, {} dropped", Received(), Suppressed(), Dropped());
+
+	for (size_t i = 0; i != std::min<size_t>(counts.size(), 10); ++i) {
+		const auto name = idNames_.find(counts[i].second);
+		LOG_INFO("  {}x {}", counts[i].first, name != idNames_.end() ? name->second : std::to_string(static_cast<uint32_t>(counts[i].second)));
+	}
+}
+
+}
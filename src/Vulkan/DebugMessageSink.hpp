@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include "../Utilities/MpscRingBuffer.hpp"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Vulkan {
+
+	// Receives debug utils messages on whatever thread the driver calls back from, and hands them over
+	// to a logger thread through a lock-free ring. Messages are grouped by ID, and each ID may only print
+	// a few messages per second; the rest are counted and reported as a summary line.
+	class DebugMessageSink final {
+	public:
+
+		VULKAN_NON_COPIABLE(DebugMessageSink)
+
+		static constexpr size_t QueueCapacity = 1024;
+		static constexpr size_t IdTableSize = 512;
+		static constexpr int32_t MessagesPerIdPerSecond = 3;
+
+		DebugMessageSink();
+		~DebugMessageSink();
+
+		// Driver thread, never blocks
+		void Submit(
+			VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+			VkDebugUtilsMessageTypeFlagsEXT type,
+			const VkDebugUtilsMessengerCallbackDataEXT& callbackData);
+
+		uint64_t Received() const { return received_.load(std::memory_order_relaxed); }
+		uint64_t Suppressed() const { return suppressed_.load(std::memory_order_relaxed); }
+		uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+	private:
+
+		// Objects are copied raw and formatted on the logger thread
+		struct Object {
+			VkObjectType Type{};
+			uint64_t Handle{};
+			std::string Name;
+		};
+
+		struct Message {
+			VkDebugUtilsMessageSeverityFlagBitsEXT Severity{};
+			VkDebugUtilsMessageTypeFlagsEXT Type{};
+			uint64_t Key{};
+			std::string IdName;
+			std::string Text;
+			std::vector<Object> Objects;
+		};
+
+		// Open addressing table slot, claimed once for a message ID and never released
+		struct IdSlot {
+			std::atomic<uint64_t> Key{};
+			std::atomic<uint32_t> Count{};
+			std::atomic<uint32_t> Suppressed{};
+			std::atomic<int32_t> Allowance{MessagesPerIdPerSecond};
+		};
+
+		IdSlot* FindSlot(uint64_t key);
+		void Run();
+		void Drain();
+		void Write(Message& message);
+		void RefillAllowances();
+		void WriteSummary();
+
+		Utilities::MpscRingBuffer<Message> queue_;
+		std::array<IdSlot, IdTableSize> slots_;
+
+		std::atomic<uint64_t> received_{};
+		std::atomic<uint64_t> suppressed_{};
+		std::atomic<uint64_t> dropped_{};
+
+		// Logger thread only
+		std::unordered_map<uint64_t, std::string> idNames_;
+
+		std::mutex mutex_;
+		std::condition_variable wakeUp_;
+		std::atomic<bool> running_{true};
+		std::thread thread_;
+	};
+
+}
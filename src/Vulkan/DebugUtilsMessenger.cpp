@@ -1,10 +1,9 @@
 #include "DebugUtilsMessenger.hpp"
 
+#include "DebugMessageSink.hpp"
 #include "Instance.hpp"
-#include "Strings.hpp"
-#include "../Utilities/Console.hpp"
 
-#include <iostream>
+#include <stdexcept>
 
 namespace Vulkan {
 
@@ -16,60 +15,8 @@ namespace Vulkan {
 			const VkDebugUtilsMessengerCallbackDataEXT* const pCallbackData,
 			void* const pUserData)
 		{
-			(void)pUserData;
-
-			const auto attributes = Utilities::Console::SetColorBySeverity(static_cast<Utilities::Severity>(messageSeverity));
-
-			switch (messageSeverity) {
-			case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
-				std::cerr << "VERBOSE: ";
-				break;
-			case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
-				std::cerr << "INFO: ";
-				break;
-			case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
-				std::cerr << "WARNING: ";
-				break;
-			case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
-				std::cerr << "ERROR: ";
-				break;
-			default:;
-				std::cerr << "UNKNOWN: ";
-			}
-
-			switch (messageType) {
-			case VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT:
-				std::cerr << "GENERAL: ";
-				break;
-			case VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT:
-				std::cerr << "VALIDATION: ";
-				break;
-			case VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT:
-				std::cerr << "PERFORMANCE: ";
-				break;
-			default:
-				std::cerr << "UNKNOWN: ";
-			}
-
-			std::cerr << pCallbackData->pMessage;
-
-			if (pCallbackData->objectCount > 0 && messageSeverity > VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT) {
-				std::cerr << "\n\n  Objects (" << pCallbackData->objectCount << "):\n";
-
-				for (uint32_t i = 0; i != pCallbackData->objectCount; ++i) {
-					const auto object = pCallbackData->pObjects[i];
-					std::cerr
-						<< "  - Object[" << i << "]: "
-						<< "Type: " << toString(object.objectType) << ", "
-						<< "Handle: " << reinterpret_cast<void*>(object.objectHandle) << ", "
-						<< "Name: '" << (object.pObjectName ? object.pObjectName : "") << "'"
-						<< "\n";
-				}
-			}
-
-			std::cerr << std::endl;
-
-			Utilities::Console::SetColorByAttributes(attributes);
+			// Formatting and output happen on the sink logger thread, not on the driver one
+			static_cast<DebugMessageSink*>(pUserData)->Submit(messageSeverity, messageType, *pCallbackData);
 
 			return VK_FALSE;
 		}
@@ -112,18 +59,23 @@ namespace Vulkan {
 			throw std::invalid_argument("invalid threshold");
 		}
 
+		sink_.reset(new DebugMessageSink());
+
 		VkDebugUtilsMessengerCreateInfoEXT createInfo;
 		populateCreateInfo(createInfo, severity);
 
-		Check(CreateDebugUtilsMessengerEXT(instance_.Handle(), &createInfo, nullptr, &messenger_),
+		Check(CreateDebugUtilsMessengerEXT(instance_.Handle(), &createInfo, instance_.Allocator(), &messenger_),
 			"set up Vulkan debug callback");
 	}
 
 	DebugUtilsMessenger::~DebugUtilsMessenger() {
 		if (messenger_ != nullptr) {
-			DestroyDebugUtilsMessengerEXT(instance_.Handle(), messenger_, nullptr);
+			DestroyDebugUtilsMessengerEXT(instance_.Handle(), messenger_, instance_.Allocator());
 			messenger_ = nullptr;
 		}
+
+		// Only once the driver can no longer call back
+		sink_.reset();
 	}
 
 	void DebugUtilsMessenger::populateCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo, const VkDebugUtilsMessageSeverityFlagsEXT severity) {
@@ -132,7 +84,7 @@ namespace Vulkan {
 		createInfo.messageSeverity = severity;
 		createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
 		createInfo.pfnUserCallback = VulkanDebugCallback;
-		createInfo.pUserData = nullptr;
+		createInfo.pUserData = sink_.get();
 	}
 
 }
\ No newline at end of file
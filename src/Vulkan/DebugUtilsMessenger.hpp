@@ -2,8 +2,11 @@
 
 #include "Vulkan.hpp"
 
+#include <memory>
+
 namespace Vulkan
 {
+	class DebugMessageSink;
 	class Instance; // forward declaration
 
 	class DebugUtilsMessenger final {
@@ -22,6 +25,7 @@ namespace Vulkan
 
 		const Instance& instance_;
 		const VkDebugUtilsMessageSeverityFlagBitsEXT threshold_;
+		std::unique_ptr<DebugMessageSink> sink_;
 
 		VULKAN_HANDLE(VkDebugUtilsMessengerEXT, messenger_)
 	};
@@ -0,0 +1,27 @@
+#include "DepthBuffer.hpp"
+
+#include "Device.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+
+namespace Vulkan {
+
+DepthBuffer::DepthBuffer(const Device& device, const VkExtent2D extent) :
+	extent_(extent)
+{
+	image_.reset(new class Image(
+		device, extent, 1, Format, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		{ device.GraphicsFamilyIndex() }, "depth buffer"));
+	imageView_.reset(new class ImageView(device, image_->Handle(), Format, VK_IMAGE_ASPECT_DEPTH_BIT));
+}
+
+DepthBuffer::~DepthBuffer() {
+	imageView_.reset();
+	image_.reset();
+}
+
+VkImage DepthBuffer::Image() const {
+	return image_->Handle();
+}
+
+}
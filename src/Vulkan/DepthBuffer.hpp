@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <memory>
+
+namespace Vulkan {
+	class Device;
+	class Image;
+	class ImageView;
+
+	// Scene depth attachment, also sampled to build the occlusion culling depth pyramid.
+	// Depth goes from 0 (near) to 1 (far).
+	class DepthBuffer final {
+	public:
+
+		static constexpr VkFormat Format = VK_FORMAT_D32_SFLOAT;
+
+		VULKAN_NON_COPIABLE(DepthBuffer)
+
+		DepthBuffer(const Device& device, VkExtent2D extent);
+		~DepthBuffer();
+
+		VkExtent2D Extent() const { return extent_; }
+		VkImage Image() const;
+		const class ImageView& ImageView() const { return *imageView_; }
+
+	private:
+
+		const VkExtent2D extent_;
+		std::unique_ptr<class Image> image_;
+		std::unique_ptr<class ImageView> imageView_;
+	};
+
+}
@@ -0,0 +1,51 @@
+#include "DescriptorPool.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+
+namespace Vulkan {
+
+std::atomic<uint32_t> DescriptorPool::liveCount_{};
+std::atomic<uint32_t> DescriptorPool::liveSetCount_{};
+
+DescriptorPool::DescriptorPool(const class Device& device, const std::vector<VkDescriptorPoolSize>& poolSizes, const uint32_t maxSets, const VkDescriptorPoolCreateFlags flags) :
+	device_(device),
+	maxSets_(maxSets)
+{
+	VkDescriptorPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.flags = flags;
+	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+	poolInfo.pPoolSizes = poolSizes.data();
+	poolInfo.maxSets = maxSets;
+
+	Check(device.Dispatch().vkCreateDescriptorPool(device.Handle(), &poolInfo, device.Allocator(), &descriptorPool_), "create descriptor pool");
+	++liveCount_;
+}
+
+DescriptorPool::~DescriptorPool() {
+	if (descriptorPool_ != nullptr) {
+		device_.Dispatch().vkDestroyDescriptorPool(device_.Handle(), descriptorPool_, device_.Allocator());
+		descriptorPool_ = nullptr;
+		--liveCount_;
+		liveSetCount_ -= allocatedSets_;
+	}
+}
+
+std::vector<VkDescriptorSet> DescriptorPool::Allocate(const DescriptorSetLayout& layout, const uint32_t count) {
+	const std::vector<VkDescriptorSetLayout> layouts(count, layout.Handle());
+
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = descriptorPool_;
+	allocInfo.descriptorSetCount = count;
+	allocInfo.pSetLayouts = layouts.data();
+
+	std::vector<VkDescriptorSet> descriptorSets(count);
+	Check(device_.Dispatch().vkAllocateDescriptorSets(device_.Handle(), &allocInfo, descriptorSets.data()), "allocate descriptor sets");
+	allocatedSets_ += count;
+	liveSetCount_ += count;
+
+	return descriptorSets;
+}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace Vulkan {
+	class DescriptorSetLayout;
+	class Device;
+
+	class DescriptorPool final {
+	public:
+
+		VULKAN_NON_COPIABLE(DescriptorPool)
+
+		DescriptorPool(const Device& device, const std::vector<VkDescriptorPoolSize>& poolSizes, uint32_t maxSets, VkDescriptorPoolCreateFlags flags);
+		~DescriptorPool();
+
+		const class Device& Device() const { return device_; }
+		uint32_t MaxSets() const { return maxSets_; }
+
+		// Sets are released with the pool
+		std::vector<VkDescriptorSet> Allocate(const DescriptorSetLayout& layout, uint32_t count);
+
+		// Descriptor pools currently alive, and the sets allocated from them
+		static uint32_t LiveCount() { return liveCount_; }
+		static uint32_t LiveSetCount() { return liveSetCount_; }
+
+	private:
+
+		static std::atomic<uint32_t> liveCount_;
+		static std::atomic<uint32_t> liveSetCount_;
+
+		const class Device& device_;
+		const uint32_t maxSets_;
+		uint32_t allocatedSets_{};
+
+		VULKAN_HANDLE(VkDescriptorPool, descriptorPool_)
+	};
+
+}
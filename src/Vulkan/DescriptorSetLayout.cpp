@@ -0,0 +1,22 @@
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+
+namespace Vulkan {
+
+DescriptorSetLayout::DescriptorSetLayout(const class Device& device, const std::vector<VkDescriptorSetLayoutBinding>& bindings) : device_(device) {
+	VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+
+	Check(device.Dispatch().vkCreateDescriptorSetLayout(device.Handle(), &layoutInfo, device.Allocator(), &layout_), "create descriptor set layout");
+}
+
+DescriptorSetLayout::~DescriptorSetLayout() {
+	if (layout_ != nullptr) {
+		device_.Dispatch().vkDestroyDescriptorSetLayout(device_.Handle(), layout_, device_.Allocator());
+		layout_ = nullptr;
+	}
+}
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <vector>
+
+namespace Vulkan {
+	class Device;
+
+	class DescriptorSetLayout final {
+	public:
+
+		VULKAN_NON_COPIABLE(DescriptorSetLayout)
+
+		DescriptorSetLayout(const Device& device, const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+		~DescriptorSetLayout();
+
+		const class Device& Device() const { return device_; }
+
+	private:
+
+		const class Device& device_;
+
+		VULKAN_HANDLE(VkDescriptorSetLayout, layout_)
+	};
+
+}
@@ -1,7 +1,8 @@
 #include "Device.hpp"
 
-#include "Enumerate.hpp"
 #include "Instance.hpp"
+#include "MemoryStatistics.hpp"
+#include "PhysicalDeviceInfo.hpp"
 #include "Surface.hpp"
 
 #include <algorithm>
@@ -14,47 +15,73 @@ namespace Vulkan {
 	namespace {
 		std::vector<VkQueueFamilyProperties>::const_iterator FindQueue(
 			const std::vector<VkQueueFamilyProperties>& queueFamilies,
-			const std::string& name,
 			const VkQueueFlags requiredBits,
 			const VkQueueFlags excludedBits)
 		{
-			const auto family = std::find_if(queueFamilies.begin(), queueFamilies.end(), [requiredBits, excludedBits](const VkQueueFamilyProperties& queueFamily)
+			return std::find_if(queueFamilies.begin(), queueFamilies.end(), [requiredBits, excludedBits](const VkQueueFamilyProperties& queueFamily)
 			{
 				return queueFamily.queueCount > 0 && queueFamily.queueFlags & requiredBits && !(queueFamily.queueFlags & excludedBits);
 			});
+		}
 
-			if (family == queueFamilies.end())
-				throw std::runtime_error("found no matching " + name + " queue");
-
-			return family;
+		// Append a structure at the end of a pNext chain
+		template <class TStructure>
+		void Chain(VkBaseOutStructure*& tail, TStructure& structure) {
+			structure.pNext = nullptr;
+			tail->pNext = reinterpret_cast<VkBaseOutStructure*>(&structure);
+			tail = tail->pNext;
 		}
 	}
 
 const std::vector<const char*> Device::RequiredExtensions =
 {
-	VK_KHR_SWAPCHAIN_EXTENSION_NAME
+	VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+	VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME
+};
+
+const std::vector<const char*> Device::DynamicRenderingExtensions =
+{
+	VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+	VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+	VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME
+};
+
+const std::vector<const char*> Device::PresentWaitExtensions =
+{
+	VK_KHR_PRESENT_ID_EXTENSION_NAME,
+	VK_KHR_PRESENT_WAIT_EXTENSION_NAME
 };
 
-Device::Device(VkPhysicalDevice physicalDevice, const class Surface& surface) :
-	physicalDevice_(physicalDevice),
-	surface_(surface)
+Device::Device(const PhysicalDeviceInfo& physicalDevice, const class Surface& surface) :
+	physicalDevice_(physicalDevice.Handle()),
+	surface_(surface),
+	allocator_(surface.Instance().Allocator())
 {
 	CheckRequiredExtensions(physicalDevice);
 
-	const auto queueFamilies = GetEnumerateVector(physicalDevice, vkGetPhysicalDeviceQueueFamilyProperties);
+	// Extensions, queue families and their presentation support come from the snapshot the device was selected with
+	const auto& queueFamilies = physicalDevice.QueueFamilies();
 
 	// Find the graphics queue.
-	const auto graphicsFamily = FindQueue(queueFamilies, "graphics", VK_QUEUE_GRAPHICS_BIT, 0);
-	const auto computeFamily = FindQueue(queueFamilies, "compute", VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT);
-	const auto transferFamily = FindQueue(queueFamilies, "transfer", VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+	const auto graphicsFamily = FindQueue(queueFamilies, VK_QUEUE_GRAPHICS_BIT, 0);
+
+	if (graphicsFamily == queueFamilies.end())
+		throw std::runtime_error("found no matching graphics queue");
+
+	// Prefer dedicated compute and transfer families, otherwise share a more general one
+	auto computeFamily = FindQueue(queueFamilies, VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT);
+	if (computeFamily == queueFamilies.end())
+		computeFamily = graphicsFamily;
+
+	auto transferFamily = FindQueue(queueFamilies, VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+	if (transferFamily == queueFamilies.end())
+		transferFamily = computeFamily;
 
 	// Find the presentation queue (usually the same as graphics queue).
 	const auto presentFamily = std::find_if(queueFamilies.begin(), queueFamilies.end(), [&](const VkQueueFamilyProperties& queueFamily)
 	{
-		VkBool32 presentSupport = false;
-		const uint32_t i = static_cast<uint32_t>(&*queueFamilies.cbegin() - &queueFamily);
-		vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface.Handle(), &presentSupport);
-		return queueFamily.queueCount > 0 && presentSupport;
+		const uint32_t i = static_cast<uint32_t>(&queueFamily - &*queueFamilies.cbegin());
+		return queueFamily.queueCount > 0 && physicalDevice.CanPresent(i);
 	});
 
 	if (presentFamily == queueFamilies.end())
@@ -96,6 +123,68 @@ Device::Device(VkPhysicalDevice physicalDevice, const class Surface& surface) :
 	indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
 	indexingFeatures.runtimeDescriptorArray = true;
 
+	std::vector<const char*> extensions(RequiredExtensions);
+
+	// Query the features we rely on, only chaining the structures whose extensions are available
+	const bool hasDynamicRenderingExtensions = physicalDevice.HasExtensions(DynamicRenderingExtensions);
+	const bool hasPresentWaitExtensions = physicalDevice.HasExtensions(PresentWaitExtensions);
+
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {};
+	timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+
+	VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
+	dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+	VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+	presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+
+	VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+	presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+	VkPhysicalDeviceFeatures2 supportedFeatures = {};
+	supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+
+	auto* tail = reinterpret_cast<VkBaseOutStructure*>(&supportedFeatures);
+	Chain(tail, timelineSemaphoreFeatures);
+
+	if (hasDynamicRenderingExtensions)
+		Chain(tail, dynamicRenderingFeatures);
+
+	if (hasPresentWaitExtensions) {
+		Chain(tail, presentIdFeatures);
+		Chain(tail, presentWaitFeatures);
+	}
+
+	vkGetPhysicalDeviceFeatures2(physicalDevice_, &supportedFeatures);
+
+	if (!timelineSemaphoreFeatures.timelineSemaphore)
+		throw std::runtime_error("missing required feature: timelineSemaphore");
+
+	// Prefer dynamic rendering (no render pass nor framebuffer objects) when the device supports it
+	dynamicRendering_ = hasDynamicRenderingExtensions && dynamicRenderingFeatures.dynamicRendering;
+	presentWait_ = hasPresentWaitExtensions && presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+
+	// Build the chain of enabled features, each structure only holds the feature we enable
+	tail = reinterpret_cast<VkBaseOutStructure*>(&indexingFeatures);
+	Chain(tail, timelineSemaphoreFeatures);
+
+	if (dynamicRendering_) {
+		extensions.insert(extensions.end(), DynamicRenderingExtensions.begin(), DynamicRenderingExtensions.end());
+		Chain(tail, dynamicRenderingFeatures);
+	}
+
+	if (presentWait_) {
+		extensions.insert(extensions.end(), PresentWaitExtensions.begin(), PresentWaitExtensions.end());
+		Chain(tail, presentIdFeatures);
+		Chain(tail, presentWaitFeatures);
+	}
+
+	// Memory budget has no feature to enable, only the extension
+	memoryBudget_ = physicalDevice.HasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+	if (memoryBudget_)
+		extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
 	VkDeviceCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 	createInfo.pNext = &indexingFeatures;
@@ -104,34 +193,65 @@ Device::Device(VkPhysicalDevice physicalDevice, const class Surface& surface) :
 	createInfo.pEnabledFeatures = &deviceFeatures;
 	createInfo.enabledLayerCount = static_cast<uint32_t>(surface_.Instance().ValidationLayers().size());
 	createInfo.ppEnabledLayerNames = surface_.Instance().ValidationLayers().data();
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(RequiredExtensions.size());
-	createInfo.ppEnabledExtensionNames = RequiredExtensions.data();
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+	createInfo.ppEnabledExtensionNames = extensions.data();
+
+	Check(vkCreateDevice(physicalDevice_, &createInfo, allocator_, &device_), "create logical device");
 
-	Check(vkCreateDevice(physicalDevice, &createInfo, nullptr, &device_), "create logical device");
+	dispatch_.Load(surface_.Instance().Handle(), device_, dynamicRendering_, presentWait_);
 
-	vkGetDeviceQueue(device_, graphicsFamilyIndex_, 0, &graphicsQueue_);
-	vkGetDeviceQueue(device_, computeFamilyIndex_, 0, &computeQueue_);
-	vkGetDeviceQueue(device_, presentFamilyIndex_, 0, &presentQueue_);
-	vkGetDeviceQueue(device_, transferFamilyIndex_, 0, &transferQueue_);
+	dispatch_.vkGetDeviceQueue(device_, graphicsFamilyIndex_, 0, &graphicsQueue_);
+	dispatch_.vkGetDeviceQueue(device_, computeFamilyIndex_, 0, &computeQueue_);
+	dispatch_.vkGetDeviceQueue(device_, presentFamilyIndex_, 0, &presentQueue_);
+	dispatch_.vkGetDeviceQueue(device_, transferFamilyIndex_, 0, &transferQueue_);
+
+	memoryStatistics_.reset(new class MemoryStatistics(*this));
 }
 
 Device::~Device() {
+	memoryStatistics_.reset();
+
 	if (device_ != nullptr) {
-		vkDestroyDevice(device_, nullptr);
+		dispatch_.vkDestroyDevice(device_, allocator_);
 		device_ = nullptr;
 	}
 }
 
 void Device::WaitIdle() const {
-	Check(vkDeviceWaitIdle(device_), "wait for device idle");
+	Check(dispatch_.vkDeviceWaitIdle(device_), "wait for device idle");
+}
+
+VkResult Device::WaitSemaphores(const VkSemaphoreWaitInfoKHR& waitInfo, const uint64_t timeout) const {
+	return dispatch_.vkWaitSemaphoresKHR(device_, &waitInfo, timeout);
+}
+
+void Device::SignalSemaphore(const VkSemaphoreSignalInfoKHR& signalInfo) const {
+	Check(dispatch_.vkSignalSemaphoreKHR(device_, &signalInfo), "signal semaphore");
+}
+
+uint64_t Device::GetSemaphoreCounterValue(VkSemaphore semaphore) const {
+	uint64_t value;
+	Check(dispatch_.vkGetSemaphoreCounterValueKHR(device_, semaphore, &value), "get semaphore counter value");
+	return value;
+}
+
+VkResult Device::WaitForPresent(VkSwapchainKHR swapChain, const uint64_t presentId, const uint64_t timeout) const {
+	return dispatch_.vkWaitForPresentKHR(device_, swapChain, presentId, timeout);
+}
+
+void Device::CmdBeginRendering(VkCommandBuffer commandBuffer, const VkRenderingInfoKHR& renderingInfo) const {
+	dispatch_.vkCmdBeginRenderingKHR(commandBuffer, &renderingInfo);
+}
+
+void Device::CmdEndRendering(VkCommandBuffer commandBuffer) const {
+	dispatch_.vkCmdEndRenderingKHR(commandBuffer);
 }
 
-void Device::CheckRequiredExtensions(VkPhysicalDevice physicalDevice) const
+void Device::CheckRequiredExtensions(const PhysicalDeviceInfo& physicalDevice) const
 {
-	const auto availableExtensions = GetEnumerateVector(physicalDevice, static_cast<const char*>(nullptr), vkEnumerateDeviceExtensionProperties);
 	std::set<std::string> requiredExtensions(RequiredExtensions.begin(), RequiredExtensions.end());
 
-	for (const auto& extension : availableExtensions) 
+	for (const auto& extension : physicalDevice.Extensions()) 
 		requiredExtensions.erase(extension.extensionName);
 
 	if (!requiredExtensions.empty()) {
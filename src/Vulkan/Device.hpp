@@ -1,9 +1,13 @@
 #pragma once
 
 #include "Vulkan.hpp"
+#include "DeviceDispatch.hpp"
+#include <memory>
 #include <vector>
 
 namespace Vulkan {
+	class MemoryStatistics;
+	class PhysicalDeviceInfo;
 	class Surface;
 
 	class Device final {
@@ -11,11 +15,18 @@ namespace Vulkan {
 
 		VULKAN_NON_COPIABLE(Device)
 
-		Device(VkPhysicalDevice physicalDevice, const Surface& surface);
+		// Extensions a device must expose to be usable at all
+		static const std::vector<const char*> RequiredExtensions;
+
+		Device(const PhysicalDeviceInfo& physicalDevice, const Surface& surface);
 		~Device();
 
 		VkPhysicalDevice PhysicalDevice() const { return physicalDevice_; }
+		// Host allocation callbacks of the instance, passed to every object creation
+		const VkAllocationCallbacks* Allocator() const { return allocator_; }
 		const class Surface& Surface() const { return surface_; }
+		// Device commands loaded from the driver, prefer them to the loader exported functions
+		const DeviceDispatch& Dispatch() const { return dispatch_; }
 
 		uint32_t GraphicsFamilyIndex() const { return graphicsFamilyIndex_; }
 		uint32_t ComputeFamilyIndex() const { return computeFamilyIndex_; }
@@ -26,16 +37,40 @@ namespace Vulkan {
 		VkQueue PresentQueue() const { return presentQueue_; }
 		VkQueue TransferQueue() const { return transferQueue_; }
 
+		// True when VK_KHR_dynamic_rendering is enabled, render pass and framebuffer objects are then not needed
+		bool IsDynamicRenderingEnabled() const { return dynamicRendering_; }
+		// True when VK_KHR_present_id and VK_KHR_present_wait are enabled
+		bool IsPresentWaitEnabled() const { return presentWait_; }
+		// True when VK_EXT_memory_budget is enabled
+		bool IsMemoryBudgetEnabled() const { return memoryBudget_; }
+
+		// Device memory accounting, updated by every allocation made through DeviceMemory
+		class MemoryStatistics& MemoryStatistics() const { return *memoryStatistics_; }
+
 		void WaitIdle() const;
 
+		// Timeline semaphore commands (VK_KHR_timeline_semaphore)
+		VkResult WaitSemaphores(const VkSemaphoreWaitInfoKHR& waitInfo, uint64_t timeout) const;
+		void SignalSemaphore(const VkSemaphoreSignalInfoKHR& signalInfo) const;
+		uint64_t GetSemaphoreCounterValue(VkSemaphore semaphore) const;
+
+		// Present wait commands (VK_KHR_present_wait)
+		VkResult WaitForPresent(VkSwapchainKHR swapChain, uint64_t presentId, uint64_t timeout) const;
+
+		// Dynamic rendering commands (VK_KHR_dynamic_rendering)
+		void CmdBeginRendering(VkCommandBuffer commandBuffer, const VkRenderingInfoKHR& renderingInfo) const;
+		void CmdEndRendering(VkCommandBuffer commandBuffer) const;
+
 	private:
 
-		void CheckRequiredExtensions(VkPhysicalDevice physicalDevice) const;
+		void CheckRequiredExtensions(const PhysicalDeviceInfo& physicalDevice) const;
 
-		static const std::vector<const char*> RequiredExtensions;
+		static const std::vector<const char*> DynamicRenderingExtensions;
+		static const std::vector<const char*> PresentWaitExtensions;
 
 		const VkPhysicalDevice physicalDevice_;
 		const class Surface& surface_;
+		const VkAllocationCallbacks* const allocator_;
 
 		VULKAN_HANDLE(VkDevice, device_)
 
@@ -48,6 +83,13 @@ namespace Vulkan {
 		VkQueue computeQueue_{};
 		VkQueue presentQueue_{};
 		VkQueue transferQueue_{};
+
+		DeviceDispatch dispatch_;
+
+		bool dynamicRendering_{};
+		bool presentWait_{};
+		bool memoryBudget_{};
+		std::unique_ptr<class MemoryStatistics> memoryStatistics_;
 	};
 
 }
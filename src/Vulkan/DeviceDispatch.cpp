@@ -0,0 +1,40 @@
+#include "DeviceDispatch.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace Vulkan {
+
+	namespace {
+		template <class TFunction>
+		void LoadCommand(const PFN_vkGetDeviceProcAddr getDeviceProcAddr, VkDevice device, const char* const name, TFunction& function) {
+			function = reinterpret_cast<TFunction>(getDeviceProcAddr(device, name));
+
+			if (function == nullptr)
+				throw std::runtime_error(std::string("failed to load device command '") + name + "'");
+		}
+	}
+
+void DeviceDispatch::Load(VkInstance instance, VkDevice device, const bool dynamicRendering, const bool presentWait) {
+	// Asking the instance for vkGetDeviceProcAddr returns the driver (or first layer) entry point,
+	// the commands it resolves are then called without going through the loader.
+	const auto getDeviceProcAddr = reinterpret_cast<PFN_vkGetDeviceProcAddr>(vkGetInstanceProcAddr(instance, "vkGetDeviceProcAddr"));
+
+	if (getDeviceProcAddr == nullptr)
+		throw std::runtime_error("failed to load vkGetDeviceProcAddr");
+
+#define VULKAN_LOAD_COMMAND(command) LoadCommand(getDeviceProcAddr, device, #command, command);
+	VULKAN_DEVICE_CORE_COMMANDS(VULKAN_LOAD_COMMAND)
+	VULKAN_DEVICE_REQUIRED_EXTENSION_COMMANDS(VULKAN_LOAD_COMMAND)
+
+	if (dynamicRendering) {
+		VULKAN_DEVICE_DYNAMIC_RENDERING_COMMANDS(VULKAN_LOAD_COMMAND)
+	}
+
+	if (presentWait) {
+		VULKAN_DEVICE_PRESENT_WAIT_COMMANDS(VULKAN_LOAD_COMMAND)
+	}
+#undef VULKAN_LOAD_COMMAND
+}
+
+}
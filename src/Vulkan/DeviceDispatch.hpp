@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+// Device level commands used by the wrappers. Each list expands X(command) once per command,
+// the dispatch table members and their loading are generated from them.
+
+#define VULKAN_DEVICE_CORE_COMMANDS(X) \
+	X(vkDestroyDevice) \
+	X(vkGetDeviceQueue) \
+	X(vkDeviceWaitIdle) \
+	X(vkQueueSubmit) \
+	X(vkAllocateMemory) \
+	X(vkFreeMemory) \
+	X(vkMapMemory) \
+	X(vkUnmapMemory) \
+	X(vkInvalidateMappedMemoryRanges) \
+	X(vkCreateBuffer) \
+	X(vkDestroyBuffer) \
+	X(vkGetBufferMemoryRequirements) \
+	X(vkBindBufferMemory) \
+	X(vkCreateImage) \
+	X(vkDestroyImage) \
+	X(vkGetImageMemoryRequirements) \
+	X(vkBindImageMemory) \
+	X(vkCreateFence) \
+	X(vkDestroyFence) \
+	X(vkResetFences) \
+	X(vkGetFenceStatus) \
+	X(vkWaitForFences) \
+	X(vkCreateSemaphore) \
+	X(vkDestroySemaphore) \
+	X(vkCreateQueryPool) \
+	X(vkDestroyQueryPool) \
+	X(vkGetQueryPoolResults) \
+	X(vkCreateImageView) \
+	X(vkDestroyImageView) \
+	X(vkCreateSampler) \
+	X(vkDestroySampler) \
+	X(vkCreateShaderModule) \
+	X(vkDestroyShaderModule) \
+	X(vkCreatePipelineLayout) \
+	X(vkDestroyPipelineLayout) \
+	X(vkCreatePipelineCache) \
+	X(vkDestroyPipelineCache) \
+	X(vkGetPipelineCacheData) \
+	X(vkCreateGraphicsPipelines) \
+	X(vkCreateComputePipelines) \
+	X(vkDestroyPipeline) \
+	X(vkCreateRenderPass) \
+	X(vkDestroyRenderPass) \
+	X(vkCreateFramebuffer) \
+	X(vkDestroyFramebuffer) \
+	X(vkCreateDescriptorSetLayout) \
+	X(vkDestroyDescriptorSetLayout) \
+	X(vkCreateDescriptorPool) \
+	X(vkDestroyDescriptorPool) \
+	X(vkAllocateDescriptorSets) \
+	X(vkUpdateDescriptorSets) \
+	X(vkCreateCommandPool) \
+	X(vkDestroyCommandPool) \
+	X(vkAllocateCommandBuffers) \
+	X(vkFreeCommandBuffers) \
+	X(vkBeginCommandBuffer) \
+	X(vkEndCommandBuffer) \
+	X(vkCmdBindPipeline) \
+	X(vkCmdBindDescriptorSets) \
+	X(vkCmdPushConstants) \
+	X(vkCmdDispatch) \
+	X(vkCmdDispatchIndirect) \
+	X(vkCmdSetViewport) \
+	X(vkCmdSetScissor) \
+	X(vkCmdDraw) \
+	X(vkCmdDrawIndexed) \
+	X(vkCmdDrawIndirect) \
+	X(vkCmdBindVertexBuffers) \
+	X(vkCmdBindIndexBuffer) \
+	X(vkCmdPipelineBarrier) \
+	X(vkCmdCopyImageToBuffer) \
+	X(vkCmdCopyBufferToImage) \
+	X(vkCmdCopyBuffer) \
+	X(vkCmdFillBuffer) \
+	X(vkCmdBlitImage) \
+	X(vkCmdBeginRenderPass) \
+	X(vkCmdEndRenderPass) \
+	X(vkCmdResetQueryPool) \
+	X(vkCmdWriteTimestamp)
+
+// VK_KHR_swapchain and VK_KHR_timeline_semaphore, both required
+#define VULKAN_DEVICE_REQUIRED_EXTENSION_COMMANDS(X) \
+	X(vkCreateSwapchainKHR) \
+	X(vkDestroySwapchainKHR) \
+	X(vkGetSwapchainImagesKHR) \
+	X(vkAcquireNextImageKHR) \
+	X(vkQueuePresentKHR) \
+	X(vkWaitSemaphoresKHR) \
+	X(vkSignalSemaphoreKHR) \
+	X(vkGetSemaphoreCounterValueKHR)
+
+// VK_KHR_dynamic_rendering
+#define VULKAN_DEVICE_DYNAMIC_RENDERING_COMMANDS(X) \
+	X(vkCmdBeginRenderingKHR) \
+	X(vkCmdEndRenderingKHR)
+
+// VK_KHR_present_wait
+#define VULKAN_DEVICE_PRESENT_WAIT_COMMANDS(X) \
+	X(vkWaitForPresentKHR)
+
+namespace Vulkan {
+
+	// Device commands resolved through vkGetDeviceProcAddr. Calling them skips the loader trampoline
+	// that looks up the dispatch table of the handle on every call.
+	// Commands of extensions that are not enabled stay null.
+	struct DeviceDispatch final {
+
+#define VULKAN_DISPATCH_MEMBER(command) PFN_##command command{};
+		VULKAN_DEVICE_CORE_COMMANDS(VULKAN_DISPATCH_MEMBER)
+		VULKAN_DEVICE_REQUIRED_EXTENSION_COMMANDS(VULKAN_DISPATCH_MEMBER)
+		VULKAN_DEVICE_DYNAMIC_RENDERING_COMMANDS(VULKAN_DISPATCH_MEMBER)
+		VULKAN_DEVICE_PRESENT_WAIT_COMMANDS(VULKAN_DISPATCH_MEMBER)
+#undef VULKAN_DISPATCH_MEMBER
+
+		// Throws when a command of the core or of an enabled extension cannot be found
+		void Load(VkInstance instance, VkDevice device, bool dynamicRendering, bool presentWait);
+	};
+
+}
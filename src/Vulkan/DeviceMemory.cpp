@@ -0,0 +1,88 @@
+#include "DeviceMemory.hpp"
+
+#include "Device.hpp"
+#include "MemoryStatistics.hpp"
+
+#include <initializer_list>
+#include <stdexcept>
+
+namespace Vulkan {
+
+DeviceMemory::DeviceMemory(const class Device& device, const VkMemoryRequirements& requirements, const VkMemoryPropertyFlags properties, const char* const tag, const VkMemoryPropertyFlags preferredProperties) :
+	device_(device),
+	tag_(tag),
+	size_(requirements.size),
+	memoryTypeIndex_(FindMemoryType(device, requirements.memoryTypeBits, properties, preferredProperties))
+{
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(device.PhysicalDevice(), &memoryProperties);
+	properties_ = memoryProperties.memoryTypes[memoryTypeIndex_].propertyFlags;
+
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = size_;
+	allocInfo.memoryTypeIndex = memoryTypeIndex_;
+
+	Check(device.Dispatch().vkAllocateMemory(device.Handle(), &allocInfo, device.Allocator(), &memory_), "allocate device memory");
+
+	device.MemoryStatistics().OnAllocate(memoryTypeIndex_, size_, tag_);
+}
+
+DeviceMemory::DeviceMemory(DeviceMemory&& other) noexcept :
+	device_(other.device_),
+	tag_(other.tag_),
+	size_(other.size_),
+	memoryTypeIndex_(other.memoryTypeIndex_),
+	properties_(other.properties_),
+	memory_(other.memory_)
+{
+	other.memory_ = nullptr;
+}
+
+DeviceMemory::~DeviceMemory() {
+	if (memory_ != nullptr) {
+		device_.Dispatch().vkFreeMemory(device_.Handle(), memory_, device_.Allocator());
+		device_.MemoryStatistics().OnFree(memoryTypeIndex_, size_, tag_);
+		memory_ = nullptr;
+	}
+}
+
+void* DeviceMemory::Map(const VkDeviceSize offset, const VkDeviceSize size) {
+	void* data;
+	Check(device_.Dispatch().vkMapMemory(device_.Handle(), memory_, offset, size, 0, &data), "map memory");
+
+	return data;
+}
+
+void DeviceMemory::Unmap() {
+	device_.Dispatch().vkUnmapMemory(device_.Handle(), memory_);
+}
+
+void DeviceMemory::Invalidate(const VkDeviceSize offset, const VkDeviceSize size) const {
+	if (properties_ & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+		return;
+
+	VkMappedMemoryRange range = {};
+	range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+	range.memory = memory_;
+	range.offset = offset;
+	range.size = size;
+
+	Check(device_.Dispatch().vkInvalidateMappedMemoryRanges(device_.Handle(), 1, &range), "invalidate mapped memory");
+}
+
+uint32_t DeviceMemory::FindMemoryType(const class Device& device, const uint32_t typeBits, const VkMemoryPropertyFlags properties, const VkMemoryPropertyFlags preferredProperties) {
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(device.PhysicalDevice(), &memoryProperties);
+
+	for (const auto wanted : { properties | preferredProperties, properties }) {
+		for (uint32_t i = 0; i != memoryProperties.memoryTypeCount; ++i) {
+			if ((typeBits & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & wanted) == wanted)
+				return i;
+		}
+	}
+
+	throw std::runtime_error("failed to find suitable memory type");
+}
+
+}
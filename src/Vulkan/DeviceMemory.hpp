@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+namespace Vulkan {
+	class Device;
+
+	// A device memory allocation, accounted in the device memory statistics under its owner tag.
+	class DeviceMemory final {
+	public:
+
+		DeviceMemory(const DeviceMemory&) = delete;
+		DeviceMemory& operator = (const DeviceMemory&) = delete;
+		DeviceMemory& operator = (DeviceMemory&&) = delete;
+
+		// The tag must outlive the allocation, a string literal naming the owner is expected.
+		// Preferred properties are only used when a memory type has them on top of the required ones.
+		DeviceMemory(const Device& device, const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, const char* tag, VkMemoryPropertyFlags preferredProperties = 0);
+		DeviceMemory(DeviceMemory&& other) noexcept;
+		~DeviceMemory();
+
+		const class Device& Device() const { return device_; }
+		VkDeviceSize Size() const { return size_; }
+		uint32_t MemoryTypeIndex() const { return memoryTypeIndex_; }
+		// Properties of the memory type actually used
+		VkMemoryPropertyFlags Properties() const { return properties_; }
+
+		void* Map(VkDeviceSize offset, VkDeviceSize size);
+		void Unmap();
+		// Make device writes visible to the host, only needed for non coherent memory
+		void Invalidate(VkDeviceSize offset, VkDeviceSize size) const;
+
+	private:
+
+		static uint32_t FindMemoryType(const class Device& device, uint32_t typeBits, VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferredProperties);
+
+		const class Device& device_;
+		const char* const tag_;
+		VkDeviceSize size_;
+		uint32_t memoryTypeIndex_;
+		VkMemoryPropertyFlags properties_{};
+
+		VULKAN_HANDLE(VkDeviceMemory, memory_)
+	};
+
+}
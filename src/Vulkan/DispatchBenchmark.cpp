@@ -0,0 +1,77 @@
+#include "DispatchBenchmark.hpp"
+
+#include "CommandBuffers.hpp"
+#include "CommandPool.hpp"
+#include "Device.hpp"
+#include "Fence.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace Vulkan {
+
+	namespace {
+		// Command buffers are restarted every batch so they do not keep growing
+		constexpr uint32_t RecordBatch = 4096;
+		constexpr int Rounds = 3;
+
+		// Best time per call over a few rounds, the first one also warms up the caches
+		template <class TFunction>
+		double NanosecondsPerCall(const uint32_t iterations, TFunction&& function) {
+			double best = std::numeric_limits<double>::max();
+
+			for (int round = 0; round != Rounds; ++round) {
+				const auto start = std::chrono::steady_clock::now();
+
+				for (uint32_t i = 0; i != iterations; ++i)
+					function(i);
+
+				const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+				best = std::min(best, elapsed.count() / iterations);
+			}
+
+			return best;
+		}
+	}
+
+std::vector<DispatchBenchmarkResult> RunDispatchBenchmark(const Device& device, const uint32_t iterations) {
+	const auto& dispatch = device.Dispatch();
+
+	CommandPool commandPool(device, device.GraphicsFamilyIndex(), true);
+	CommandBuffers commandBuffers(commandPool, 1);
+	const Fence fence(device, true);
+
+	const VkViewport viewport = { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+
+	const auto setViewport = [&](const PFN_vkCmdSetViewport cmdSetViewport) {
+		VkCommandBuffer commandBuffer = commandBuffers.Begin(0);
+
+		const double nanoseconds = NanosecondsPerCall(iterations, [&](const uint32_t i) {
+			if (i % RecordBatch == RecordBatch - 1) {
+				commandBuffers.End(0);
+				commandBuffer = commandBuffers.Begin(0);
+			}
+
+			cmdSetViewport(commandBuffer, 0, 1, &viewport);
+		});
+
+		commandBuffers.End(0);
+		return nanoseconds;
+	};
+
+	const auto getFenceStatus = [&](const PFN_vkGetFenceStatus getFenceStatus) {
+		return NanosecondsPerCall(iterations, [&](uint32_t) {
+			getFenceStatus(device.Handle(), fence.Handle());
+		});
+	};
+
+	// The exported functions are the loader trampolines, even when linked statically
+	return
+	{
+		{ "vkCmdSetViewport", setViewport(vkCmdSetViewport), setViewport(dispatch.vkCmdSetViewport) },
+		{ "vkGetFenceStatus", getFenceStatus(vkGetFenceStatus), getFenceStatus(dispatch.vkGetFenceStatus) }
+	};
+}
+
+}
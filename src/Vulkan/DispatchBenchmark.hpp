@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <string>
+#include <vector>
+
+namespace Vulkan {
+	class Device;
+
+	struct DispatchBenchmarkResult {
+		std::string Command;
+		double LoaderNanoseconds;
+		double DirectNanoseconds;
+	};
+
+	// Per call cost of a few cheap commands through the loader exports and through the device dispatch table.
+	// Best run on a software driver (e.g. --device llvmpipe), where the driver side of each call is the cheapest.
+	std::vector<DispatchBenchmarkResult> RunDispatchBenchmark(const Device& device, uint32_t iterations);
+
+}
@@ -0,0 +1,183 @@
+#include "DrawQueue.hpp"
+
+#include "Device.hpp"
+#include "FrameStats.hpp"
+#include "GraphicsPipeline.hpp"
+#include "PipelineLayout.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace Vulkan {
+
+	namespace {
+		// Key layout: pass (8 bits), pipeline (16), material (16), depth bucket (24)
+		constexpr uint32_t PipelineBits = 16;
+		constexpr uint32_t MaterialBits = 16;
+		constexpr uint32_t DepthBits = 24;
+		// Past the last id, further pipelines or materials share it: still correct, only less grouped
+		constexpr uint32_t MaxId = (1u << PipelineBits) - 1;
+
+		constexpr uint32_t RadixBits = 8;
+		constexpr uint32_t RadixSize = 1u << RadixBits;
+		constexpr uint32_t Digits = 64 / RadixBits;
+
+		uint64_t Key(const uint8_t pass, const uint32_t pipeline, const uint32_t material, const uint32_t depth) {
+			return (uint64_t(pass) << (PipelineBits + MaterialBits + DepthBits)) |
+				(uint64_t(pipeline) << (MaterialBits + DepthBits)) |
+				(uint64_t(material) << DepthBits) |
+				uint64_t(depth);
+		}
+
+		template <class THandle>
+		uint32_t Id(std::unordered_map<THandle, uint32_t>& ids, const THandle handle) {
+			return ids.emplace(handle, std::min(static_cast<uint32_t>(ids.size()), MaxId)).first->second;
+		}
+
+		uint32_t DepthBucket(const float depth) {
+			return static_cast<uint32_t>(std::clamp(depth, 0.0f, 1.0f) * float((1u << DepthBits) - 1));
+		}
+
+		// Binds needed to record the draws in the given order, only binding what changes
+		template <class TEntry, class TIndex>
+		uint32_t CountBinds(const std::vector<TEntry>& draws, const std::vector<TIndex>& order) {
+			VkPipeline pipeline = VK_NULL_HANDLE;
+			VkPipelineLayout layout = VK_NULL_HANDLE;
+			VkDescriptorSet material = VK_NULL_HANDLE;
+			uint32_t binds = 0;
+
+			for (const auto index : order) {
+				const auto& draw = draws[index];
+
+				if (draw.Pipeline != pipeline) {
+					pipeline = draw.Pipeline;
+					++binds;
+				}
+
+				if (draw.Material != VK_NULL_HANDLE && (draw.Material != material || draw.Layout != layout)) {
+					material = draw.Material;
+					layout = draw.Layout;
+					++binds;
+				}
+			}
+
+			return binds;
+		}
+	}
+
+DrawQueue::DrawQueue(const Device& device) :
+	device_(device)
+{
+}
+
+DrawQueue::~DrawQueue() = default;
+
+void DrawQueue::Submit(
+	const uint8_t pass,
+	const GraphicsPipeline& pipeline,
+	const PipelineLayout& layout,
+	const VkDescriptorSet material,
+	const float depth,
+	const Draw& draw)
+{
+	const uint32_t pipelineId = Id(pipelineIds_, pipeline.Handle());
+	const uint32_t materialId = material != VK_NULL_HANDLE ? Id(materialIds_, material) : 0;
+
+	keys_.push_back(Key(pass, pipelineId, materialId, DepthBucket(depth)));
+	draws_.push_back({ pipeline.Handle(), layout.Handle(), material, draw });
+}
+
+void DrawQueue::Record(VkCommandBuffer commandBuffer, FrameStats& frameStats) {
+	if (draws_.empty())
+		return;
+
+	Sort();
+
+	const auto& dispatch = device_.Dispatch();
+
+	VkPipeline boundPipeline = VK_NULL_HANDLE;
+	VkPipelineLayout boundLayout = VK_NULL_HANDLE;
+	VkDescriptorSet boundMaterial = VK_NULL_HANDLE;
+
+	for (const auto index : order_) {
+		const auto& entry = draws_[index];
+
+		if (entry.Pipeline != boundPipeline) {
+			dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, entry.Pipeline);
+			boundPipeline = entry.Pipeline;
+		}
+
+		// A different layout may disturb the bound set, it is bound again
+		if (entry.Material != VK_NULL_HANDLE && (entry.Material != boundMaterial || entry.Layout != boundLayout)) {
+			dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, entry.Layout, 0, 1, &entry.Material, 0, nullptr);
+			boundMaterial = entry.Material;
+			boundLayout = entry.Layout;
+		}
+
+		const auto& draw = entry.Arguments;
+		dispatch.vkCmdDraw(commandBuffer, draw.VertexCount, draw.InstanceCount, draw.FirstVertex, draw.FirstInstance);
+		frameStats.RecordDraw(draw.VertexCount / 3 * draw.InstanceCount);
+	}
+
+	// Compared with recording in submission order, which only binds what changes as well
+	std::vector<uint32_t>& submissionOrder = sortedOrder_;
+	submissionOrder.resize(draws_.size());
+	for (uint32_t i = 0; i != submissionOrder.size(); ++i)
+		submissionOrder[i] = i;
+
+	const uint32_t binds = CountBinds(draws_, order_);
+	const uint32_t submissionBinds = CountBinds(draws_, submissionOrder);
+	frameStats.RecordBinds(binds, submissionBinds > binds ? submissionBinds - binds : 0);
+
+	draws_.clear();
+	keys_.clear();
+	pipelineIds_.clear();
+	materialIds_.clear();
+}
+
+void DrawQueue::Sort() {
+	const auto count = static_cast<uint32_t>(keys_.size());
+
+	order_.resize(count);
+	sortedKeys_.resize(count);
+	sortedOrder_.resize(count);
+
+	for (uint32_t i = 0; i != count; ++i)
+		order_[i] = i;
+
+	// Histograms of every digit in a single pass over the keys
+	std::array<std::array<uint32_t, RadixSize>, Digits> histograms{};
+
+	for (const auto key : keys_) {
+		for (uint32_t digit = 0; digit != Digits; ++digit)
+			++histograms[digit][(key >> (digit * RadixBits)) & (RadixSize - 1)];
+	}
+
+	// Stable scatter of one digit after the other, from the least significant
+	for (uint32_t digit = 0; digit != Digits; ++digit) {
+		auto& histogram = histograms[digit];
+		const uint32_t shift = digit * RadixBits;
+
+		// Every key has the same value for this digit, the order does not change
+		if (histogram[(keys_[0] >> shift) & (RadixSize - 1)] == count)
+			continue;
+
+		uint32_t offset = 0;
+		for (auto& bucket : histogram) {
+			const uint32_t size = bucket;
+			bucket = offset;
+			offset += size;
+		}
+
+		for (uint32_t i = 0; i != count; ++i) {
+			const uint32_t destination = histogram[(keys_[i] >> shift) & (RadixSize - 1)]++;
+			sortedKeys_[destination] = keys_[i];
+			sortedOrder_[destination] = order_[i];
+		}
+
+		keys_.swap(sortedKeys_);
+		order_.swap(sortedOrder_);
+	}
+}
+
+}
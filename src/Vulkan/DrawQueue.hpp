@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Vulkan {
+	class Device;
+	class FrameStats;
+	class GraphicsPipeline;
+	class PipelineLayout;
+
+	// Draws recorded in the order of a 64 bits sort key instead of their submission order.
+	// From the most significant bits, the key packs the pass, the pipeline, the material (descriptor set) and a depth
+	// bucket: sorted draws are grouped by state, and recording only binds what changes from one draw to the next.
+	// Keys are sorted every frame with a least significant digit radix sort, skipping the bytes all keys share.
+	class DrawQueue final {
+	public:
+
+		struct Draw {
+			uint32_t VertexCount;
+			uint32_t InstanceCount{ 1 };
+			uint32_t FirstVertex{};
+			uint32_t FirstInstance{};
+		};
+
+		VULKAN_NON_COPIABLE(DrawQueue)
+
+		explicit DrawQueue(const Device& device);
+		~DrawQueue();
+
+		size_t Size() const { return draws_.size(); }
+
+		// Passes are recorded in increasing order. Depth is in [0, 1], nearer draws come first among draws sharing
+		// the same state. The material is bound to set 0 of the layout, unless it is null.
+		void Submit(uint8_t pass, const GraphicsPipeline& pipeline, const PipelineLayout& layout, VkDescriptorSet material, float depth, const Draw& draw);
+
+		// Sort, record and clear the queued draws, within a rendering whose dynamic state is set
+		void Record(VkCommandBuffer commandBuffer, FrameStats& frameStats);
+
+	private:
+
+		struct Entry {
+			VkPipeline Pipeline;
+			VkPipelineLayout Layout;
+			VkDescriptorSet Material;
+			Draw Arguments;
+		};
+
+		void Sort();
+
+		const Device& device_;
+
+		std::vector<Entry> draws_;
+		std::vector<uint64_t> keys_;
+		std::vector<uint32_t> order_;
+		// Ping-pong buffers of the radix sort, kept from one frame to the next
+		std::vector<uint64_t> sortedKeys_;
+		std::vector<uint32_t> sortedOrder_;
+
+		// Pipelines and materials are numbered in order of first use within the frame
+		std::unordered_map<VkPipeline, uint32_t> pipelineIds_;
+		std::unordered_map<VkDescriptorSet, uint32_t> materialIds_;
+	};
+
+}
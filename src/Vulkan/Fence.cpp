@@ -8,7 +8,7 @@ Fence::Fence(const class Device& device, const bool signaled) : device_(device)
 	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 	fenceInfo.flags = signaled ? VK_FENCE_CREATE_SIGNALED_BIT : 0;
 
-	Check(vkCreateFence(device.Handle(), &fenceInfo, nullptr, &fence_), "create fence");
+	Check(device.Dispatch().vkCreateFence(device.Handle(), &fenceInfo, device.Allocator(), &fence_), "create fence");
 }
 
 Fence::Fence(Fence&& other) noexcept : device_(other.device_), fence_(other.fence_) {
@@ -17,17 +17,17 @@ Fence::Fence(Fence&& other) noexcept : device_(other.device_), fence_(other.fenc
 
 Fence::~Fence() {
 	if (fence_ != nullptr) {
-		vkDestroyFence(device_.Handle(), fence_, nullptr);
+		device_.Dispatch().vkDestroyFence(device_.Handle(), fence_, device_.Allocator());
 		fence_ = nullptr;
 	}
 }
 
 void Fence::Reset() {
-	Check(vkResetFences(device_.Handle(), 1, &fence_), "reset fence");
+	Check(device_.Dispatch().vkResetFences(device_.Handle(), 1, &fence_), "reset fence");
 }
 
 void Fence::Wait(const uint64_t timeout) const {
-	Check(vkWaitForFences(device_.Handle(), 1, &fence_, VK_TRUE, timeout), "wait for fence");
+	Check(device_.Dispatch().vkWaitForFences(device_.Handle(), 1, &fence_, VK_TRUE, timeout), "wait for fence");
 }
 
 }
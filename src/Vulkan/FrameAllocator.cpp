@@ -0,0 +1,62 @@
+#include "FrameAllocator.hpp"
+
+#include "Buffer.hpp"
+#include "Device.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace Vulkan {
+
+	namespace {
+		VkDeviceSize AlignUp(const VkDeviceSize size, const VkDeviceSize alignment) {
+			return (size + alignment - 1) / alignment * alignment;
+		}
+
+		// Both limits are powers of two, the largest one satisfies both kinds of dynamic offsets
+		VkDeviceSize OffsetAlignment(const Device& device) {
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties);
+
+			return std::max(properties.limits.minUniformBufferOffsetAlignment, properties.limits.minStorageBufferOffsetAlignment);
+		}
+	}
+
+FrameAllocator::FrameAllocator(const Device& device, const uint32_t frameCount, const VkDeviceSize frameSize) :
+	alignment_(OffsetAlignment(device)),
+	frameSize_(AlignUp(frameSize, alignment_))
+{
+	const auto usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	const auto hostMemory = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+	// Host writes go straight to device local memory when the device exposes it to the host (resizable BAR, integrated GPUs).
+	// A descriptor range may run past the last allocation of the last frame, one frame of slack keeps it within the buffer.
+	buffer_.reset(new class Buffer(device, frameSize_ * (frameCount + 1), usage, hostMemory, "frame allocator", VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+	data_ = static_cast<unsigned char*>(buffer_->Memory().Map(0, VK_WHOLE_SIZE));
+}
+
+FrameAllocator::~FrameAllocator() {
+	buffer_.reset();
+}
+
+VkDescriptorBufferInfo FrameAllocator::DescriptorInfo(const VkDeviceSize range) const {
+	return { buffer_->Handle(), 0, range };
+}
+
+void FrameAllocator::Begin(const uint32_t frame) {
+	frameBegin_ = frame * frameSize_;
+	head_ = frameBegin_;
+}
+
+FrameAllocator::Allocation FrameAllocator::Allocate(const VkDeviceSize size) {
+	if (head_ + size > frameBegin_ + frameSize_)
+		throw std::runtime_error("frame allocator out of space (" + std::to_string(frameSize_) + " bytes per frame)");
+
+	const Allocation allocation = { data_ + head_, static_cast<uint32_t>(head_) };
+	head_ = AlignUp(head_ + size, alignment_);
+
+	return allocation;
+}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <cstring>
+#include <memory>
+
+namespace Vulkan {
+	class Buffer;
+	class Device;
+
+	// Per frame uniform and storage data, sub-allocated linearly from one persistently mapped buffer with a
+	// region per frame in flight. Allocations are aligned for dynamic uniform and storage buffer offsets, so
+	// descriptors are written once against the buffer and every draw only passes its offset: per draw constants
+	// cost a pointer bump and a copy. Everything allocated for a frame is released at once by the next Begin
+	// of that frame, once its previous submission has completed.
+	class FrameAllocator final {
+	public:
+
+		struct Allocation {
+			void* Data;
+			// Dynamic offset of the allocation in the buffer
+			uint32_t Offset;
+		};
+
+		VULKAN_NON_COPIABLE(FrameAllocator)
+
+		FrameAllocator(const Device& device, uint32_t frameCount, VkDeviceSize frameSize);
+		~FrameAllocator();
+
+		const class Buffer& Buffer() const { return *buffer_; }
+		VkDeviceSize FrameSize() const { return frameSize_; }
+		VkDeviceSize Alignment() const { return alignment_; }
+		// Bytes allocated since the last Begin
+		VkDeviceSize Used() const { return head_ - frameBegin_; }
+
+		// Descriptor of a dynamic buffer reading range bytes from an allocation, range is at most the frame size
+		VkDescriptorBufferInfo DescriptorInfo(VkDeviceSize range) const;
+
+		// Release the allocations made the last time this frame was recorded
+		void Begin(uint32_t frame);
+
+		// Throws when the frame region is full
+		Allocation Allocate(VkDeviceSize size);
+
+		template <class T>
+		Allocation Push(const T& data) {
+			const auto allocation = Allocate(sizeof(T));
+			std::memcpy(allocation.Data, &data, sizeof(T));
+			return allocation;
+		}
+
+	private:
+
+		const VkDeviceSize alignment_;
+		const VkDeviceSize frameSize_;
+
+		std::unique_ptr<class Buffer> buffer_;
+		unsigned char* data_{};
+
+		VkDeviceSize frameBegin_{};
+		VkDeviceSize head_{};
+	};
+
+}
@@ -3,31 +3,33 @@
 #include "Device.hpp"
 #include "ImageView.hpp"
 #include "RenderPass.hpp"
-#include "SwapChain.hpp"
 
 #include <array>
 
 namespace Vulkan {
 
-FrameBuffer::FrameBuffer(const class ImageView& imageView, const class RenderPass& renderPass) :
+FrameBuffer::FrameBuffer(const class ImageView& imageView, const class RenderPass& renderPass, const VkExtent2D extent, const class ImageView* const depthView) :
 	imageView_(imageView),
 	renderPass_(renderPass)
 {
-	std::array<VkImageView, 1> attachments =
+	const auto& device = imageView.Device();
+
+	std::array<VkImageView, 2> attachments =
 	{
-		imageView.Handle()
+		imageView.Handle(),
+		depthView != nullptr ? depthView->Handle() : VK_NULL_HANDLE
 	};
 
 	VkFramebufferCreateInfo framebufferInfo = {};
 	framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
 	framebufferInfo.renderPass = renderPass.Handle();
-	framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	framebufferInfo.attachmentCount = depthView != nullptr ? 2 : 1;
 	framebufferInfo.pAttachments = attachments.data();
-	framebufferInfo.width = renderPass.SwapChain().Extent().width;
-	framebufferInfo.height = renderPass.SwapChain().Extent().height;
+	framebufferInfo.width = extent.width;
+	framebufferInfo.height = extent.height;
 	framebufferInfo.layers = 1;
 
-	Check(vkCreateFramebuffer(imageView_.Device().Handle(), &framebufferInfo, nullptr, &framebuffer_), "create framebuffer");
+	Check(device.Dispatch().vkCreateFramebuffer(device.Handle(), &framebufferInfo, device.Allocator(), &framebuffer_), "create framebuffer");
 }
 
 FrameBuffer::FrameBuffer(FrameBuffer&& other) noexcept :
@@ -41,7 +43,8 @@ FrameBuffer::FrameBuffer(FrameBuffer&& other) noexcept :
 FrameBuffer::~FrameBuffer()
 {
 	if (framebuffer_ != nullptr) {
-		vkDestroyFramebuffer(imageView_.Device().Handle(), framebuffer_, nullptr);
+		const auto& device = imageView_.Device();
+		device.Dispatch().vkDestroyFramebuffer(device.Handle(), framebuffer_, device.Allocator());
 		framebuffer_ = nullptr;
 	}
 }
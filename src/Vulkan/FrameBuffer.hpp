@@ -13,7 +13,8 @@ namespace Vulkan {
 		FrameBuffer& operator = (const FrameBuffer&) = delete;
 		FrameBuffer& operator = (FrameBuffer&&) = delete;
 
-		explicit FrameBuffer(const ImageView& imageView, const RenderPass& renderPass);
+		// The depth view is needed when the render pass has a depth attachment
+		FrameBuffer(const ImageView& imageView, const RenderPass& renderPass, VkExtent2D extent, const ImageView* depthView = nullptr);
 		FrameBuffer(FrameBuffer&& other) noexcept;
 		~FrameBuffer();
 
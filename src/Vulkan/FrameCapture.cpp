@@ -0,0 +1,177 @@
+#include "FrameCapture.hpp"
+
+#include "Buffer.hpp"
+#include "Device.hpp"
+#include "SwapChain.hpp"
+#include "TimelineSemaphore.hpp"
+#include "../Utilities/Log.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace Vulkan {
+
+	namespace {
+		// Bytes per texel of the swap chain formats that can be captured, zero for the others
+		uint32_t TexelSize(const VkFormat format) {
+			switch (format) {
+			case VK_FORMAT_R8G8B8A8_UNORM:
+			case VK_FORMAT_R8G8B8A8_SRGB:
+			case VK_FORMAT_B8G8R8A8_UNORM:
+			case VK_FORMAT_B8G8R8A8_SRGB:
+			case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+			case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+				return 4;
+			case VK_FORMAT_R16G16B16A16_SFLOAT:
+				return 8;
+			default:
+				return 0;
+			}
+		}
+
+		bool IsRgba8(const VkFormat format) {
+			return format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB;
+		}
+
+		bool IsBgra8(const VkFormat format) {
+			return format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+		}
+	}
+
+bool FrameCapture::IsSupported(const SwapChain& swapChain) {
+	return (swapChain.ImageUsage() & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) && TexelSize(swapChain.Format()) != 0;
+}
+
+FrameCapture::FrameCapture(const SwapChain& swapChain, const TimelineSemaphore& timeline, const std::string& directory) :
+	swapChain_(swapChain),
+	directory_(directory),
+	texelSize_(TexelSize(swapChain.Format())),
+	ppm_(IsRgba8(swapChain.Format()) || IsBgra8(swapChain.Format())),
+	bgra_(IsBgra8(swapChain.Format()))
+{
+	if (!IsSupported(swapChain))
+		throw std::runtime_error("swap chain images cannot be captured");
+
+	std::filesystem::create_directories(directory);
+
+	const auto& extent = swapChain.Extent();
+	const VkDeviceSize size = VkDeviceSize(extent.width) * extent.height * texelSize_;
+
+	ring_.reset(new ReadbackRing(
+		swapChain.Device(), timeline, RingSize, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, "frame capture",
+		[this](const ReadbackRing::Slot& slot) { Write(slot); }));
+}
+
+FrameCapture::~FrameCapture() {
+	ring_->Stop();
+
+	if (Written() != 0 || Dropped() != 0)
+		LOG_INFO("frame capture: {} frames written to '{}', {} dropped", Written(), directory_, Dropped());
+}
+
+void FrameCapture::Record(VkCommandBuffer commandBuffer, const uint32_t imageIndex, const uint64_t frameValue) {
+	if (!captureNext_ && !continuous_)
+		return;
+
+	captureNext_ = false;
+
+	ReadbackRing::Slot* const slot = ring_->Acquire();
+	if (slot == nullptr)
+		return;
+
+	const auto& dispatch = swapChain_.Device().Dispatch();
+	const auto& extent = swapChain_.Extent();
+	const VkImage image = swapChain_.Images()[imageIndex];
+
+	VkImageMemoryBarrier toTransfer = {};
+	toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	toTransfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	toTransfer.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toTransfer.image = image;
+	toTransfer.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toTransfer);
+
+	VkBufferImageCopy region = {};
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageExtent = { extent.width, extent.height, 1 };
+
+	dispatch.vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot->Buffer->Handle(), 1, &region);
+
+	// Back to present layout, and make the copy visible to the host once the frame value is reached
+	VkImageMemoryBarrier toPresent = toTransfer;
+	toPresent.srcAccessMask = 0;
+	toPresent.dstAccessMask = 0;
+	toPresent.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	toPresent.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	VkBufferMemoryBarrier toHost = {};
+	toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toHost.buffer = slot->Buffer->Handle();
+	toHost.offset = 0;
+	toHost.size = VK_WHOLE_SIZE;
+
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0,
+		0, nullptr, 1, &toHost, 1, &toPresent);
+
+	ring_->Submit(*slot, frameValue);
+}
+
+void FrameCapture::Collect() {
+	ring_->Collect();
+}
+
+void FrameCapture::Write(const ReadbackRing::Slot& slot) {
+	const auto& extent = swapChain_.Extent();
+
+	std::ostringstream filename;
+	filename << directory_ << "/frame_" << std::setw(6) << std::setfill('0') << slot.Number;
+
+	// Formats without a PPM equivalent are written as is, the name holds what is needed to read them
+	if (!ppm_)
+		filename << '_' << extent.width << 'x' << extent.height << "_format" << swapChain_.Format();
+
+	filename << (ppm_ ? ".ppm" : ".raw");
+
+	std::ofstream file(filename.str(), std::ios::binary | std::ios::trunc);
+
+	if (ppm_) {
+		file << "P6\n" << extent.width << ' ' << extent.height << "\n255\n";
+
+		row_.resize(size_t(extent.width) * 3);
+
+		for (uint32_t y = 0; y != extent.height; ++y) {
+			const unsigned char* texel = slot.Data + size_t(y) * extent.width * 4;
+
+			for (uint32_t x = 0; x != extent.width; ++x, texel += 4) {
+				row_[x * 3 + 0] = texel[bgra_ ? 2 : 0];
+				row_[x * 3 + 1] = texel[1];
+				row_[x * 3 + 2] = texel[bgra_ ? 0 : 2];
+			}
+
+			file.write(reinterpret_cast<const char*>(row_.data()), static_cast<std::streamsize>(row_.size()));
+		}
+	}
+	else {
+		file.write(reinterpret_cast<const char*>(slot.Data), static_cast<std::streamsize>(size_t(extent.width) * extent.height * texelSize_));
+	}
+
+	if (!file)
+		LOG_WARNING("failed to write frame capture '{}'", filename.str());
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include "ReadbackRing.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Vulkan {
+	class SwapChain;
+	class TimelineSemaphore;
+
+	// Reads rendered swap chain images back through a ring of host visible buffers.
+	// The copy is recorded at the end of the frame command buffer. Once the graphics timeline reaches the frame
+	// value, a few frames later, the buffer is handed to a worker thread that writes the image to disk.
+	// Nothing ever waits: when every buffer is still in flight or being written, the capture is dropped.
+	class FrameCapture final {
+	public:
+
+		VULKAN_NON_COPIABLE(FrameCapture)
+
+		static constexpr size_t RingSize = 6;
+
+		// The swap chain must be created with transfer source usage and use an 8 bits per channel,
+		// 10 bits packed or half float format
+		static bool IsSupported(const SwapChain& swapChain);
+
+		FrameCapture(const SwapChain& swapChain, const TimelineSemaphore& timeline, const std::string& directory);
+		~FrameCapture();
+
+		// Capture the next frame only, or every frame while continuous
+		void CaptureNext() { captureNext_ = true; }
+		void SetContinuous(const bool continuous) { continuous_ = continuous; }
+
+		// Copy the swap chain image (in present layout) at the end of a frame that signals frameValue on the timeline
+		void Record(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint64_t frameValue);
+		// Hand the copies of the completed frames to the writer thread
+		void Collect();
+
+		uint64_t Written() const { return ring_->Written(); }
+		uint64_t Dropped() const { return ring_->Dropped(); }
+
+	private:
+
+		void Write(const ReadbackRing::Slot& slot);
+
+		const SwapChain& swapChain_;
+		const std::string directory_;
+		const uint32_t texelSize_;
+		const bool ppm_;
+		const bool bgra_;
+
+		std::vector<unsigned char> row_;
+		bool captureNext_{};
+		bool continuous_{};
+
+		// Stopped first on destruction, its writer thread uses the other members
+		std::unique_ptr<ReadbackRing> ring_;
+	};
+
+}
@@ -0,0 +1,86 @@
+#include "FramePacer.hpp"
+
+#include "Device.hpp"
+#include "FrameStats.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace Vulkan {
+
+	namespace {
+		constexpr uint64_t PresentWaitTimeout = 1000000000; // 1 second
+		constexpr double MinSafetyMargin = 1.0;
+		constexpr double Smoothing = 0.1;
+
+		template <class TDuration>
+		double Milliseconds(const TDuration duration) {
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+	}
+
+FramePacer::FramePacer(const class Device& device) :
+	device_(device),
+	safetyMargin_(MinSafetyMargin)
+{
+}
+
+void FramePacer::Reset() {
+	lastPresentId_ = 0;
+	lastPresentTime_ = {};
+}
+
+void FramePacer::WaitForNextFrame(VkSwapchainKHR swapChain, FrameStats& stats) {
+	if (!device_.IsPresentWaitEnabled() || lastPresentId_ == 0)
+		return;
+
+	const auto result = device_.WaitForPresent(swapChain, lastPresentId_, PresentWaitTimeout);
+
+	// The swap chain is about to be recreated or the present got lost, skip pacing for this frame
+	if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+		return;
+
+	const auto now = Clock::now();
+	stats.Record(FrameStats::Metric::InputToPresent, Milliseconds(now - inputTimes_[lastPresentId_ % InputTimeCount]));
+
+	if (lastPresentTime_ != Clock::time_point()) {
+		const double interval = Milliseconds(now - lastPresentTime_);
+		const bool missedVerticalBlank = refreshInterval_ > 0 && interval > refreshInterval_ * 1.5;
+
+		// Only on-time presents tell the refresh interval, a missed one widens the safety margin instead
+		if (!missedVerticalBlank)
+			refreshInterval_ = refreshInterval_ > 0 ? refreshInterval_ + (interval - refreshInterval_) * Smoothing : interval;
+
+		safetyMargin_ = missedVerticalBlank
+			? std::min(safetyMargin_ + 1.0, refreshInterval_ * 0.5)
+			: std::max(safetyMargin_ * 0.95, MinSafetyMargin);
+	}
+
+	lastPresentTime_ = now;
+
+	// The previous image has just been displayed, the next one is needed one refresh interval later
+	const double sleep = refreshInterval_ - workEstimate_ - safetyMargin_;
+
+	if (sleep > 0)
+		std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(sleep));
+}
+
+void FramePacer::OnInputSampled() {
+	inputTimes_[(lastPresentId_ + 1) % InputTimeCount] = Clock::now();
+}
+
+uint64_t FramePacer::NextPresentId() {
+	++lastPresentId_;
+	return device_.IsPresentWaitEnabled() ? lastPresentId_ : 0;
+}
+
+void FramePacer::OnPresented(FrameStats& stats) {
+	const double work = Milliseconds(Clock::now() - inputTimes_[lastPresentId_ % InputTimeCount]);
+	workEstimate_ = workEstimate_ > 0 ? workEstimate_ + (work - workEstimate_) * Smoothing : work;
+
+	// Without present wait, only the time to hand the frame over to the presentation engine is known
+	if (!device_.IsPresentWaitEnabled())
+		stats.Record(FrameStats::Metric::InputToPresent, work);
+}
+
+}
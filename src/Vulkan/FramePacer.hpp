@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace Vulkan {
+	class Device;
+	class FrameStats;
+
+	// Low latency frame pacing. With VK_KHR_present_wait, waits for the previous image to reach the display,
+	// then sleeps until just before the next image is needed so input is sampled as late as possible.
+	// Also measures the input sampling to present latency of every frame.
+	class FramePacer final {
+	public:
+
+		VULKAN_NON_COPIABLE(FramePacer)
+
+		explicit FramePacer(const Device& device);
+		~FramePacer() = default;
+
+		// Present ids are per swap chain, restart them when it is recreated
+		void Reset();
+
+		void WaitForNextFrame(VkSwapchainKHR swapChain, FrameStats& stats);
+		void OnInputSampled();
+		// Id to chain with VkPresentIdKHR, zero when present wait is not enabled
+		uint64_t NextPresentId();
+		void OnPresented(FrameStats& stats);
+
+		double RefreshInterval() const { return refreshInterval_; }
+
+	private:
+
+		using Clock = std::chrono::steady_clock;
+
+		static constexpr size_t InputTimeCount = 8;
+
+		const Device& device_;
+
+		std::array<Clock::time_point, InputTimeCount> inputTimes_{};
+		Clock::time_point lastPresentTime_{};
+		uint64_t lastPresentId_{};
+
+		// Milliseconds
+		double refreshInterval_{};
+		double workEstimate_{};
+		double safetyMargin_;
+	};
+
+}
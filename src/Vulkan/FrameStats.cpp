@@ -0,0 +1,93 @@
+#include "FrameStats.hpp"
+#include "../Utilities/Log.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace Vulkan {
+
+const char* FrameStats::Name(const Metric metric) {
+	switch (metric) {
+	case Metric::CpuFrame:
+		return "cpu";
+	case Metric::Gpu:
+		return "gpu";
+	case Metric::Acquire:
+		return "acquire";
+	case Metric::Present:
+		return "present";
+	case Metric::InputToPresent:
+		return "input-to-present";
+	case Metric::OverlayCpu:
+		return "overlay-cpu";
+	case Metric::OverlayGpu:
+		return "overlay-gpu";
+	default:
+		return "unknown";
+	}
+}
+
+void FrameStats::Record(const Metric metric, const double milliseconds) {
+	auto& stats = metrics_[Index(metric)];
+
+	stats.History[stats.Next] = static_cast<float>(milliseconds);
+	stats.Next = (stats.Next + 1) % HistorySize;
+	stats.IntervalSum += milliseconds;
+	stats.IntervalMax = std::max(stats.IntervalMax, milliseconds);
+	++stats.IntervalCount;
+}
+
+void FrameStats::EndFrame() {
+	lastDrawCalls_ = drawCalls_;
+	lastTriangles_ = triangles_;
+	lastBinds_ = binds_;
+	lastSavedBinds_ = savedBinds_;
+	drawCalls_ = 0;
+	triangles_ = 0;
+	binds_ = 0;
+	savedBinds_ = 0;
+
+	++intervalFrames_;
+}
+
+double FrameStats::Last(const Metric metric) const {
+	const auto& stats = metrics_[Index(metric)];
+	return stats.History[(stats.Next + HistorySize - 1) % HistorySize];
+}
+
+bool FrameStats::Report(const double time, const double interval) {
+	const double elapsed = time - lastReportTime_;
+
+	if (elapsed < interval)
+		return false;
+
+	// Formatted once per interval, the logger writes it off the render thread
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(2);
+	out << "Stats: " << intervalFrames_ / elapsed << " fps";
+
+	for (size_t i = 0; i != MetricCount; ++i) {
+		auto& stats = metrics_[i];
+
+		if (stats.IntervalCount != 0) {
+			out << ", " << Name(static_cast<Metric>(i)) << " " << stats.IntervalSum / stats.IntervalCount << " ms";
+			out << " (max " << stats.IntervalMax << ")";
+		}
+
+		stats.IntervalSum = 0;
+		stats.IntervalMax = 0;
+		stats.IntervalCount = 0;
+	}
+
+	out << ", " << lastDrawCalls_ << " draws, " << lastTriangles_ << " triangles";
+	out << ", " << lastBinds_ << " binds (" << lastSavedBinds_ << " saved by sorting)";
+	LOG_INFO("{}", out.str());
+
+	intervalFrames_ = 0;
+	lastReportTime_ = time;
+
+	return true;
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Vulkan {
+
+	// Rolling per-frame timings in milliseconds, kept for periodic reports and graphs.
+	class FrameStats final {
+	public:
+
+		enum class Metric {
+			CpuFrame,
+			Gpu,
+			Acquire,
+			Present,
+			InputToPresent,
+			OverlayCpu,
+			OverlayGpu,
+			Count
+		};
+
+		static constexpr size_t HistorySize = 240;
+		static constexpr size_t MetricCount = static_cast<size_t>(Metric::Count);
+
+		static const char* Name(Metric metric);
+
+		void Record(Metric metric, double milliseconds);
+		void RecordDraw(uint32_t triangleCount) { ++drawCalls_; triangles_ += triangleCount; }
+		// Pipeline and descriptor set binds of sorted draws, and the binds their sorting saved
+		void RecordBinds(uint32_t binds, uint32_t saved) { binds_ += binds; savedBinds_ += saved; }
+		void EndFrame();
+
+		// Draw calls and triangles submitted during the last completed frame
+		uint32_t DrawCalls() const { return lastDrawCalls_; }
+		uint64_t Triangles() const { return lastTriangles_; }
+		uint32_t Binds() const { return lastBinds_; }
+		uint32_t SavedBinds() const { return lastSavedBinds_; }
+
+		// Ring of the last samples, the oldest one being at HistoryOffset()
+		const std::array<float, HistorySize>& History(const Metric metric) const { return metrics_[Index(metric)].History; }
+		size_t HistoryOffset(const Metric metric) const { return metrics_[Index(metric)].Next; }
+		double Last(Metric metric) const;
+
+		// Log the averages and maxima since the last report once every interval (in seconds)
+		bool Report(double time, double interval);
+
+	private:
+
+		struct MetricStats {
+			std::array<float, HistorySize> History{};
+			size_t Next{};
+			double IntervalSum{};
+			double IntervalMax{};
+			size_t IntervalCount{};
+		};
+
+		static size_t Index(const Metric metric) { return static_cast<size_t>(metric); }
+
+		std::array<MetricStats, MetricCount> metrics_{};
+		size_t intervalFrames_{};
+		uint32_t drawCalls_{};
+		uint64_t triangles_{};
+		uint32_t lastDrawCalls_{};
+		uint64_t lastTriangles_{};
+		uint32_t binds_{};
+		uint32_t savedBinds_{};
+		uint32_t lastBinds_{};
+		uint32_t lastSavedBinds_{};
+		double lastReportTime_{};
+	};
+
+}
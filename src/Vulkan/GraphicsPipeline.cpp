@@ -1,58 +1,68 @@
 #include "GraphicsPipeline.hpp"
 
+#include "PipelineCache.hpp"
 #include "PipelineLayout.hpp"
-#include "SwapChain.hpp"
 #include "Device.hpp"
 #include "RenderPass.hpp"
-#include "ShaderModule.hpp"
+
+#include <array>
 
 namespace Vulkan {
 
+std::atomic<uint32_t> GraphicsPipeline::liveCount_{};
+
 GraphicsPipeline::GraphicsPipeline(
-	const SwapChain& swapChain,
-	const bool isWireFrame) :
-	swapChain_(swapChain),
-	isWireFrame_(isWireFrame)
+	const class Device& device,
+	const PipelineCache& pipelineCache,
+	const PipelineLayout& pipelineLayout,
+	const RenderPass* renderPass,
+	const VkFormat colorAttachmentFormat,
+	const VkFormat depthAttachmentFormat,
+	const std::vector<VkPipelineShaderStageCreateInfo>& shaderStages,
+	const PipelineState& state,
+	const VertexInput& vertexInput) :
+	device_(device),
+	state_(state)
 {
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount = 0;
-	vertexInputInfo.pVertexBindingDescriptions = nullptr;
-	vertexInputInfo.vertexAttributeDescriptionCount = 0;
-	vertexInputInfo.pVertexAttributeDescriptions = nullptr;
+	vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(vertexInput.Bindings.size());
+	vertexInputInfo.pVertexBindingDescriptions = vertexInput.Bindings.data();
+	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexInput.Attributes.size());
+	vertexInputInfo.pVertexAttributeDescriptions = vertexInput.Attributes.data();
 
 	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
 	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
 	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 	inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-	VkViewport viewport = {};
-	viewport.x = 0.0f;
-	viewport.y = 0.0f;
-	viewport.width = static_cast<float>(swapChain.Extent().width);
-	viewport.height = static_cast<float>(swapChain.Extent().height);
-	viewport.minDepth = 0.0f;
-	viewport.maxDepth = 1.0f;
-
-	VkRect2D scissor = {};
-	scissor.offset = { 0, 0 };
-	scissor.extent = swapChain.Extent();
-
+	// Viewport and scissor are dynamic so a pipeline does not depend on the swap chain extent
 	VkPipelineViewportStateCreateInfo viewportState = {};
 	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
 	viewportState.viewportCount = 1;
-	viewportState.pViewports = &viewport;
+	viewportState.pViewports = nullptr;
 	viewportState.scissorCount = 1;
-	viewportState.pScissors = &scissor;
+	viewportState.pScissors = nullptr;
+
+	std::array<VkDynamicState, 2> dynamicStates =
+	{
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR
+	};
+
+	VkPipelineDynamicStateCreateInfo dynamicState = {};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+	dynamicState.pDynamicStates = dynamicStates.data();
 
 	VkPipelineRasterizationStateCreateInfo rasterizer = {};
 	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
 	rasterizer.depthClampEnable = VK_FALSE;
 	rasterizer.rasterizerDiscardEnable = VK_FALSE;
-	rasterizer.polygonMode = isWireFrame ? VK_POLYGON_MODE_LINE : VK_POLYGON_MODE_FILL;
+	rasterizer.polygonMode = state.PolygonMode();
 	rasterizer.lineWidth = 1.0f;
-	rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterizer.cullMode = state.CullMode();
+	rasterizer.frontFace = state.FrontFace();
 	rasterizer.depthBiasEnable = VK_FALSE;
 	rasterizer.depthBiasConstantFactor = 0.0f; // Optional
 	rasterizer.depthBiasClamp = 0.0f; // Optional
@@ -67,15 +77,26 @@ GraphicsPipeline::GraphicsPipeline(
 	multisampling.alphaToCoverageEnable = VK_FALSE; // Optional
 	multisampling.alphaToOneEnable = VK_FALSE; // Optional
 
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencil.depthTestEnable = state.DepthTest() ? VK_TRUE : VK_FALSE;
+	depthStencil.depthWriteEnable = state.DepthTest() ? VK_TRUE : VK_FALSE;
+	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	depthStencil.depthBoundsTestEnable = VK_FALSE;
+	depthStencil.stencilTestEnable = VK_FALSE;
+
 	VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
 	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	colorBlendAttachment.blendEnable = VK_FALSE;
-	colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-	colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-	colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD; // Optional
-	colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-	colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-	colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD; // Optional
+	colorBlendAttachment.blendEnable = state.BlendEnable() ? VK_TRUE : VK_FALSE;
+	colorBlendAttachment.srcColorBlendFactor = state.BlendEnable() ? VK_BLEND_FACTOR_SRC_ALPHA : VK_BLEND_FACTOR_ONE;
+	colorBlendAttachment.dstColorBlendFactor =
+		state.Blend() == BlendMode::Alpha ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA :
+		state.Blend() == BlendMode::Additive ? VK_BLEND_FACTOR_ONE :
+		VK_BLEND_FACTOR_ZERO;
+	colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+	colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+	colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 
 	VkPipelineColorBlendStateCreateInfo colorBlending = {};
 	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
@@ -88,52 +109,43 @@ GraphicsPipeline::GraphicsPipeline(
 	colorBlending.blendConstants[2] = 0.0f; // Optional
 	colorBlending.blendConstants[3] = 0.0f; // Optional
 
-	const auto& device = swapChain.Device();
-
-	// Create pipeline layout and render pass
-	pipelineLayout_.reset(new class PipelineLayout(device));
-	renderPass_.reset(new class RenderPass(swapChain, true));
-
-	// Load shaders
-	const ShaderModule vertShader(device, "../assets/shaders/triangle.vert.spv");
-	const ShaderModule fragShader(device, "../assets/shaders/triangle.frag.spv");
-
-	VkPipelineShaderStageCreateInfo shaderStages[] =
-	{
-		vertShader.CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT),
-		fragShader.CreateShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT)
-	};
+	// Without a render pass (dynamic rendering) the attachment formats are given at pipeline creation
+	VkPipelineRenderingCreateInfoKHR renderingInfo = {};
+	renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+	renderingInfo.colorAttachmentCount = 1;
+	renderingInfo.pColorAttachmentFormats = &colorAttachmentFormat;
+	renderingInfo.depthAttachmentFormat = depthAttachmentFormat;
 
 	// Create graphic pipeline
 	VkGraphicsPipelineCreateInfo pipelineInfo = {};
 	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipelineInfo.stageCount = 2;
-	pipelineInfo.pStages = shaderStages;
+	pipelineInfo.pNext = renderPass == nullptr ? &renderingInfo : nullptr;
+	pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+	pipelineInfo.pStages = shaderStages.data();
 	pipelineInfo.pVertexInputState = &vertexInputInfo;
 	pipelineInfo.pInputAssemblyState = &inputAssembly;
 	pipelineInfo.pViewportState = &viewportState;
 	pipelineInfo.pRasterizationState = &rasterizer;
 	pipelineInfo.pMultisampleState = &multisampling;
-	pipelineInfo.pDepthStencilState = nullptr; // Optional
+	pipelineInfo.pDepthStencilState = depthAttachmentFormat != VK_FORMAT_UNDEFINED ? &depthStencil : nullptr;
 	pipelineInfo.pColorBlendState = &colorBlending;
-	pipelineInfo.pDynamicState = nullptr; // Optional
+	pipelineInfo.pDynamicState = &dynamicState;
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
 	pipelineInfo.basePipelineIndex = -1; // Optional
-	pipelineInfo.layout = pipelineLayout_->Handle();
-	pipelineInfo.renderPass = renderPass_->Handle();
+	pipelineInfo.layout = pipelineLayout.Handle();
+	pipelineInfo.renderPass = renderPass != nullptr ? renderPass->Handle() : VK_NULL_HANDLE;
 	pipelineInfo.subpass = 0;
 
-	Check(vkCreateGraphicsPipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_), "create graphics pipeline");
+	Check(device.Dispatch().vkCreateGraphicsPipelines(device.Handle(), pipelineCache.Handle(), 1, &pipelineInfo, device.Allocator(), &pipeline_), "create graphics pipeline");
+	++liveCount_;
 }
 
 GraphicsPipeline::~GraphicsPipeline() {
 	if (pipeline_ != nullptr) {
-		vkDestroyPipeline(swapChain_.Device().Handle(), pipeline_, nullptr);
+		device_.Dispatch().vkDestroyPipeline(device_.Handle(), pipeline_, device_.Allocator());
 		pipeline_ = nullptr;
+		--liveCount_;
 	}
-
-	renderPass_.reset();
-	pipelineLayout_.reset();
 }
 
 }
@@ -1,36 +1,55 @@
 #pragma once
 
 #include "Vulkan.hpp"
+#include "PipelineState.hpp"
 
-#include <memory>
+#include <atomic>
+#include <vector>
 
 namespace Vulkan {
+	class Device;
+	class PipelineCache;
 	class PipelineLayout;
-	class SwapChain;
+	class RenderPass;
 
+	// Vertex buffer layout, left empty when the vertices are generated in the vertex shader
+	struct VertexInput {
+		std::vector<VkVertexInputBindingDescription> Bindings;
+		std::vector<VkVertexInputAttributeDescription> Attributes;
+	};
+
+	// The depth attachment format is VK_FORMAT_UNDEFINED when the target has no depth attachment.
 	class GraphicsPipeline final {
 	public:
 
 		VULKAN_NON_COPIABLE(GraphicsPipeline)
 
 		GraphicsPipeline(
-			const SwapChain& swapChain, 
-			bool isWireFrame);
+			const Device& device,
+			const PipelineCache& pipelineCache,
+			const PipelineLayout& pipelineLayout,
+			const RenderPass* renderPass,
+			VkFormat colorAttachmentFormat,
+			VkFormat depthAttachmentFormat,
+			const std::vector<VkPipelineShaderStageCreateInfo>& shaderStages,
+			const PipelineState& state,
+			const VertexInput& vertexInput = {});
 		~GraphicsPipeline();
 
-		bool IsWireFrame() const { return isWireFrame_; }
-		const class PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
-		const class RenderPass& RenderPass() const { return *renderPass_; }
+		const PipelineState& State() const { return state_; }
+		bool IsWireFrame() const { return state_.PolygonMode() == VK_POLYGON_MODE_LINE; }
+
+		// Graphics pipelines currently alive, whichever thread compiled them
+		static uint32_t LiveCount() { return liveCount_; }
 
 	private:
 
-		const SwapChain& swapChain_;
-		const bool isWireFrame_;
+		static std::atomic<uint32_t> liveCount_;
 
-		VULKAN_HANDLE(VkPipeline, pipeline_)
+		const class Device& device_;
+		const PipelineState state_;
 
-		std::unique_ptr<class PipelineLayout> pipelineLayout_;
-		std::unique_ptr<class RenderPass> renderPass_;
+		VULKAN_HANDLE(VkPipeline, pipeline_)
 	};
 
 }
@@ -0,0 +1,50 @@
+#include "GraphicsPipelineCache.hpp"
+
+#include "Device.hpp"
+#include "GraphicsPipeline.hpp"
+#include "PipelineLayout.hpp"
+#include "PipelineVariants.hpp"
+#include "RenderPass.hpp"
+
+namespace Vulkan {
+
+GraphicsPipelineCache::GraphicsPipelineCache(
+	const Device& device,
+	PipelineCompiler& pipelineCompiler,
+	const VkFormat colorFormat,
+	const VkFormat depthFormat,
+	const VkImageLayout finalLayout,
+	const std::vector<char>& vertShaderCode,
+	const std::vector<char>& fragShaderCode) :
+	device_(device),
+	pipelineCompiler_(pipelineCompiler),
+	colorFormat_(colorFormat),
+	depthFormat_(depthFormat)
+{
+	// Every variant shares the same layout, render pass and shaders
+	pipelineLayout_.reset(new class PipelineLayout(device));
+
+	if (!device.IsDynamicRenderingEnabled()) {
+		renderPass_.reset(new class RenderPass(device, colorFormat, finalLayout, true, depthFormat));
+		resumeRenderPass_.reset(new class RenderPass(device, colorFormat, finalLayout, false, depthFormat));
+	}
+
+	pipelines_.reset(new PipelineVariants(device, pipelineCompiler, "scene", *pipelineLayout_, renderPass_.get(), colorFormat, depthFormat, vertShaderCode, fragShaderCode));
+}
+
+GraphicsPipelineCache::~GraphicsPipelineCache() {
+	pipelines_.reset();
+	resumeRenderPass_.reset();
+	renderPass_.reset();
+	pipelineLayout_.reset();
+}
+
+const GraphicsPipeline& GraphicsPipelineCache::Get(const PipelineState& state, const ShaderVariant& variant) {
+	return pipelines_->Get(state, variant);
+}
+
+void GraphicsPipelineCache::Prewarm(const std::vector<PipelineState>& states, const std::vector<ShaderVariant>& variants) {
+	pipelines_->Prewarm(states, variants);
+}
+
+}
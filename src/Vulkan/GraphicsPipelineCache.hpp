@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include "PipelineState.hpp"
+#include "ShaderVariant.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace Vulkan {
+	class Device;
+	class GraphicsPipeline;
+	class PipelineCompiler;
+	class PipelineLayout;
+	class PipelineVariants;
+	class RenderPass;
+
+	// Owns every graphics pipeline variant rendering to one color attachment format (the swap chain or an offscreen target).
+	// Variants are looked up by their PipelineState and ShaderVariant and created on first use (or prewarmed in parallel),
+	// compiled pipelines are reused from the persistent driver pipeline cache when possible.
+	class GraphicsPipelineCache final {
+	public:
+
+		VULKAN_NON_COPIABLE(GraphicsPipelineCache)
+
+		// The render pass, when the device needs one, leaves the color attachment in finalLayout.
+		// A second compatible render pass loads the attachments instead of clearing them, to resume the scene.
+		GraphicsPipelineCache(
+			const Device& device,
+			PipelineCompiler& pipelineCompiler,
+			VkFormat colorFormat,
+			VkFormat depthFormat,
+			VkImageLayout finalLayout,
+			const std::vector<char>& vertShaderCode,
+			const std::vector<char>& fragShaderCode);
+		~GraphicsPipelineCache();
+
+		VkFormat ColorFormat() const { return colorFormat_; }
+		VkFormat DepthFormat() const { return depthFormat_; }
+		const class PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
+		// Null when the device uses dynamic rendering
+		const class RenderPass* RenderPass() const { return renderPass_.get(); }
+		const class RenderPass* ResumeRenderPass() const { return resumeRenderPass_.get(); }
+
+		const GraphicsPipeline& Get(const PipelineState& state, const ShaderVariant& variant = ShaderVariant());
+		void Prewarm(const std::vector<PipelineState>& states, const std::vector<ShaderVariant>& variants = { ShaderVariant() });
+
+	private:
+
+		const Device& device_;
+		PipelineCompiler& pipelineCompiler_;
+		const VkFormat colorFormat_;
+		const VkFormat depthFormat_;
+
+		std::unique_ptr<class PipelineLayout> pipelineLayout_;
+		std::unique_ptr<class RenderPass> renderPass_;
+		std::unique_ptr<class RenderPass> resumeRenderPass_;
+		std::unique_ptr<PipelineVariants> pipelines_;
+	};
+
+}
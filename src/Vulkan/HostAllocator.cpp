@@ -0,0 +1,251 @@
+#include "HostAllocator.hpp"
+
+#include "../Utilities/Log.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace Vulkan {
+
+	namespace {
+		// Stored right before every pointer handed to the driver
+		struct BlockHeader {
+			uint64_t Size;
+			uint32_t Offset;
+			uint8_t SizeClass;
+			uint8_t Scope;
+			uint16_t Unused;
+		};
+
+		static_assert(sizeof(BlockHeader) == 16, "block header must keep 16 bytes alignment");
+
+		constexpr uint8_t LargeBlock = 0xFF;
+
+		BlockHeader* HeaderOf(void* const memory) {
+			return reinterpret_cast<BlockHeader*>(static_cast<unsigned char*>(memory) - sizeof(BlockHeader));
+		}
+
+		const char* ScopeName(const size_t scope) {
+			switch (scope) {
+			case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND:
+				return "command";
+			case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT:
+				return "object";
+			case VK_SYSTEM_ALLOCATION_SCOPE_CACHE:
+				return "cache";
+			case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE:
+				return "device";
+			case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE:
+				return "instance";
+			default:
+				return "unknown";
+			}
+		}
+	}
+
+HostAllocator::HostAllocator() {
+	callbacks_.pUserData = this;
+	callbacks_.pfnAllocation = &HostAllocator::Allocate;
+	callbacks_.pfnReallocation = &HostAllocator::Reallocate;
+	callbacks_.pfnFree = &HostAllocator::Free;
+	callbacks_.pfnInternalAllocation = &HostAllocator::OnInternalAllocation;
+	callbacks_.pfnInternalFree = &HostAllocator::OnInternalFree;
+}
+
+HostAllocator::~HostAllocator() {
+	Report();
+}
+
+HostAllocator::ScopeCounters HostAllocator::Counters(const VkSystemAllocationScope scope) const {
+	const auto& counters = counters_[scope];
+
+	ScopeCounters result;
+	result.Allocations = counters.Allocations.load(std::memory_order_relaxed);
+	result.Reallocations = counters.Reallocations.load(std::memory_order_relaxed);
+	result.Frees = counters.Frees.load(std::memory_order_relaxed);
+	result.InternalAllocations = counters.InternalAllocations.load(std::memory_order_relaxed);
+	result.Bytes = counters.Bytes.load(std::memory_order_relaxed);
+	result.PeakBytes = counters.PeakBytes.load(std::memory_order_relaxed);
+
+	return result;
+}
+
+void HostAllocator::Report() const {
+	LOG_INFO("Host allocator: {} KB reserved in chunks", ReservedBytes() / 1024);
+
+	for (size_t scope = 0; scope != ScopeCount; ++scope) {
+		const auto counters = Counters(static_cast<VkSystemAllocationScope>(scope));
+
+		if (counters.Allocations == 0 && counters.InternalAllocations == 0)
+			continue;
+
+		LOG_INFO("  {}: {} allocations, {} reallocations, {} frees, {} internal, {} KB live (peak {} KB)",
+			ScopeName(scope), counters.Allocations, counters.Reallocations, counters.Frees, counters.InternalAllocations,
+			counters.Bytes / 1024, counters.PeakBytes / 1024);
+	}
+}
+
+void* VKAPI_CALL HostAllocator::Allocate(void* const userData, const size_t size, const size_t alignment, const VkSystemAllocationScope scope) {
+	auto* const allocator = static_cast<HostAllocator*>(userData);
+	allocator->counters_[scope].Allocations.fetch_add(1, std::memory_order_relaxed);
+
+	return allocator->Allocate(size, alignment, scope);
+}
+
+void* VKAPI_CALL HostAllocator::Reallocate(void* const userData, void* const original, const size_t size, const size_t alignment, const VkSystemAllocationScope scope) {
+	auto* const allocator = static_cast<HostAllocator*>(userData);
+
+	if (original == nullptr)
+		return Allocate(userData, size, alignment, scope);
+
+	if (size == 0) {
+		Free(userData, original);
+		return nullptr;
+	}
+
+	allocator->counters_[scope].Reallocations.fetch_add(1, std::memory_order_relaxed);
+
+	void* const memory = allocator->Allocate(size, alignment, scope);
+	if (memory == nullptr)
+		return nullptr;
+
+	std::memcpy(memory, original, std::min<size_t>(size, HeaderOf(original)->Size));
+	allocator->Free(original);
+
+	return memory;
+}
+
+void VKAPI_CALL HostAllocator::Free(void* const userData, void* const memory) {
+	if (memory == nullptr)
+		return;
+
+	auto* const allocator = static_cast<HostAllocator*>(userData);
+	allocator->counters_[HeaderOf(memory)->Scope].Frees.fetch_add(1, std::memory_order_relaxed);
+	allocator->Free(memory);
+}
+
+void VKAPI_CALL HostAllocator::OnInternalAllocation(void* const userData, const size_t size, VkInternalAllocationType, const VkSystemAllocationScope scope) {
+	auto* const allocator = static_cast<HostAllocator*>(userData);
+	allocator->counters_[scope].InternalAllocations.fetch_add(1, std::memory_order_relaxed);
+	allocator->Account(scope, static_cast<int64_t>(size));
+}
+
+void VKAPI_CALL HostAllocator::OnInternalFree(void* const userData, const size_t size, VkInternalAllocationType, const VkSystemAllocationScope scope) {
+	static_cast<HostAllocator*>(userData)->Account(scope, -static_cast<int64_t>(size));
+}
+
+void* HostAllocator::Allocate(const size_t size, const size_t alignment, const VkSystemAllocationScope scope) {
+	unsigned char* memory;
+	BlockHeader header = {};
+	header.Size = size;
+	header.Scope = static_cast<uint8_t>(scope);
+
+	if (alignment <= HeaderSize && size + HeaderSize <= BlockSize(ClassCount - 1)) {
+		header.SizeClass = static_cast<uint8_t>(SizeClassOf(size + HeaderSize));
+
+		unsigned char* const block = static_cast<unsigned char*>(AllocateBlock(header.SizeClass));
+		if (block == nullptr)
+			return nullptr;
+
+		memory = block + HeaderSize;
+	}
+	else {
+		// Over-aligned or large, the padding before the header is remembered to free the raw pointer
+		const size_t blockAlignment = std::max(alignment, HeaderSize);
+		unsigned char* const raw = static_cast<unsigned char*>(::operator new(size + blockAlignment + HeaderSize, std::nothrow));
+		if (raw == nullptr)
+			return nullptr;
+
+		const auto address = reinterpret_cast<uintptr_t>(raw + HeaderSize);
+		memory = reinterpret_cast<unsigned char*>((address + blockAlignment - 1) & ~(static_cast<uintptr_t>(blockAlignment) - 1));
+
+		header.SizeClass = LargeBlock;
+		header.Offset = static_cast<uint32_t>(memory - raw);
+	}
+
+	std::memcpy(memory - HeaderSize, &header, sizeof(header));
+	Account(scope, static_cast<int64_t>(size));
+
+	return memory;
+}
+
+void HostAllocator::Free(void* const memory) {
+	const BlockHeader header = *HeaderOf(memory);
+	Account(static_cast<VkSystemAllocationScope>(header.Scope), -static_cast<int64_t>(header.Size));
+
+	if (header.SizeClass == LargeBlock)
+		::operator delete(static_cast<unsigned char*>(memory) - header.Offset);
+	else
+		ReleaseBlock(header.SizeClass, static_cast<unsigned char*>(memory) - HeaderSize);
+}
+
+void* HostAllocator::AllocateBlock(const size_t sizeClass) {
+	auto& pool = classes_[sizeClass];
+
+	{
+		std::lock_guard<std::mutex> lock(pool.Mutex);
+
+		if (pool.FreeList != nullptr) {
+			FreeBlock* const block = pool.FreeList;
+			pool.FreeList = block->Next;
+			return block;
+		}
+	}
+
+	// Carve a new chunk into blocks of this class, keep one and give the others to the free list
+	const size_t blockSize = BlockSize(sizeClass);
+	const size_t blockCount = ChunkSize / blockSize;
+
+	std::unique_ptr<ChunkUnit[]> chunk(new (std::nothrow) ChunkUnit[ChunkSize / sizeof(ChunkUnit)]);
+	if (!chunk)
+		return nullptr;
+
+	unsigned char* const bytes = chunk[0].Bytes;
+
+	{
+		std::lock_guard<std::mutex> lock(chunksMutex_);
+		chunks_.push_back(std::move(chunk));
+	}
+
+	reservedBytes_.fetch_add(ChunkSize, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(pool.Mutex);
+
+	for (size_t i = 1; i != blockCount; ++i) {
+		auto* const block = reinterpret_cast<FreeBlock*>(bytes + i * blockSize);
+		block->Next = pool.FreeList;
+		pool.FreeList = block;
+	}
+
+	return bytes;
+}
+
+void HostAllocator::ReleaseBlock(const size_t sizeClass, void* const block) {
+	auto& pool = classes_[sizeClass];
+	std::lock_guard<std::mutex> lock(pool.Mutex);
+
+	auto* const freeBlock = static_cast<FreeBlock*>(block);
+	freeBlock->Next = pool.FreeList;
+	pool.FreeList = freeBlock;
+}
+
+void HostAllocator::Account(const VkSystemAllocationScope scope, const int64_t bytes) {
+	auto& counters = counters_[scope];
+	const int64_t total = counters.Bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+	int64_t peak = counters.PeakBytes.load(std::memory_order_relaxed);
+	while (total > peak && !counters.PeakBytes.compare_exchange_weak(peak, total, std::memory_order_relaxed)) {
+	}
+}
+
+size_t HostAllocator::SizeClassOf(const size_t size) {
+	size_t sizeClass = 0;
+	while (BlockSize(sizeClass) < size) {
+		++sizeClass;
+	}
+
+	return sizeClass;
+}
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Vulkan {
+
+	// Host memory allocator handed to the driver through VkAllocationCallbacks.
+	// Small requests are served from per size class free lists carved out of large chunks, bigger or
+	// over-aligned ones go to the system allocator. Calls and bytes are accounted per allocation scope.
+	class HostAllocator final {
+	public:
+
+		struct ScopeCounters {
+			uint64_t Allocations{};
+			uint64_t Reallocations{};
+			uint64_t Frees{};
+			uint64_t InternalAllocations{};
+			int64_t Bytes{};
+			int64_t PeakBytes{};
+		};
+
+		VULKAN_NON_COPIABLE(HostAllocator)
+
+		static constexpr size_t ScopeCount = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+
+		HostAllocator();
+		~HostAllocator();
+
+		const VkAllocationCallbacks* Callbacks() const { return &callbacks_; }
+
+		ScopeCounters Counters(VkSystemAllocationScope scope) const;
+		// Bytes held in chunks, including the free blocks kept for reuse
+		size_t ReservedBytes() const { return reservedBytes_.load(std::memory_order_relaxed); }
+
+		// Log the counters of every scope
+		void Report() const;
+
+	private:
+
+		// Blocks are 16 bytes aligned, from 32 bytes up to 4 KiB (the block header included)
+		static constexpr size_t MinClassSize = 32;
+		static constexpr size_t ClassCount = 8;
+		static constexpr size_t ChunkSize = 64 * 1024;
+		static constexpr size_t HeaderSize = 16;
+
+		struct FreeBlock {
+			FreeBlock* Next;
+		};
+
+		struct alignas(16) ChunkUnit {
+			unsigned char Bytes[16];
+		};
+
+		struct SizeClass {
+			std::mutex Mutex;
+			FreeBlock* FreeList{};
+		};
+
+		struct AtomicScopeCounters {
+			std::atomic<uint64_t> Allocations{};
+			std::atomic<uint64_t> Reallocations{};
+			std::atomic<uint64_t> Frees{};
+			std::atomic<uint64_t> InternalAllocations{};
+			std::atomic<int64_t> Bytes{};
+			std::atomic<int64_t> PeakBytes{};
+		};
+
+		static void* VKAPI_CALL Allocate(void* userData, size_t size, size_t alignment, VkSystemAllocationScope scope);
+		static void* VKAPI_CALL Reallocate(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+		static void VKAPI_CALL Free(void* userData, void* memory);
+		static void VKAPI_CALL OnInternalAllocation(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+		static void VKAPI_CALL OnInternalFree(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+
+		void* Allocate(size_t size, size_t alignment, VkSystemAllocationScope scope);
+		void Free(void* memory);
+		void* AllocateBlock(size_t sizeClass);
+		void ReleaseBlock(size_t sizeClass, void* block);
+		void Account(VkSystemAllocationScope scope, int64_t bytes);
+
+		static size_t SizeClassOf(size_t size);
+		static size_t BlockSize(size_t sizeClass) { return MinClassSize << sizeClass; }
+
+		VkAllocationCallbacks callbacks_{};
+
+		std::array<SizeClass, ClassCount> classes_;
+		std::mutex chunksMutex_;
+		std::vector<std::unique_ptr<ChunkUnit[]>> chunks_;
+		std::atomic<size_t> reservedBytes_{};
+
+		std::array<AtomicScopeCounters, ScopeCount> counters_;
+	};
+
+}
@@ -0,0 +1,65 @@
+#include "Image.hpp"
+
+#include "Device.hpp"
+
+#include <algorithm>
+
+namespace Vulkan {
+
+Image::Image(
+	const class Device& device,
+	const VkExtent2D extent,
+	const uint32_t mipLevels,
+	const VkFormat format,
+	const VkImageUsageFlags usage,
+	const std::vector<uint32_t>& queueFamilyIndices,
+	const char* const tag) :
+	device_(device),
+	extent_(extent),
+	mipLevels_(mipLevels),
+	format_(format)
+{
+	std::vector<uint32_t> families = queueFamilyIndices;
+	std::sort(families.begin(), families.end());
+	families.erase(std::unique(families.begin(), families.end()), families.end());
+
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = format;
+	imageInfo.extent = { extent.width, extent.height, 1 };
+	imageInfo.mipLevels = mipLevels;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = usage;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	if (families.size() > 1) {
+		imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		imageInfo.queueFamilyIndexCount = static_cast<uint32_t>(families.size());
+		imageInfo.pQueueFamilyIndices = families.data();
+	} else {
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	}
+
+	Check(device.Dispatch().vkCreateImage(device.Handle(), &imageInfo, device.Allocator(), &image_), "create image");
+
+	VkMemoryRequirements requirements;
+	device.Dispatch().vkGetImageMemoryRequirements(device.Handle(), image_, &requirements);
+
+	memory_.reset(new DeviceMemory(device, requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, tag));
+
+	Check(device.Dispatch().vkBindImageMemory(device.Handle(), image_, memory_->Handle(), 0), "bind image memory");
+}
+
+Image::~Image() {
+	if (image_ != nullptr) {
+		device_.Dispatch().vkDestroyImage(device_.Handle(), image_, device_.Allocator());
+		image_ = nullptr;
+	}
+
+	memory_.reset();
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include "DeviceMemory.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace Vulkan {
+	class Device;
+
+	// A 2D optimal tiling image bound to its own device local memory allocation.
+	class Image final {
+	public:
+
+		VULKAN_NON_COPIABLE(Image)
+
+		// Images used by several queue families are shared concurrently, no ownership transfer is needed
+		Image(const Device& device, VkExtent2D extent, uint32_t mipLevels, VkFormat format, VkImageUsageFlags usage, const std::vector<uint32_t>& queueFamilyIndices, const char* tag);
+		~Image();
+
+		const class Device& Device() const { return device_; }
+		VkExtent2D Extent() const { return extent_; }
+		uint32_t MipLevels() const { return mipLevels_; }
+		VkFormat Format() const { return format_; }
+		const DeviceMemory& Memory() const { return *memory_; }
+
+	private:
+
+		const class Device& device_;
+		const VkExtent2D extent_;
+		const uint32_t mipLevels_;
+		const VkFormat format_;
+
+		VULKAN_HANDLE(VkImage, image_)
+
+		std::unique_ptr<DeviceMemory> memory_;
+	};
+
+}
@@ -3,7 +3,7 @@
 
 namespace Vulkan {
 
-ImageView::ImageView(const class Device& device, const VkImage image, const VkFormat format, const VkImageAspectFlags aspectFlags) :
+ImageView::ImageView(const class Device& device, const VkImage image, const VkFormat format, const VkImageAspectFlags aspectFlags, const uint32_t mipLevel, const uint32_t levelCount) :
 	device_(device),
 	image_(image),
 	format_(format)
@@ -18,18 +18,18 @@ ImageView::ImageView(const class Device& device, const VkImage image, const VkFo
 	createInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
 	createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
 	createInfo.subresourceRange.aspectMask = aspectFlags;
-	createInfo.subresourceRange.baseMipLevel = 0;
-	createInfo.subresourceRange.levelCount = 1;
+	createInfo.subresourceRange.baseMipLevel = mipLevel;
+	createInfo.subresourceRange.levelCount = levelCount;
 	createInfo.subresourceRange.baseArrayLayer = 0;
 	createInfo.subresourceRange.layerCount = 1;
 
-	Check(vkCreateImageView(device_.Handle(), &createInfo, nullptr, &imageView_), "create image view");
+	Check(device_.Dispatch().vkCreateImageView(device_.Handle(), &createInfo, device_.Allocator(), &imageView_), "create image view");
 }
 
 ImageView::~ImageView()
 {
 	if (imageView_ != nullptr) {
-		vkDestroyImageView(device_.Handle(), imageView_, nullptr);
+		device_.Dispatch().vkDestroyImageView(device_.Handle(), imageView_, device_.Allocator());
 		imageView_ = nullptr;
 	}
 }
@@ -10,7 +10,8 @@ namespace Vulkan {
 
 		VULKAN_NON_COPIABLE(ImageView)
 
-		explicit ImageView(const Device& device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+		// Views a single mip level by default
+		explicit ImageView(const Device& device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevel = 0, uint32_t levelCount = 1);
 		~ImageView();
 
 		const class Device& Device() const { return device_; }
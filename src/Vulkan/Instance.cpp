@@ -9,14 +9,24 @@
 
 namespace Vulkan {
 
-    Instance::Instance(const char* applicationName, const class Window& window, const std::vector<const char*>& validationLayers) :
+    Instance::Instance(const char* applicationName, const class Window& window, const std::vector<const char*>& validationLayers, const VkAllocationCallbacks* const allocator) :
         window_(window),
+        allocator_(allocator),
         validationLayers_(validationLayers)
     {
         // Check the minimum version.
-        const uint32_t version = VK_API_VERSION_1_1;
+        CheckVulkanMinimumVersion(VK_API_VERSION_1_1);
 
-        CheckVulkanMinimumVersion(version);
+        // Ask for the newest version we know of that the loader supports, so newer device features can be queried
+        uint32_t loaderVersion;
+        Check(vkEnumerateInstanceVersion(&loaderVersion), "query instance version");
+
+#ifdef VK_API_VERSION_1_3
+        const uint32_t maxVersion = VK_API_VERSION_1_3;
+#else
+        const uint32_t maxVersion = VK_API_VERSION_1_2;
+#endif
+        apiVersion_ = std::min(VK_MAKE_VERSION(VK_VERSION_MAJOR(loaderVersion), VK_VERSION_MINOR(loaderVersion), 0), maxVersion);
 
         // Get the list of required extensions.
         auto extensions = window.GetRequiredInstanceExtensions();
@@ -34,7 +44,7 @@ namespace Vulkan {
         appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
         appInfo.pEngineName = "No Engine";
         appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-        appInfo.apiVersion = version;
+        appInfo.apiVersion = apiVersion_;
 
         VkInstanceCreateInfo createInfo = {};
         createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -44,7 +54,7 @@ namespace Vulkan {
         createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
         createInfo.ppEnabledLayerNames = validationLayers.data();
 
-        Check(vkCreateInstance(&createInfo, nullptr, &instance_), "create instance");
+        Check(vkCreateInstance(&createInfo, allocator_, &instance_), "create instance");
 
         GetVulkanDevices();
         GetVulkanExtensions();
@@ -53,7 +63,7 @@ namespace Vulkan {
 
     Instance::~Instance() {
         if (instance_ != nullptr) {
-            vkDestroyInstance(instance_, nullptr);
+            vkDestroyInstance(instance_, allocator_);
             instance_ = nullptr;
         }
     }
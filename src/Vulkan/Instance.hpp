@@ -11,10 +11,13 @@ namespace Vulkan {
 
 		VULKAN_NON_COPIABLE(Instance)
 
-		Instance(const char* applicationName, const Window& window, const std::vector<const char*>& validationLayers);
+		// A null allocator lets the driver use its own host memory allocations
+		Instance(const char* applicationName, const Window& window, const std::vector<const char*>& validationLayers, const VkAllocationCallbacks* allocator);
 		~Instance();
 
 		const class Window& Window() const { return window_; }
+		uint32_t ApiVersion() const { return apiVersion_; }
+		const VkAllocationCallbacks* Allocator() const { return allocator_; }
 
 		const std::vector<VkExtensionProperties>& Extensions() const { return extensions_; }
 		const std::vector<VkPhysicalDevice>& PhysicalDevices() const { return physicalDevices_; }
@@ -30,6 +33,8 @@ namespace Vulkan {
 		void CheckVulkanInstanceExtensionsSupport();
 
 		const class Window& window_;
+		const VkAllocationCallbacks* const allocator_;
+		uint32_t apiVersion_{};
 
 		VULKAN_HANDLE(VkInstance, instance_)
 
@@ -0,0 +1,200 @@
+#include "LodMesh.hpp"
+
+#include "Buffer.hpp"
+#include "ClusteredLighting.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+#include "FrameStats.hpp"
+#include "GraphicsPipeline.hpp"
+#include "PipelineCompiler.hpp"
+#include "PipelineLayout.hpp"
+#include "PipelineState.hpp"
+#include "PipelineVariants.hpp"
+#include "ShaderModule.hpp"
+#include "../Utilities/Log.hpp"
+#include "../Utilities/Model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace Vulkan {
+
+LodMesh::LodMesh(
+	const Device& device,
+	PipelineCompiler& pipelineCompiler,
+	const RenderPass* const renderPass,
+	const VkFormat colorFormat,
+	const VkFormat depthFormat,
+	const uint32_t frameCount,
+	const uint32_t maxInstances,
+	const Utilities::Model& model,
+	const ClusteredLighting& lighting) :
+	device_(device),
+	lighting_(lighting),
+	maxInstances_(maxInstances),
+	frameSize_(VkDeviceSize(maxInstances) * sizeof(Instance)),
+	center_{ model.Center()[0], model.Center()[1], model.Center()[2] },
+	radius_(model.Radius())
+{
+	for (const auto& lod : model.Lods()) {
+		lods_.push_back({ lod.FirstIndex, lod.IndexCount, lod.Error });
+	}
+
+	lodInstanceCounts_.assign(lods_.size(), 0);
+
+	pipelineLayout_.reset(new PipelineLayout(device, { lighting.SetLayout().Handle() }, { { VK_SHADER_STAGE_VERTEX_BIT, 0, 16 * sizeof(float) } }));
+
+	// Vertices per vertex, position and scale then color per instance
+	VertexInput vertexInput;
+	vertexInput.Bindings =
+	{
+		{ 0, sizeof(Utilities::Model::Vertex), VK_VERTEX_INPUT_RATE_VERTEX },
+		{ 1, sizeof(Instance), VK_VERTEX_INPUT_RATE_INSTANCE }
+	};
+	vertexInput.Attributes =
+	{
+		{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Utilities::Model::Vertex, Position) },
+		{ 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Utilities::Model::Vertex, Normal) },
+		{ 2, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(Instance, Position) },
+		{ 3, 1, VK_FORMAT_R8G8B8A8_UNORM, offsetof(Instance, Color) }
+	};
+
+	pipelines_.reset(new PipelineVariants(
+		device, pipelineCompiler, "mesh", *pipelineLayout_, renderPass, colorFormat, depthFormat,
+		ShaderModule::ReadFile("../assets/shaders/mesh.vert.spv"), ShaderModule::ReadFile("../assets/shaders/mesh.frag.spv"), vertexInput));
+
+	pipelines_->Prewarm({ PipelineState().WithDepthTest(true) }, {
+		ShaderVariant().With(LightingModel::Directional),
+		ShaderVariant().With(LightingModel::Clustered)
+	});
+
+	// Host writes go straight to device local memory when the device exposes it to the host (resizable BAR, integrated GPUs)
+	const auto hostMemory = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+	const auto& vertices = model.Vertices();
+	const VkDeviceSize verticesSize = vertices.size() * sizeof(Utilities::Model::Vertex);
+	vertexBuffer_.reset(new Buffer(device, verticesSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, hostMemory, "mesh vertices", VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+	std::memcpy(vertexBuffer_->Memory().Map(0, VK_WHOLE_SIZE), vertices.data(), verticesSize);
+	vertexBuffer_->Memory().Unmap();
+
+	// The index lists of every level follow each other
+	const auto& indices = model.Indices();
+	const VkDeviceSize indicesSize = indices.size() * sizeof(uint32_t);
+	indexBuffer_.reset(new Buffer(device, indicesSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, hostMemory, "mesh indices", VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+	std::memcpy(indexBuffer_->Memory().Map(0, VK_WHOLE_SIZE), indices.data(), indicesSize);
+	indexBuffer_->Memory().Unmap();
+
+	instanceBuffer_.reset(new Buffer(device, frameSize_ * frameCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, hostMemory, "mesh instances", VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+	instances_ = static_cast<unsigned char*>(instanceBuffer_->Memory().Map(0, VK_WHOLE_SIZE));
+}
+
+LodMesh::~LodMesh() {
+	instanceBuffer_.reset();
+	indexBuffer_.reset();
+	vertexBuffer_.reset();
+	pipelines_.reset();
+	pipelineLayout_.reset();
+}
+
+void LodMesh::Draw(const Instance& instance) {
+	queued_.push_back(instance);
+}
+
+uint32_t LodMesh::SelectLod(const Instance& instance, const std::array<float, 16>& viewProjection, const float pixelScale) const {
+	const float center[3] =
+	{
+		instance.Position[0] + instance.Scale * center_[0],
+		instance.Position[1] + instance.Scale * center_[1],
+		instance.Position[2] + instance.Scale * center_[2]
+	};
+
+	// Clip space w of the bounding sphere center, the view distance for a perspective projection
+	const float w = viewProjection[3] * center[0] + viewProjection[7] * center[1] + viewProjection[11] * center[2] + viewProjection[15];
+
+	// Full detail as soon as the camera is within the bounding sphere, the projected size is meaningless there
+	if (w <= instance.Scale * radius_)
+		return 0;
+
+	const float pixelsPerUnit = pixelScale / w;
+	uint32_t lod = 0;
+
+	while (lod + 1 != lods_.size() && lods_[lod + 1].Error * instance.Scale * pixelsPerUnit <= errorThreshold_) {
+		++lod;
+	}
+
+	return lod;
+}
+
+void LodMesh::Render(VkCommandBuffer commandBuffer, const uint32_t frame, const std::array<float, 16>& viewProjection, const VkExtent2D extent, FrameStats& frameStats) {
+	std::fill(lodInstanceCounts_.begin(), lodInstanceCounts_.end(), 0);
+
+	if (queued_.empty())
+		return;
+
+	const auto count = static_cast<uint32_t>(std::min<size_t>(queued_.size(), maxInstances_));
+
+	if (count != queued_.size() && !reportedDrop_) {
+		LOG_WARNING("[mesh] {} instances dropped, the mesh holds {} per frame", queued_.size() - count, maxInstances_);
+		reportedDrop_ = true;
+	}
+
+	// Model units to pixels at unit distance: the length of the clip space y row, which holds the focal length
+	// for any camera rotation, over half the viewport height
+	const float focal = std::sqrt(viewProjection[1] * viewProjection[1] + viewProjection[5] * viewProjection[5] + viewProjection[9] * viewProjection[9]);
+	const float pixelScale = focal * 0.5f * static_cast<float>(extent.height);
+
+	queuedLods_.resize(count);
+	for (uint32_t i = 0; i != count; ++i) {
+		queuedLods_[i] = SelectLod(queued_[i], viewProjection, pixelScale);
+		++lodInstanceCounts_[queuedLods_[i]];
+	}
+
+	// Counting sort by level, every level is then a contiguous range of instances
+	std::vector<uint32_t> firstInstances(lods_.size(), 0);
+	for (size_t lod = 1; lod != lods_.size(); ++lod) {
+		firstInstances[lod] = firstInstances[lod - 1] + lodInstanceCounts_[lod - 1];
+	}
+
+	sorted_.resize(count);
+	{
+		auto next = firstInstances;
+		for (uint32_t i = 0; i != count; ++i) {
+			sorted_[next[queuedLods_[i]]++] = queued_[i];
+		}
+	}
+
+	// The region of this frame is free, its previous submission completed before the command buffer was reused
+	const VkDeviceSize frameOffset = frame * frameSize_;
+	std::memcpy(instances_ + frameOffset, sorted_.data(), size_t(count) * sizeof(Instance));
+
+	const auto& dispatch = device_.Dispatch();
+
+	const auto lightingModel = lighting_.LightCount() != 0 ? LightingModel::Clustered : LightingModel::Directional;
+	const auto& pipeline = pipelines_->Get(PipelineState().WithDepthTest(true), ShaderVariant().With(lightingModel));
+
+	const VkBuffer vertexBuffers[2] = { vertexBuffer_->Handle(), instanceBuffer_->Handle() };
+	const VkDeviceSize offsets[2] = { 0, frameOffset };
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.Handle());
+	dispatch.vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+	dispatch.vkCmdBindIndexBuffer(commandBuffer, indexBuffer_->Handle(), 0, VK_INDEX_TYPE_UINT32);
+
+	const VkDescriptorSet descriptorSet = lighting_.DescriptorSet();
+	const auto& dynamicOffsets = lighting_.DynamicOffsets();
+	dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout_->Handle(), 0, 1, &descriptorSet, static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+	dispatch.vkCmdPushConstants(commandBuffer, pipelineLayout_->Handle(), VK_SHADER_STAGE_VERTEX_BIT, 0, 16 * sizeof(float), viewProjection.data());
+
+	for (size_t lod = 0; lod != lods_.size(); ++lod) {
+		const uint32_t instanceCount = lodInstanceCounts_[lod];
+
+		if (instanceCount != 0) {
+			dispatch.vkCmdDrawIndexed(commandBuffer, lods_[lod].IndexCount, instanceCount, lods_[lod].FirstIndex, 0, firstInstances[lod]);
+			frameStats.RecordDraw(lods_[lod].IndexCount / 3 * instanceCount);
+		}
+	}
+
+	queued_.clear();
+}
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace Utilities {
+	class Model;
+}
+
+namespace Vulkan {
+	class Buffer;
+	class ClusteredLighting;
+	class Device;
+	class FrameStats;
+	class PipelineCompiler;
+	class PipelineLayout;
+	class PipelineVariants;
+	class RenderPass;
+
+	// Instances of a model drawn at the level of detail their projected size calls for.
+	// All levels share one vertex buffer and one index buffer, an instance picks the coarsest level whose
+	// error stays under a pixel on screen. Instances are grouped per level and every level is a single
+	// instanced draw; instance data is copied into a persistently mapped ring, one region per frame in flight.
+	// Instances are lit by the clustered lights assigned for the frame.
+	class LodMesh final {
+	public:
+
+		struct Instance {
+			float Position[3];
+			float Scale;
+			// Packed as 0xAABBGGRR
+			uint32_t Color;
+		};
+
+		VULKAN_NON_COPIABLE(LodMesh)
+
+		LodMesh(const Device& device, PipelineCompiler& pipelineCompiler, const RenderPass* renderPass, VkFormat colorFormat, VkFormat depthFormat, uint32_t frameCount, uint32_t maxInstances, const Utilities::Model& model, const ClusteredLighting& lighting);
+		~LodMesh();
+
+		uint32_t MaxInstances() const { return maxInstances_; }
+		uint32_t LodCount() const { return static_cast<uint32_t>(lods_.size()); }
+		// Bounding sphere radius of the model, at unit scale
+		float Radius() const { return radius_; }
+
+		// Screen space error allowed when picking a level, in pixels
+		void SetErrorThreshold(const float pixels) { errorThreshold_ = pixels; }
+
+		void Draw(const Instance& instance);
+
+		// Draw and clear the queued instances with depth testing, within the scene rendering once its viewport is set.
+		// The view projection is column major. Instances past MaxInstances are dropped.
+		void Render(VkCommandBuffer commandBuffer, uint32_t frame, const std::array<float, 16>& viewProjection, VkExtent2D extent, FrameStats& frameStats);
+
+		// Instances drawn at every level by the last Render
+		const std::vector<uint32_t>& LodInstanceCounts() const { return lodInstanceCounts_; }
+
+	private:
+
+		struct Lod {
+			uint32_t FirstIndex;
+			uint32_t IndexCount;
+			float Error;
+		};
+
+		uint32_t SelectLod(const Instance& instance, const std::array<float, 16>& viewProjection, float pixelScale) const;
+
+		const Device& device_;
+		const ClusteredLighting& lighting_;
+		const uint32_t maxInstances_;
+		const VkDeviceSize frameSize_;
+		// Bounding sphere of the model
+		float center_[3];
+		const float radius_;
+		float errorThreshold_{ 1.0f };
+
+		std::vector<Lod> lods_;
+
+		std::unique_ptr<PipelineLayout> pipelineLayout_;
+		// Directional and clustered lighting variants, the cheaper one when no light was assigned
+		std::unique_ptr<PipelineVariants> pipelines_;
+
+		std::unique_ptr<Buffer> vertexBuffer_;
+		std::unique_ptr<Buffer> indexBuffer_;
+		std::unique_ptr<Buffer> instanceBuffer_;
+		unsigned char* instances_{};
+
+		// Queued instances, then the same sorted by level before the copy
+		std::vector<Instance> queued_;
+		std::vector<Instance> sorted_;
+		std::vector<uint32_t> queuedLods_;
+		std::vector<uint32_t> lodInstanceCounts_;
+		bool reportedDrop_{};
+	};
+
+}
@@ -0,0 +1,128 @@
+#include "MemoryStatistics.hpp"
+
+#include "Device.hpp"
+#include "../Utilities/Log.hpp"
+
+#include <algorithm>
+
+namespace Vulkan {
+
+	namespace {
+		double ToMegabytes(const VkDeviceSize size) {
+			return static_cast<double>(size) / (1024.0 * 1024.0);
+		}
+	}
+
+MemoryStatistics::MemoryStatistics(const class Device& device) :
+	device_(device),
+	budgetAvailable_(device.IsMemoryBudgetEnabled())
+{
+	vkGetPhysicalDeviceMemoryProperties(device.PhysicalDevice(), &memoryProperties_);
+
+	heaps_.resize(memoryProperties_.memoryHeapCount);
+	types_.resize(memoryProperties_.memoryTypeCount);
+
+	for (uint32_t i = 0; i != memoryProperties_.memoryHeapCount; ++i) {
+		heaps_[i].Size = memoryProperties_.memoryHeaps[i].size;
+		heaps_[i].DeviceLocal = (memoryProperties_.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+	}
+
+	UpdateBudget();
+}
+
+void MemoryStatistics::OnAllocate(const uint32_t memoryTypeIndex, const VkDeviceSize size, const char* const tag) {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto& heap = heaps_[memoryProperties_.memoryTypes[memoryTypeIndex].heapIndex];
+	heap.Allocated += size;
+	heap.Peak = std::max(heap.Peak, heap.Allocated);
+	++heap.AllocationCount;
+
+	auto& type = types_[memoryTypeIndex];
+	type.Allocated += size;
+	++type.AllocationCount;
+
+	auto& owner = tags_[tag];
+	owner.Allocated += size;
+	owner.Peak = std::max(owner.Peak, owner.Allocated);
+	++owner.AllocationCount;
+}
+
+void MemoryStatistics::OnFree(const uint32_t memoryTypeIndex, const VkDeviceSize size, const char* const tag) {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto& heap = heaps_[memoryProperties_.memoryTypes[memoryTypeIndex].heapIndex];
+	heap.Allocated -= size;
+	--heap.AllocationCount;
+
+	auto& type = types_[memoryTypeIndex];
+	type.Allocated -= size;
+	--type.AllocationCount;
+
+	auto& owner = tags_[tag];
+	owner.Allocated -= size;
+	--owner.AllocationCount;
+}
+
+void MemoryStatistics::UpdateBudget() {
+	if (!budgetAvailable_)
+		return;
+
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = {};
+	budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+	VkPhysicalDeviceMemoryProperties2 properties = {};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+	properties.pNext = &budget;
+
+	vkGetPhysicalDeviceMemoryProperties2(device_.PhysicalDevice(), &properties);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	for (uint32_t i = 0; i != memoryProperties_.memoryHeapCount; ++i) {
+		heaps_[i].Usage = budget.heapUsage[i];
+		heaps_[i].Budget = budget.heapBudget[i];
+	}
+}
+
+std::vector<MemoryStatistics::HeapUsage> MemoryStatistics::Heaps() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return heaps_;
+}
+
+std::vector<MemoryStatistics::TypeUsage> MemoryStatistics::Types() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return types_;
+}
+
+std::map<std::string, MemoryStatistics::TagUsage> MemoryStatistics::Tags() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return tags_;
+}
+
+void MemoryStatistics::Report() const {
+	const auto heaps = Heaps();
+
+	for (size_t i = 0; i != heaps.size(); ++i) {
+		const auto& heap = heaps[i];
+
+		if (budgetAvailable_) {
+			LOG_INFO("Memory heap {} ({}): {} MB in {} allocations (peak {} MB), process usage {} / {} MB budget",
+				i, heap.DeviceLocal ? "device" : "host",
+				ToMegabytes(heap.Allocated), heap.AllocationCount, ToMegabytes(heap.Peak),
+				ToMegabytes(heap.Usage), ToMegabytes(heap.Budget));
+		}
+		else {
+			LOG_INFO("Memory heap {} ({}): {} MB in {} allocations (peak {} MB) of {} MB",
+				i, heap.DeviceLocal ? "device" : "host",
+				ToMegabytes(heap.Allocated), heap.AllocationCount, ToMegabytes(heap.Peak),
+				ToMegabytes(heap.Size));
+		}
+
+		// Usage above the budget means the driver is about to page or fail allocations
+		if (budgetAvailable_ && heap.Usage > heap.Budget)
+			LOG_WARNING("Memory heap {} is over budget by {} MB", i, ToMegabytes(heap.Usage - heap.Budget));
+	}
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Vulkan {
+	class Device;
+
+	// Device memory allocated by the framework, per heap, memory type and owner tag.
+	// With VK_EXT_memory_budget, heaps also report the process wide usage and budget from the driver.
+	class MemoryStatistics final {
+	public:
+
+		struct HeapUsage {
+			VkDeviceSize Size{};
+			bool DeviceLocal{};
+			VkDeviceSize Allocated{};
+			VkDeviceSize Peak{};
+			uint32_t AllocationCount{};
+			// Zero when VK_EXT_memory_budget is not enabled
+			VkDeviceSize Usage{};
+			VkDeviceSize Budget{};
+		};
+
+		struct TypeUsage {
+			VkDeviceSize Allocated{};
+			uint32_t AllocationCount{};
+		};
+
+		struct TagUsage {
+			VkDeviceSize Allocated{};
+			VkDeviceSize Peak{};
+			uint32_t AllocationCount{};
+		};
+
+		VULKAN_NON_COPIABLE(MemoryStatistics)
+
+		explicit MemoryStatistics(const Device& device);
+		~MemoryStatistics() = default;
+
+		bool IsBudgetAvailable() const { return budgetAvailable_; }
+
+		// Any thread
+		void OnAllocate(uint32_t memoryTypeIndex, VkDeviceSize size, const char* tag);
+		void OnFree(uint32_t memoryTypeIndex, VkDeviceSize size, const char* tag);
+
+		// Query the driver usage and budget again
+		void UpdateBudget();
+
+		std::vector<HeapUsage> Heaps() const;
+		std::vector<TypeUsage> Types() const;
+		std::map<std::string, TagUsage> Tags() const;
+
+		// Log one line per heap
+		void Report() const;
+
+	private:
+
+		const class Device& device_;
+		const bool budgetAvailable_;
+
+		VkPhysicalDeviceMemoryProperties memoryProperties_{};
+
+		mutable std::mutex mutex_;
+		std::vector<HeapUsage> heaps_;
+		std::vector<TypeUsage> types_;
+		std::map<std::string, TagUsage> tags_;
+	};
+
+}
@@ -0,0 +1,395 @@
+#include "OcclusionCulling.hpp"
+
+#include "Buffer.hpp"
+#include "ClusteredLighting.hpp"
+#include "ComputePipeline.hpp"
+#include "DepthBuffer.hpp"
+#include "DescriptorPool.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+#include "FrameStats.hpp"
+#include "GraphicsPipeline.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+#include "PipelineCompiler.hpp"
+#include "PipelineLayout.hpp"
+#include "PipelineState.hpp"
+#include "PipelineVariants.hpp"
+#include "Sampler.hpp"
+#include "ShaderModule.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Vulkan {
+
+	namespace {
+		constexpr uint32_t CullGroupSize = 64;
+		constexpr uint32_t PyramidGroupSize = 8;
+		constexpr uint32_t VerticesPerBox = 36;
+		constexpr VkFormat PyramidFormat = VK_FORMAT_R32_SFLOAT;
+
+		// One draw per phase, written by the culling shader
+		constexpr VkDeviceSize DrawSize = 4 * sizeof(uint32_t);
+
+		enum Binding : uint32_t {
+			Boxes,
+			Visibility,
+			Draws,
+			Lists,
+			Pyramid,
+			BindingCount
+		};
+
+		uint32_t FloorPowerOfTwo(const uint32_t value) {
+			uint32_t power = 1;
+			while (power * 2 <= value) {
+				power *= 2;
+			}
+
+			return power;
+		}
+
+		VkWriteDescriptorSet Write(const VkDescriptorSet set, const uint32_t binding, const VkDescriptorType type) {
+			VkWriteDescriptorSet write = {};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = set;
+			write.dstBinding = binding;
+			write.descriptorCount = 1;
+			write.descriptorType = type;
+			return write;
+		}
+
+		VkImageMemoryBarrier DepthBarrier(const VkImage image, const VkImageLayout oldLayout, const VkImageLayout newLayout, const VkAccessFlags srcAccess, const VkAccessFlags dstAccess) {
+			VkImageMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstAccessMask = dstAccess;
+			barrier.oldLayout = oldLayout;
+			barrier.newLayout = newLayout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image;
+			barrier.subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+			return barrier;
+		}
+	}
+
+OcclusionCulling::OcclusionCulling(
+	const Device& device,
+	PipelineCompiler& pipelineCompiler,
+	const DepthBuffer& depthBuffer,
+	const ClusteredLighting& lighting,
+	const RenderPass* const renderPass,
+	const VkFormat colorFormat,
+	const uint32_t frameCount,
+	const std::vector<Box>& boxes) :
+	device_(device),
+	depthBuffer_(depthBuffer),
+	lighting_(lighting),
+	objectCount_(static_cast<uint32_t>(boxes.size()))
+{
+	if (boxes.empty())
+		throw std::invalid_argument("occlusion culling needs at least one box");
+
+	const auto storage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	const auto deviceLocal = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	const auto hostMemory = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+	// Written once, straight into device local memory when the host can see it
+	const VkDeviceSize boxesSize = boxes.size() * sizeof(Box);
+	boxes_.reset(new Buffer(device, boxesSize, storage, hostMemory, "occlusion culling boxes", deviceLocal));
+	std::memcpy(boxes_->Memory().Map(0, VK_WHOLE_SIZE), boxes.data(), boxesSize);
+	boxes_->Memory().Unmap();
+
+	visibility_.reset(new Buffer(device, objectCount_ * sizeof(uint32_t), storage, deviceLocal, "occlusion culling visibility"));
+	draws_.reset(new Buffer(device, 2 * DrawSize, storage | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, deviceLocal, "occlusion culling draws"));
+	lists_.reset(new Buffer(device, 2 * objectCount_ * sizeof(uint32_t), storage, deviceLocal, "occlusion culling visible lists"));
+
+	readback_.reset(new Buffer(device, frameCount * 2 * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT, hostMemory, "occlusion culling readback"));
+	auto* const readbackData = static_cast<uint32_t*>(readback_->Memory().Map(0, VK_WHOLE_SIZE));
+	std::fill_n(readbackData, frameCount * 2, 0u);
+	readbackData_ = readbackData;
+
+	// Level 0 is at most the depth buffer size, so every texel footprint there covers at least one depth sample
+	const auto extent = depthBuffer.Extent();
+	VkExtent2D levelExtent = { FloorPowerOfTwo(extent.width), FloorPowerOfTwo(extent.height) };
+	levelExtents_.push_back(levelExtent);
+
+	while (levelExtent.width != 1 || levelExtent.height != 1) {
+		levelExtent = { std::max(levelExtent.width / 2, 1u), std::max(levelExtent.height / 2, 1u) };
+		levelExtents_.push_back(levelExtent);
+	}
+
+	const auto levelCount = static_cast<uint32_t>(levelExtents_.size());
+
+	pyramid_.reset(new Image(
+		device, levelExtents_[0], levelCount, PyramidFormat, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		{ device.GraphicsFamilyIndex() }, "depth pyramid"));
+	pyramidView_.reset(new ImageView(device, pyramid_->Handle(), PyramidFormat, VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount));
+
+	for (uint32_t level = 0; level != levelCount; ++level) {
+		levelViews_.push_back(std::make_unique<ImageView>(device, pyramid_->Handle(), PyramidFormat, VK_IMAGE_ASPECT_COLOR_BIT, level));
+	}
+
+	sampler_.reset(new Sampler(device, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE));
+
+	std::vector<VkDescriptorSetLayoutBinding> cullBindings;
+	for (uint32_t binding = 0; binding != BindingCount; ++binding) {
+		const VkShaderStageFlags stages = binding == Boxes || binding == Lists
+			? VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT
+			: VK_SHADER_STAGE_COMPUTE_BIT;
+		const auto type = binding == Pyramid ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		cullBindings.push_back({ binding, type, 1, stages, nullptr });
+	}
+
+	cullSetLayout_.reset(new DescriptorSetLayout(device, cullBindings));
+	pyramidSetLayout_.reset(new DescriptorSetLayout(device, {
+		{ 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+		{ 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr }
+	}));
+
+	descriptorPool_.reset(new DescriptorPool(device, {
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, BindingCount - 1 },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, levelCount + 1 },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, levelCount }
+	}, levelCount + 1, 0));
+
+	cullSet_ = descriptorPool_->Allocate(*cullSetLayout_, 1)[0];
+	pyramidSets_ = descriptorPool_->Allocate(*pyramidSetLayout_, levelCount);
+
+	// Infos must stay in place until the update, every write points to one
+	const VkDescriptorBufferInfo bufferInfos[] = {
+		{ boxes_->Handle(), 0, VK_WHOLE_SIZE },
+		{ visibility_->Handle(), 0, VK_WHOLE_SIZE },
+		{ draws_->Handle(), 0, VK_WHOLE_SIZE },
+		{ lists_->Handle(), 0, VK_WHOLE_SIZE }
+	};
+
+	// The depth buffer is sampled while it is read only, the pyramid always stays in the general layout
+	std::vector<VkDescriptorImageInfo> imageInfos;
+	imageInfos.reserve(2 * levelCount + 1);
+	std::vector<VkWriteDescriptorSet> writes;
+
+	for (uint32_t binding = 0; binding != Pyramid; ++binding) {
+		writes.push_back(Write(cullSet_, binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER));
+		writes.back().pBufferInfo = &bufferInfos[binding];
+	}
+
+	imageInfos.push_back({ sampler_->Handle(), pyramidView_->Handle(), VK_IMAGE_LAYOUT_GENERAL });
+	writes.push_back(Write(cullSet_, Pyramid, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER));
+	writes.back().pImageInfo = &imageInfos.back();
+
+	for (uint32_t level = 0; level != levelCount; ++level) {
+		imageInfos.push_back(level == 0
+			? VkDescriptorImageInfo{ sampler_->Handle(), depthBuffer.ImageView().Handle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }
+			: VkDescriptorImageInfo{ sampler_->Handle(), levelViews_[level - 1]->Handle(), VK_IMAGE_LAYOUT_GENERAL });
+		writes.push_back(Write(pyramidSets_[level], 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER));
+		writes.back().pImageInfo = &imageInfos.back();
+
+		imageInfos.push_back({ VK_NULL_HANDLE, levelViews_[level]->Handle(), VK_IMAGE_LAYOUT_GENERAL });
+		writes.push_back(Write(pyramidSets_[level], 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE));
+		writes.back().pImageInfo = &imageInfos.back();
+	}
+
+	device.Dispatch().vkUpdateDescriptorSets(device.Handle(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+	cullPipelineLayout_.reset(new PipelineLayout(device, { cullSetLayout_->Handle() }, { { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants) } }));
+	pyramidPipelineLayout_.reset(new PipelineLayout(device, { pyramidSetLayout_->Handle() }, { { VK_SHADER_STAGE_COMPUTE_BIT, 0, 4 * sizeof(int32_t) } }));
+	drawPipelineLayout_.reset(new PipelineLayout(device, { cullSetLayout_->Handle(), lighting.SetLayout().Handle() }, { { VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawConstants) } }));
+
+	{
+		const ShaderModule cull(device, "../assets/shaders/occlusion_cull.comp.spv");
+		const ShaderModule pyramid(device, "../assets/shaders/depth_pyramid.comp.spv");
+
+		cullPipeline_.reset(new ComputePipeline(device, pipelineCompiler.Cache(), *cullPipelineLayout_, cull));
+		pyramidPipeline_.reset(new ComputePipeline(device, pipelineCompiler.Cache(), *pyramidPipelineLayout_, pyramid));
+	}
+
+	// Vertices are pulled from the boxes through the visible lists, there is no vertex input
+	drawPipelines_.reset(new PipelineVariants(
+		device, pipelineCompiler, "box", *drawPipelineLayout_, renderPass, colorFormat, DepthBuffer::Format,
+		ShaderModule::ReadFile("../assets/shaders/box.vert.spv"), ShaderModule::ReadFile("../assets/shaders/box.frag.spv")));
+
+	drawPipelines_->Prewarm({ PipelineState().WithDepthTest(true) }, {
+		ShaderVariant().With(LightingModel::Directional),
+		ShaderVariant().With(LightingModel::Clustered)
+	});
+}
+
+OcclusionCulling::~OcclusionCulling() {
+	drawPipelines_.reset();
+	pyramidPipeline_.reset();
+	cullPipeline_.reset();
+	drawPipelineLayout_.reset();
+	pyramidPipelineLayout_.reset();
+	cullPipelineLayout_.reset();
+	descriptorPool_.reset();
+	pyramidSetLayout_.reset();
+	cullSetLayout_.reset();
+	sampler_.reset();
+	levelViews_.clear();
+	pyramidView_.reset();
+	pyramid_.reset();
+	readback_.reset();
+	lists_.reset();
+	draws_.reset();
+	visibility_.reset();
+	boxes_.reset();
+}
+
+void OcclusionCulling::Cull(VkCommandBuffer commandBuffer, const uint32_t phase, const std::array<float, 16>& viewProjection) {
+	const auto& dispatch = device_.Dispatch();
+	const VkDeviceSize drawOffset = phase * DrawSize;
+
+	// The previous frame draws are done with the lists and the arguments before they are overwritten
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		0, nullptr, 0, nullptr, 0, nullptr);
+
+	// No vertices, one instance
+	dispatch.vkCmdFillBuffer(commandBuffer, draws_->Handle(), drawOffset, DrawSize, 0);
+	dispatch.vkCmdFillBuffer(commandBuffer, draws_->Handle(), drawOffset + sizeof(uint32_t), sizeof(uint32_t), 1);
+
+	VkMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	dispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+	// The pyramid content is discarded until it is first built, everything passes the occlusion test meanwhile
+	if (!pyramidValid_ && phase == 0) {
+		VkImageMemoryBarrier toGeneral = {};
+		toGeneral.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		toGeneral.srcAccessMask = 0;
+		toGeneral.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		toGeneral.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		toGeneral.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		toGeneral.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toGeneral.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toGeneral.image = pyramid_->Handle();
+		toGeneral.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, pyramid_->MipLevels(), 0, 1 };
+
+		dispatch.vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+			0, nullptr, 0, nullptr, 1, &toGeneral);
+	}
+
+	CullConstants constants = {};
+	std::copy(viewProjection.begin(), viewProjection.end(), constants.ViewProjection);
+	constants.ObjectCount = objectCount_;
+	constants.Phase = phase;
+	constants.PyramidValid = pyramidValid_ ? 1 : 0;
+
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline_->Handle());
+	dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout_->Handle(), 0, 1, &cullSet_, 0, nullptr);
+	dispatch.vkCmdPushConstants(commandBuffer, cullPipelineLayout_->Handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+	dispatch.vkCmdDispatch(commandBuffer, (objectCount_ + CullGroupSize - 1) / CullGroupSize, 1, 1);
+
+	// Read by the draw, and the visibility flags by the second phase
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void OcclusionCulling::BuildPyramid(VkCommandBuffer commandBuffer) {
+	const auto& dispatch = device_.Dispatch();
+
+	// The first phase depth is sampled, and the pyramid is no longer read by the first phase culling
+	const auto toRead = DepthBarrier(depthBuffer_.Image(),
+		VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toRead);
+
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pyramidPipeline_->Handle());
+
+	// Each level reads the one its previous dispatch wrote
+	VkMemoryBarrier levelBarrier = {};
+	levelBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	for (size_t level = 0; level != levelExtents_.size(); ++level) {
+		const auto source = level == 0 ? depthBuffer_.Extent() : levelExtents_[level - 1];
+		const auto target = levelExtents_[level];
+		const int32_t constants[4] = {
+			static_cast<int32_t>(source.width), static_cast<int32_t>(source.height),
+			static_cast<int32_t>(target.width), static_cast<int32_t>(target.height)
+		};
+
+		dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pyramidPipelineLayout_->Handle(), 0, 1, &pyramidSets_[level], 0, nullptr);
+		dispatch.vkCmdPushConstants(commandBuffer, pyramidPipelineLayout_->Handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), constants);
+		dispatch.vkCmdDispatch(commandBuffer, (target.width + PyramidGroupSize - 1) / PyramidGroupSize, (target.height + PyramidGroupSize - 1) / PyramidGroupSize, 1);
+		dispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &levelBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	// The second phase draws on top of the first phase depth
+	const auto toAttachment = DepthBarrier(depthBuffer_.Image(),
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+		0, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toAttachment);
+
+	pyramidValid_ = true;
+}
+
+void OcclusionCulling::Draw(VkCommandBuffer commandBuffer, const uint32_t phase, const std::array<float, 16>& viewProjection, FrameStats& frameStats) const {
+	const auto& dispatch = device_.Dispatch();
+
+	DrawConstants constants = {};
+	std::copy(viewProjection.begin(), viewProjection.end(), constants.ViewProjection);
+	constants.ListOffset = phase * objectCount_;
+
+	const auto lightingModel = lighting_.LightCount() != 0 ? LightingModel::Clustered : LightingModel::Directional;
+	const auto& pipeline = drawPipelines_->Get(PipelineState().WithDepthTest(true), ShaderVariant().With(lightingModel));
+
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.Handle());
+	const VkDescriptorSet descriptorSets[2] = { cullSet_, lighting_.DescriptorSet() };
+	const auto& dynamicOffsets = lighting_.DynamicOffsets();
+	dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPipelineLayout_->Handle(), 0, 2, descriptorSets, static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+	dispatch.vkCmdPushConstants(commandBuffer, drawPipelineLayout_->Handle(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+
+	// The vertex count was written by the culling, the triangle count is the one of a recent frame
+	dispatch.vkCmdDrawIndirect(commandBuffer, draws_->Handle(), phase * DrawSize, 1, 0);
+	frameStats.RecordDraw(12 * (phase == 0 ? statistics_.FirstPhase : statistics_.SecondPhase));
+}
+
+void OcclusionCulling::Readback(VkCommandBuffer commandBuffer, const uint32_t frame) const {
+	const auto& dispatch = device_.Dispatch();
+
+	VkMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	dispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+	// Vertex counts of both phases
+	const VkDeviceSize offset = VkDeviceSize(frame) * 2 * sizeof(uint32_t);
+	const VkBufferCopy regions[2] = {
+		{ 0, offset, sizeof(uint32_t) },
+		{ DrawSize, offset + sizeof(uint32_t), sizeof(uint32_t) }
+	};
+	dispatch.vkCmdCopyBuffer(commandBuffer, draws_->Handle(), readback_->Handle(), 2, regions);
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	dispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void OcclusionCulling::Collect(const uint32_t frame) {
+	statistics_.Objects = objectCount_;
+	statistics_.FirstPhase = readbackData_[2 * frame] / VerticesPerBox;
+	statistics_.SecondPhase = readbackData_[2 * frame + 1] / VerticesPerBox;
+}
+
+}
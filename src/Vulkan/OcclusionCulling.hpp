@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace Vulkan {
+	class Buffer;
+	class ClusteredLighting;
+	class ComputePipeline;
+	class DepthBuffer;
+	class DescriptorPool;
+	class DescriptorSetLayout;
+	class Device;
+	class FrameStats;
+	class Image;
+	class ImageView;
+	class PipelineCompiler;
+	class PipelineLayout;
+	class PipelineVariants;
+	class RenderPass;
+	class Sampler;
+
+	// Scene boxes culled on the device against the view frustum and a hierarchical depth pyramid.
+	// The first phase tests every box against the pyramid built from the previous frame depth and draws the
+	// visible ones; the pyramid is then rebuilt from that depth, and the second phase draws the boxes the first
+	// one wrongly rejected. Visible boxes are appended to a list drawn with a single indirect draw per phase.
+	// Cull and BuildPyramid are recorded outside of the scene rendering, Draw within it. Boxes are lit by the
+	// clustered lights assigned for the frame.
+	class OcclusionCulling final {
+	public:
+
+		// Colors are packed as 0xAABBGGRR
+		struct Box {
+			float Center[3];
+			float Padding;
+			float HalfExtent[3];
+			uint32_t Color;
+		};
+
+		struct Statistics {
+			uint32_t Objects;
+			uint32_t FirstPhase;
+			uint32_t SecondPhase;
+
+			uint32_t Culled() const { return Objects - FirstPhase - SecondPhase; }
+		};
+
+		VULKAN_NON_COPIABLE(OcclusionCulling)
+
+		// The pyramid is sized after the depth buffer, the culling is recreated with the swap chain
+		OcclusionCulling(
+			const Device& device,
+			PipelineCompiler& pipelineCompiler,
+			const DepthBuffer& depthBuffer,
+			const ClusteredLighting& lighting,
+			const RenderPass* renderPass,
+			VkFormat colorFormat,
+			uint32_t frameCount,
+			const std::vector<Box>& boxes);
+		~OcclusionCulling();
+
+		void Cull(VkCommandBuffer commandBuffer, uint32_t phase, const std::array<float, 16>& viewProjection);
+		// Reduce the depth of the first phase draws into the pyramid, the depth buffer is left as an attachment
+		void BuildPyramid(VkCommandBuffer commandBuffer);
+		void Draw(VkCommandBuffer commandBuffer, uint32_t phase, const std::array<float, 16>& viewProjection, FrameStats& frameStats) const;
+		// Copy the visible counts of both phases for the frame being recorded, once its second phase is culled
+		void Readback(VkCommandBuffer commandBuffer, uint32_t frame) const;
+
+		// Counts of the last frame recorded in this slot, valid once it has completed
+		void Collect(uint32_t frame);
+		const Statistics& LastStatistics() const { return statistics_; }
+
+	private:
+
+		struct CullConstants {
+			float ViewProjection[16];
+			uint32_t ObjectCount;
+			uint32_t Phase;
+			uint32_t PyramidValid;
+		};
+
+		struct DrawConstants {
+			float ViewProjection[16];
+			uint32_t ListOffset;
+		};
+
+		const Device& device_;
+		const DepthBuffer& depthBuffer_;
+		const ClusteredLighting& lighting_;
+		const uint32_t objectCount_;
+
+		std::unique_ptr<Buffer> boxes_;
+		std::unique_ptr<Buffer> visibility_;
+		std::unique_ptr<Buffer> draws_;
+		std::unique_ptr<Buffer> lists_;
+		std::unique_ptr<Buffer> readback_;
+		const uint32_t* readbackData_{};
+
+		// Farthest depth, level 0 is the depth buffer rounded down to powers of two
+		std::unique_ptr<Image> pyramid_;
+		std::unique_ptr<ImageView> pyramidView_;
+		std::vector<std::unique_ptr<ImageView>> levelViews_;
+		std::vector<VkExtent2D> levelExtents_;
+		std::unique_ptr<Sampler> sampler_;
+		bool pyramidValid_{};
+
+		std::unique_ptr<DescriptorSetLayout> cullSetLayout_;
+		std::unique_ptr<DescriptorSetLayout> pyramidSetLayout_;
+		std::unique_ptr<DescriptorPool> descriptorPool_;
+		VkDescriptorSet cullSet_{};
+		// One per pyramid level, reading the level above and writing the level
+		std::vector<VkDescriptorSet> pyramidSets_;
+
+		std::unique_ptr<PipelineLayout> cullPipelineLayout_;
+		std::unique_ptr<PipelineLayout> pyramidPipelineLayout_;
+		std::unique_ptr<PipelineLayout> drawPipelineLayout_;
+		std::unique_ptr<ComputePipeline> cullPipeline_;
+		std::unique_ptr<ComputePipeline> pyramidPipeline_;
+		// Directional and clustered lighting variants, the cheaper one when no light was assigned
+		std::unique_ptr<PipelineVariants> drawPipelines_;
+
+		Statistics statistics_{};
+	};
+
+}
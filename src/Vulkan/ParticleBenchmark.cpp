@@ -0,0 +1,79 @@
+#include "ParticleBenchmark.hpp"
+
+#include "CommandBuffers.hpp"
+#include "CommandPool.hpp"
+#include "Device.hpp"
+#include "Fence.hpp"
+#include "ParticleSystem.hpp"
+#include "PipelineCache.hpp"
+#include "QueueSubmission.hpp"
+#include "../Utilities/Log.hpp"
+
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace Vulkan {
+
+	namespace {
+		constexpr float DeltaTime = 1.0f / 60.0f;
+		// Particles live up to two seconds, the system is full by the end of the warm-up
+		constexpr uint32_t WarmupSteps = 150;
+		// Steps per submission, short enough to stay clear of the driver timeouts
+		constexpr uint32_t SubmitBatch = 30;
+
+		void RunSteps(const Device& device, ParticleSystem& particles, CommandBuffers& commandBuffers, Fence& fence, const uint32_t steps) {
+			for (uint32_t step = 0; step < steps; step += SubmitBatch) {
+				const auto commandBuffer = commandBuffers.Begin(0);
+
+				for (uint32_t i = step; i != steps && i != step + SubmitBatch; ++i)
+					particles.Record(commandBuffer, DeltaTime);
+
+				commandBuffers.End(0);
+
+				fence.Reset();
+				QueueSubmission()
+					.Execute(commandBuffer)
+					.Submit(device, device.ComputeQueue(), fence.Handle());
+				fence.Wait(std::numeric_limits<uint64_t>::max());
+			}
+		}
+	}
+
+std::vector<ParticleBenchmarkResult> RunParticleBenchmark(const Device& device, const std::vector<uint32_t>& capacities, const uint32_t steps) {
+	// Pipelines are compiled once, not for every capacity
+	const PipelineCache pipelineCache(device, {});
+	CommandPool commandPool(device, device.ComputeFamilyIndex(), true);
+	CommandBuffers commandBuffers(commandPool, 1);
+	Fence fence(device, false);
+
+	std::vector<ParticleBenchmarkResult> results;
+
+	for (const auto capacity : capacities) {
+		std::unique_ptr<ParticleSystem> particles;
+
+		try {
+			particles.reset(new ParticleSystem(device, pipelineCache, capacity));
+		}
+		catch (const std::exception& exception) {
+			LOG_WARNING("[particles] skipping {} particles: {}", capacity, exception.what());
+			continue;
+		}
+
+		particles->SetEmitRate(static_cast<float>(capacity) / ParticleSystem::MeanLifetime);
+		RunSteps(device, *particles, commandBuffers, fence, WarmupSteps);
+
+		const auto start = std::chrono::steady_clock::now();
+		RunSteps(device, *particles, commandBuffers, fence, steps);
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		// The system is about full, the count at the end stands for the whole measurement
+		const uint32_t alive = particles->AliveCount();
+		results.push_back({ capacity, alive, elapsed.count() * 1000.0 / steps, static_cast<double>(alive) * steps / elapsed.count() });
+	}
+
+	return results;
+}
+
+}
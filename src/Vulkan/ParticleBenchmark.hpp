@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <vector>
+
+namespace Vulkan {
+	class Device;
+
+	struct ParticleBenchmarkResult {
+		uint32_t Capacity;
+		uint32_t AliveCount;
+		double StepMilliseconds;
+		double ParticlesPerSecond;
+	};
+
+	// Simulation steps of particle systems kept about full, timed on the compute queue without any rendering.
+	// Capacities the device cannot hold are skipped.
+	std::vector<ParticleBenchmarkResult> RunParticleBenchmark(const Device& device, const std::vector<uint32_t>& capacities, uint32_t steps);
+
+}
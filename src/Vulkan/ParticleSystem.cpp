@@ -0,0 +1,318 @@
+#include "ParticleSystem.hpp"
+
+#include "Buffer.hpp"
+#include "ComputePipeline.hpp"
+#include "DescriptorPool.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+#include "FrameStats.hpp"
+#include "GraphicsPipeline.hpp"
+#include "PipelineLayout.hpp"
+#include "PipelineVariants.hpp"
+#include "ShaderModule.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Vulkan {
+
+	namespace {
+		constexpr uint32_t WorkGroupSize = 256;
+		constexpr uint32_t MaxWorkGroups = 65535;
+		constexpr VkDeviceSize ParticleSize = 8 * sizeof(float);
+
+		// Indirect buffer layout, in uints: simulation and compaction dispatch, one dispatch per scan level, then the draw
+		constexpr uint32_t ScanArguments = 3;
+		constexpr uint32_t DrawArguments = 16;
+		constexpr uint32_t IndirectSize = DrawArguments + 4;
+
+		// Alive and dead counts, then the element count of every scan level
+		constexpr VkDeviceSize CountersSize = 8 * sizeof(uint32_t);
+
+		// Half size of a particle, in pixels
+		constexpr float ParticleRadius = 2.0f;
+
+		enum Binding : uint32_t {
+			Particles,
+			AliveCurrent,
+			AliveNext,
+			Dead,
+			Counters,
+			Scan,
+			Indirect,
+			BindingCount
+		};
+
+		PipelineState DrawState() {
+			return PipelineState().WithCullMode(VK_CULL_MODE_NONE).WithBlendMode(BlendMode::Additive);
+		}
+
+		uint32_t Hash(uint32_t x) {
+			x ^= x >> 16;
+			x *= 0x7feb352du;
+			x ^= x >> 15;
+			x *= 0x846ca68bu;
+			x ^= x >> 16;
+			return x;
+		}
+	}
+
+ParticleSystem::ParticleSystem(const Device& device, const PipelineCache& pipelineCache, const uint32_t capacity) :
+	device_(device),
+	capacity_(capacity)
+{
+	if (capacity == 0 || capacity > MaxCapacity)
+		throw std::invalid_argument("particle capacity must be between 1 and " + std::to_string(MaxCapacity));
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties);
+
+	if (capacity * ParticleSize > properties.limits.maxStorageBufferRange)
+		throw std::runtime_error(std::to_string(capacity) + " particles exceed the storage buffer range of the device");
+
+	// Level sizes shrink by the work group size until a single block is left, its total goes past the last level
+	uint32_t size = capacity;
+	uint32_t offset = 0;
+	do {
+		levelOffsets_[levelCount_++] = offset;
+		offset += size;
+		size = (size + WorkGroupSize - 1) / WorkGroupSize;
+	} while (size > 1);
+	levelOffsets_[levelCount_] = offset;
+
+	// Simulated on the compute queue, drawn on the graphics one
+	const std::vector<uint32_t> families = { device.GraphicsFamilyIndex(), device.ComputeFamilyIndex() };
+	const auto storage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	const auto deviceLocal = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+	particles_.reset(new Buffer(device, capacity * ParticleSize, storage, deviceLocal, "particles", 0, families));
+	alive_[0].reset(new Buffer(device, capacity * sizeof(uint32_t), storage, deviceLocal, "particle alive list", 0, families));
+	alive_[1].reset(new Buffer(device, capacity * sizeof(uint32_t), storage, deviceLocal, "particle alive list", 0, families));
+	dead_.reset(new Buffer(device, capacity * sizeof(uint32_t), storage, deviceLocal, "particle dead list", 0, families));
+	counters_.reset(new Buffer(device, CountersSize, storage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, deviceLocal, "particle counters", 0, families));
+	scan_.reset(new Buffer(device, (VkDeviceSize(offset) + 1) * sizeof(uint32_t), storage, deviceLocal, "particle prefix sums", 0, families));
+	indirect_.reset(new Buffer(device, IndirectSize * sizeof(uint32_t), storage | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, deviceLocal, "particle indirect arguments", 0, families));
+
+	readback_.reset(new Buffer(device, CountersSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, "particle counters readback"));
+	readbackData_ = static_cast<const uint32_t*>(readback_->Memory().Map(0, VK_WHOLE_SIZE));
+
+	std::vector<VkDescriptorSetLayoutBinding> bindings;
+	for (uint32_t binding = 0; binding != BindingCount; ++binding) {
+		const VkShaderStageFlags stages = binding == Particles || binding == AliveCurrent
+			? VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT
+			: VK_SHADER_STAGE_COMPUTE_BIT;
+		bindings.push_back({ binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, stages, nullptr });
+	}
+
+	descriptorSetLayout_.reset(new DescriptorSetLayout(device, bindings));
+	descriptorPool_.reset(new DescriptorPool(device, { { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * BindingCount } }, 2, 0));
+
+	const auto sets = descriptorPool_->Allocate(*descriptorSetLayout_, 2);
+
+	// Buffer infos must stay in place until the update, every write points to one
+	std::vector<VkDescriptorBufferInfo> bufferInfos;
+	bufferInfos.reserve(2 * BindingCount);
+	std::vector<VkWriteDescriptorSet> writes;
+
+	for (uint32_t parity = 0; parity != 2; ++parity) {
+		descriptorSets_[parity] = sets[parity];
+
+		const Buffer* const buffers[BindingCount] = {
+			particles_.get(), alive_[parity].get(), alive_[1 - parity].get(), dead_.get(), counters_.get(), scan_.get(), indirect_.get()
+		};
+
+		for (uint32_t binding = 0; binding != BindingCount; ++binding) {
+			bufferInfos.push_back({ buffers[binding]->Handle(), 0, VK_WHOLE_SIZE });
+
+			VkWriteDescriptorSet write = {};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = descriptorSets_[parity];
+			write.dstBinding = binding;
+			write.descriptorCount = 1;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			write.pBufferInfo = &bufferInfos.back();
+			writes.push_back(write);
+		}
+	}
+
+	device.Dispatch().vkUpdateDescriptorSets(device.Handle(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+	computePipelineLayout_.reset(new PipelineLayout(device, { descriptorSetLayout_->Handle() }, { { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Constants) } }));
+	graphicsPipelineLayout_.reset(new PipelineLayout(device, { descriptorSetLayout_->Handle() }, { { VK_SHADER_STAGE_VERTEX_BIT, 0, 2 * sizeof(float) } }));
+
+	const auto create = [&](const char* const filename) {
+		const ShaderModule shader(device, std::string("../assets/shaders/") + filename);
+		return std::unique_ptr<ComputePipeline>(new ComputePipeline(device, pipelineCache, *computePipelineLayout_, shader));
+	};
+
+	initPipeline_ = create("particle_init.comp.spv");
+	emitPipeline_ = create("particle_emit.comp.spv");
+	beginPipeline_ = create("particle_begin.comp.spv");
+	simulatePipeline_ = create("particle_simulate.comp.spv");
+	scanPipeline_ = create("particle_scan.comp.spv");
+	scanAddPipeline_ = create("particle_scan_add.comp.spv");
+	compactPipeline_ = create("particle_compact.comp.spv");
+	endPipeline_ = create("particle_end.comp.spv");
+}
+
+ParticleSystem::~ParticleSystem() {
+	graphicsPipelines_.reset();
+	graphicsPipelineLayout_.reset();
+	endPipeline_.reset();
+	compactPipeline_.reset();
+	scanAddPipeline_.reset();
+	scanPipeline_.reset();
+	simulatePipeline_.reset();
+	beginPipeline_.reset();
+	emitPipeline_.reset();
+	initPipeline_.reset();
+	computePipelineLayout_.reset();
+	descriptorPool_.reset();
+	descriptorSetLayout_.reset();
+	readback_.reset();
+	indirect_.reset();
+	scan_.reset();
+	counters_.reset();
+	dead_.reset();
+	alive_[1].reset();
+	alive_[0].reset();
+	particles_.reset();
+}
+
+void ParticleSystem::Record(VkCommandBuffer commandBuffer, const float deltaTime) {
+	const auto& dispatch = device_.Dispatch();
+
+	// Fractions of a particle are carried over to the next steps
+	emitRemainder_ = std::min(emitRemainder_ + emitRate_ * deltaTime, static_cast<float>(capacity_));
+	const auto emitCount = static_cast<uint32_t>(emitRemainder_);
+	emitRemainder_ -= static_cast<float>(emitCount);
+
+	Constants constants = {};
+	constants.Capacity = capacity_;
+	constants.EmitCount = emitCount;
+	constants.Seed = Hash(++step_);
+	constants.LevelCount = levelCount_;
+	constants.DeltaTime = deltaTime;
+
+	dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipelineLayout_->Handle(), 0, 1, &descriptorSets_[parity_], 0, nullptr);
+
+	if (!initialized_) {
+		Dispatch(commandBuffer, *initPipeline_, constants, capacity_);
+		Barrier(commandBuffer);
+		initialized_ = true;
+	}
+
+	Dispatch(commandBuffer, *emitPipeline_, constants, emitCount);
+	Barrier(commandBuffer);
+	Dispatch(commandBuffer, *beginPipeline_, constants, 1);
+	Barrier(commandBuffer);
+	DispatchIndirect(commandBuffer, *simulatePipeline_, constants, 0);
+	Barrier(commandBuffer);
+
+	// Scan every level up, then add the scanned block totals back down
+	for (uint32_t level = 0; level != levelCount_; ++level) {
+		constants.Level = level;
+		constants.DataOffset = levelOffsets_[level];
+		constants.SumsOffset = levelOffsets_[level + 1];
+		DispatchIndirect(commandBuffer, *scanPipeline_, constants, ScanArguments * (level + 1));
+		Barrier(commandBuffer);
+	}
+
+	for (uint32_t level = levelCount_ - 1; level-- != 0;) {
+		constants.Level = level;
+		constants.DataOffset = levelOffsets_[level];
+		constants.SumsOffset = levelOffsets_[level + 1];
+		DispatchIndirect(commandBuffer, *scanAddPipeline_, constants, ScanArguments * (level + 1));
+		Barrier(commandBuffer);
+	}
+
+	DispatchIndirect(commandBuffer, *compactPipeline_, constants, 0);
+	Barrier(commandBuffer);
+
+	constants.SumsOffset = levelOffsets_[levelCount_];
+	Dispatch(commandBuffer, *endPipeline_, constants, 1);
+	// The next step emits at the counts written by this one, steps may be recorded back to back
+	Barrier(commandBuffer);
+
+	VkMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	dispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+	const VkBufferCopy region = { 0, 0, CountersSize };
+	dispatch.vkCmdCopyBuffer(commandBuffer, counters_->Handle(), readback_->Handle(), 1, &region);
+
+	// The copy also reads the counters before the next step overwrites them
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	dispatch.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+	// The survivors are in the other alive list now
+	parity_ = 1 - parity_;
+}
+
+void ParticleSystem::SetRenderTarget(PipelineCompiler& pipelineCompiler, const RenderPass* const renderPass, const VkFormat colorFormat, const VkFormat depthFormat) {
+	// Vertices are pulled from the storage buffers, there is no vertex input
+	graphicsPipelines_.reset(new PipelineVariants(
+		device_, pipelineCompiler, "particle", *graphicsPipelineLayout_, renderPass, colorFormat, depthFormat,
+		ShaderModule::ReadFile("../assets/shaders/particle.vert.spv"), ShaderModule::ReadFile("../assets/shaders/particle.frag.spv")));
+	graphicsPipelines_->Prewarm({ DrawState() });
+}
+
+void ParticleSystem::Render(VkCommandBuffer commandBuffer, const VkExtent2D extent, FrameStats& frameStats) const {
+	if (!initialized_)
+		return;
+
+	const auto& dispatch = device_.Dispatch();
+
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipelines_->Get(DrawState()).Handle());
+	dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipelineLayout_->Handle(), 0, 1, &descriptorSets_[parity_], 0, nullptr);
+
+	const float scale[2] = { 2.0f * ParticleRadius / static_cast<float>(extent.width), 2.0f * ParticleRadius / static_cast<float>(extent.height) };
+	dispatch.vkCmdPushConstants(commandBuffer, graphicsPipelineLayout_->Handle(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(scale), scale);
+
+	// The vertex count was written by the last step
+	dispatch.vkCmdDrawIndirect(commandBuffer, indirect_->Handle(), DrawArguments * sizeof(uint32_t), 1, 0);
+	frameStats.RecordDraw(2 * AliveCount());
+}
+
+uint32_t ParticleSystem::AliveCount() const {
+	return readbackData_[0];
+}
+
+void ParticleSystem::Dispatch(VkCommandBuffer commandBuffer, const ComputePipeline& pipeline, const Constants& constants, const uint32_t threads) const {
+	if (threads == 0)
+		return;
+
+	const auto& dispatch = device_.Dispatch();
+	const uint32_t groups = (threads + WorkGroupSize - 1) / WorkGroupSize;
+
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.Handle());
+	dispatch.vkCmdPushConstants(commandBuffer, computePipelineLayout_->Handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+	dispatch.vkCmdDispatch(commandBuffer, std::min(groups, MaxWorkGroups), (groups + MaxWorkGroups - 1) / MaxWorkGroups, 1);
+}
+
+void ParticleSystem::DispatchIndirect(VkCommandBuffer commandBuffer, const ComputePipeline& pipeline, const Constants& constants, const uint32_t argumentsIndex) const {
+	const auto& dispatch = device_.Dispatch();
+
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.Handle());
+	dispatch.vkCmdPushConstants(commandBuffer, computePipelineLayout_->Handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+	dispatch.vkCmdDispatchIndirect(commandBuffer, indirect_->Handle(), argumentsIndex * sizeof(uint32_t));
+}
+
+void ParticleSystem::Barrier(VkCommandBuffer commandBuffer) const {
+	// Every pass reads what the previous ones wrote, dispatch sizes included
+	VkMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+	device_.Dispatch().vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0,
+		1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <array>
+#include <memory>
+
+namespace Vulkan {
+	class Buffer;
+	class ComputePipeline;
+	class DescriptorPool;
+	class DescriptorSetLayout;
+	class Device;
+	class FrameStats;
+	class PipelineCache;
+	class PipelineCompiler;
+	class PipelineLayout;
+	class PipelineVariants;
+	class RenderPass;
+
+	// Particles simulated, emitted and compacted entirely in compute shaders, up to millions of them.
+	// Alive particles are indexed by an alive list and free ones by a dead list. Every step appends emitted
+	// particles to the alive list, simulates it, then compacts the survivors into the other alive list with a
+	// prefix sum of their alive flags, the others going back to the dead list. The counts never leave the
+	// device: dispatch sizes and the draw are indirect, written by the shaders.
+	// Buffers are shared by the compute and graphics queue families, a step must complete before the draw
+	// reading it starts, and the previous draw before the next step.
+	class ParticleSystem final {
+	public:
+
+		// Particles are spread over a 2D grid of work groups, and the prefix sum over up to three levels
+		static constexpr uint32_t MaxCapacity = 256 * 256 * 256;
+
+		VULKAN_NON_COPIABLE(ParticleSystem)
+
+		ParticleSystem(const Device& device, const PipelineCache& pipelineCache, uint32_t capacity);
+		~ParticleSystem();
+
+		uint32_t Capacity() const { return capacity_; }
+
+		// Particles live 1.5 seconds on average, emitting capacity / 1.5 per second keeps the system about full
+		static constexpr float MeanLifetime = 1.5f;
+		void SetEmitRate(const float particlesPerSecond) { emitRate_ = particlesPerSecond; }
+
+		// Record one simulation step, to be submitted on the compute queue
+		void Record(VkCommandBuffer commandBuffer, float deltaTime);
+
+		// The draw is created for the scene render target, and recreated with it; its pipeline is submitted to the compiler
+		void SetRenderTarget(PipelineCompiler& pipelineCompiler, const RenderPass* renderPass, VkFormat colorFormat, VkFormat depthFormat);
+		// Draw the particles of the last step, within the scene rendering once its viewport is set
+		void Render(VkCommandBuffer commandBuffer, VkExtent2D extent, FrameStats& frameStats) const;
+
+		// Alive particles at the end of a recently completed step
+		uint32_t AliveCount() const;
+
+	private:
+
+		struct Constants {
+			uint32_t Capacity;
+			uint32_t EmitCount;
+			uint32_t Seed;
+			uint32_t Level;
+			uint32_t DataOffset;
+			uint32_t SumsOffset;
+			uint32_t LevelCount;
+			float DeltaTime;
+		};
+
+		void Dispatch(VkCommandBuffer commandBuffer, const ComputePipeline& pipeline, const Constants& constants, uint32_t threads) const;
+		void DispatchIndirect(VkCommandBuffer commandBuffer, const ComputePipeline& pipeline, const Constants& constants, uint32_t argumentsIndex) const;
+		void Barrier(VkCommandBuffer commandBuffer) const;
+
+		const Device& device_;
+		const uint32_t capacity_;
+
+		// Offset of every prefix sum level in the scan buffer, the block totals of a level are the next one
+		std::array<uint32_t, 4> levelOffsets_{};
+		uint32_t levelCount_{};
+
+		std::unique_ptr<Buffer> particles_;
+		std::array<std::unique_ptr<Buffer>, 2> alive_;
+		std::unique_ptr<Buffer> dead_;
+		std::unique_ptr<Buffer> counters_;
+		std::unique_ptr<Buffer> scan_;
+		std::unique_ptr<Buffer> indirect_;
+		std::unique_ptr<Buffer> readback_;
+		const uint32_t* readbackData_{};
+
+		// One set per alive list parity, the current list is the one the last step compacted into
+		std::unique_ptr<DescriptorSetLayout> descriptorSetLayout_;
+		std::unique_ptr<DescriptorPool> descriptorPool_;
+		std::array<VkDescriptorSet, 2> descriptorSets_{};
+
+		std::unique_ptr<PipelineLayout> computePipelineLayout_;
+		std::unique_ptr<ComputePipeline> initPipeline_;
+		std::unique_ptr<ComputePipeline> emitPipeline_;
+		std::unique_ptr<ComputePipeline> beginPipeline_;
+		std::unique_ptr<ComputePipeline> simulatePipeline_;
+		std::unique_ptr<ComputePipeline> scanPipeline_;
+		std::unique_ptr<ComputePipeline> scanAddPipeline_;
+		std::unique_ptr<ComputePipeline> compactPipeline_;
+		std::unique_ptr<ComputePipeline> endPipeline_;
+
+		std::unique_ptr<PipelineLayout> graphicsPipelineLayout_;
+		std::unique_ptr<PipelineVariants> graphicsPipelines_;
+
+		float emitRate_{};
+		float emitRemainder_{};
+		uint32_t step_{};
+		uint32_t parity_{};
+		bool initialized_{};
+	};
+
+}
@@ -0,0 +1,217 @@
+#include "PerformanceOverlay.hpp"
+
+#include "CommandBuffers.hpp"
+#include "CommandPool.hpp"
+#include "ComputePipeline.hpp"
+#include "DescriptorPool.hpp"
+#include "Device.hpp"
+#include "FrameStats.hpp"
+#include "GraphicsPipeline.hpp"
+#include "ImageView.hpp"
+#include "MemoryStatistics.hpp"
+#include "Instance.hpp"
+#include "QueueSubmission.hpp"
+#include "RenderPass.hpp"
+#include "Surface.hpp"
+#include "SwapChain.hpp"
+#include "Window.hpp"
+
+#include <imgui.h>
+#include <examples/imgui_impl_glfw.h>
+#include <examples/imgui_impl_vulkan.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+namespace Vulkan {
+
+	namespace {
+		void CheckImGuiResult(const VkResult result) {
+			if (result != VK_SUCCESS)
+				throw std::runtime_error(std::string("failed to render overlay (") + toString(result) + ")");
+		}
+
+		void PlotMetric(const FrameStats& frameStats, const FrameStats::Metric metric) {
+			const auto& history = frameStats.History(metric);
+			const float maxValue = *std::max_element(history.begin(), history.end());
+			char label[64];
+			std::snprintf(label, sizeof(label), "%s %.2f ms", FrameStats::Name(metric), frameStats.Last(metric));
+
+			ImGui::PlotLines(
+				label, history.data(), static_cast<int>(history.size()), static_cast<int>(frameStats.HistoryOffset(metric)),
+				nullptr, 0.0f, std::max(maxValue, 1.0f), ImVec2(240, 40));
+		}
+	}
+
+PerformanceOverlay::PerformanceOverlay(const class SwapChain& swapChain, CommandPool& commandPool) :
+	swapChain_(swapChain)
+{
+	const auto& device = swapChain.Device();
+	const auto& instance = device.Surface().Instance();
+
+	// ImGui only needs the font texture sampler, a small pool is enough
+	descriptorPool_.reset(new DescriptorPool(device, {{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1}}, 1, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT));
+	renderPass_.reset(new class RenderPass(swapChain, false));
+
+	for (const auto& imageView : swapChain.ImageViews()) {
+		frameBuffers_.emplace_back(*imageView, *renderPass_, swapChain.Extent());
+	}
+
+	IMGUI_CHECKVERSION();
+	ImGui::CreateContext();
+	ImGui::GetIO().IniFilename = nullptr;
+	ImGui::StyleColorsDark();
+
+	// Input callbacks stay with the application window, ImGui polls the mouse state itself
+	if (!ImGui_ImplGlfw_InitForVulkan(instance.Window().Handle(), false))
+		throw std::runtime_error("failed to initialise ImGui GLFW adapter");
+
+	ImGui_ImplVulkan_InitInfo initInfo = {};
+	initInfo.Instance = instance.Handle();
+	initInfo.PhysicalDevice = device.PhysicalDevice();
+	initInfo.Device = device.Handle();
+	initInfo.QueueFamily = device.GraphicsFamilyIndex();
+	initInfo.Queue = device.GraphicsQueue();
+	initInfo.PipelineCache = VK_NULL_HANDLE;
+	initInfo.DescriptorPool = descriptorPool_->Handle();
+	initInfo.MinImageCount = swapChain.MinImageCount();
+	initInfo.ImageCount = static_cast<uint32_t>(swapChain.Images().size());
+	initInfo.Allocator = device.Allocator();
+	initInfo.CheckVkResultFn = CheckImGuiResult;
+
+	if (!ImGui_ImplVulkan_Init(&initInfo, renderPass_->Handle()))
+		throw std::runtime_error("failed to initialise ImGui Vulkan adapter");
+
+	UploadFonts(commandPool);
+}
+
+PerformanceOverlay::~PerformanceOverlay() {
+	ImGui_ImplVulkan_Shutdown();
+	ImGui_ImplGlfw_Shutdown();
+	ImGui::DestroyContext();
+
+	frameBuffers_.clear();
+	renderPass_.reset();
+	descriptorPool_.reset();
+}
+
+void PerformanceOverlay::Render(VkCommandBuffer commandBuffer, const uint32_t imageIndex, FrameStats& frameStats) {
+	ImGui_ImplVulkan_NewFrame();
+	ImGui_ImplGlfw_NewFrame();
+	ImGui::NewFrame();
+
+	BuildWindow(frameStats);
+
+	ImGui::Render();
+
+	const auto drawData = ImGui::GetDrawData();
+
+	for (int i = 0; i != drawData->CmdListsCount; ++i) {
+		for (const auto& drawCommand : drawData->CmdLists[i]->CmdBuffer) {
+			frameStats.RecordDraw(drawCommand.ElemCount / 3);
+		}
+	}
+
+	VkRenderPassBeginInfo renderPassInfo = {};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass = renderPass_->Handle();
+	renderPassInfo.framebuffer = frameBuffers_[imageIndex].Handle();
+	renderPassInfo.renderArea.offset = { 0, 0 };
+	renderPassInfo.renderArea.extent = swapChain_.Extent();
+
+	swapChain_.Device().Dispatch().vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	ImGui_ImplVulkan_RenderDrawData(drawData, commandBuffer);
+	swapChain_.Device().Dispatch().vkCmdEndRenderPass(commandBuffer);
+}
+
+void PerformanceOverlay::UploadFonts(CommandPool& commandPool) {
+	CommandBuffers commandBuffers(commandPool, 1);
+
+	const auto commandBuffer = commandBuffers.Begin(0);
+	if (!ImGui_ImplVulkan_CreateFontsTexture(commandBuffer))
+		throw std::runtime_error("failed to create ImGui font texture");
+	commandBuffers.End(0);
+
+	QueueSubmission()
+		.Execute(commandBuffer)
+		.Submit(swapChain_.Device(), swapChain_.Device().GraphicsQueue());
+
+	// One-off upload at creation, stalling is fine here
+	swapChain_.Device().WaitIdle();
+	ImGui_ImplVulkan_DestroyFontUploadObjects();
+}
+
+void PerformanceOverlay::BuildWindow(const FrameStats& frameStats) {
+	const auto flags =
+		ImGuiWindowFlags_AlwaysAutoResize |
+		ImGuiWindowFlags_NoFocusOnAppearing |
+		ImGuiWindowFlags_NoSavedSettings;
+
+	ImGui::SetNextWindowPos(ImVec2(10, 10));
+	ImGui::SetNextWindowBgAlpha(0.6f);
+
+	if (!ImGui::Begin("Performance (F1)", nullptr, flags)) {
+		ImGui::End();
+		return;
+	}
+
+	ImGui::Text("%.1f fps", frameStats.Last(FrameStats::Metric::CpuFrame) > 0 ? 1000.0 / frameStats.Last(FrameStats::Metric::CpuFrame) : 0.0);
+
+	PlotMetric(frameStats, FrameStats::Metric::CpuFrame);
+	PlotMetric(frameStats, FrameStats::Metric::Gpu);
+	PlotMetric(frameStats, FrameStats::Metric::Acquire);
+	PlotMetric(frameStats, FrameStats::Metric::Present);
+
+	ImGui::Separator();
+	ImGui::Text("Overlay cost: cpu %.3f ms, gpu %.3f ms",
+		frameStats.Last(FrameStats::Metric::OverlayCpu),
+		frameStats.Last(FrameStats::Metric::OverlayGpu));
+
+	ImGui::Separator();
+	ImGui::Text("Draw calls: %u", frameStats.DrawCalls());
+	ImGui::Text("Triangles: %llu", static_cast<unsigned long long>(frameStats.Triangles()));
+	ImGui::Text("Sorted draw binds: %u (%u saved)", frameStats.Binds(), frameStats.SavedBinds());
+	// Counted where they are created, plus the ImGui pipeline and font set the backend creates itself (its pool is ours)
+	ImGui::Text("Pipelines: %u graphics, %u compute", GraphicsPipeline::LiveCount() + 1, ComputePipeline::LiveCount());
+	ImGui::Text("Descriptor pools: %u, sets: %u", DescriptorPool::LiveCount(), DescriptorPool::LiveSetCount() + 1);
+
+	ImGui::Separator();
+
+	auto& memoryStatistics = swapChain_.Device().MemoryStatistics();
+
+	// The budget query goes through the driver, a couple of refreshes per second are plenty
+	if (ImGui::GetTime() - lastBudgetUpdate_ > 0.5) {
+		memoryStatistics.UpdateBudget();
+		lastBudgetUpdate_ = ImGui::GetTime();
+	}
+
+	const auto heaps = memoryStatistics.Heaps();
+
+	for (size_t i = 0; i != heaps.size(); ++i) {
+		const auto& heap = heaps[i];
+		constexpr VkDeviceSize megabyte = 1024 * 1024;
+
+		ImGui::Text("Heap %zu (%s): %llu MB in %u allocations, peak %llu MB", i, heap.DeviceLocal ? "device" : "host",
+			static_cast<unsigned long long>(heap.Allocated / megabyte), heap.AllocationCount,
+			static_cast<unsigned long long>(heap.Peak / megabyte));
+
+		if (memoryStatistics.IsBudgetAvailable()) {
+			const float fraction = heap.Budget != 0 ? static_cast<float>(heap.Usage) / static_cast<float>(heap.Budget) : 0.0f;
+			char label[64];
+			std::snprintf(label, sizeof(label), "%llu / %llu MB",
+				static_cast<unsigned long long>(heap.Usage / megabyte),
+				static_cast<unsigned long long>(heap.Budget / megabyte));
+
+			ImGui::ProgressBar(fraction, ImVec2(240, 0), label);
+		}
+		else {
+			ImGui::Text("  size %llu MB", static_cast<unsigned long long>(heap.Size / megabyte));
+		}
+	}
+
+	ImGui::End();
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "FrameBuffer.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace Vulkan {
+	class CommandPool;
+	class DescriptorPool;
+	class FrameStats;
+	class RenderPass;
+	class SwapChain;
+
+	// Dear ImGui window drawn on top of the swap chain image: frame time graphs, draw counts and device memory usage.
+	// It renders in its own render pass, after the application one, so its GPU cost can be timed separately.
+	class PerformanceOverlay final {
+	public:
+
+		VULKAN_NON_COPIABLE(PerformanceOverlay)
+
+		PerformanceOverlay(const SwapChain& swapChain, CommandPool& commandPool);
+		~PerformanceOverlay();
+
+		void Render(VkCommandBuffer commandBuffer, uint32_t imageIndex, FrameStats& frameStats);
+
+	private:
+
+		void UploadFonts(CommandPool& commandPool);
+		void BuildWindow(const FrameStats& frameStats);
+
+		const class SwapChain& swapChain_;
+
+		std::unique_ptr<class DescriptorPool> descriptorPool_;
+		std::unique_ptr<class RenderPass> renderPass_;
+		std::vector<class FrameBuffer> frameBuffers_;
+		double lastBudgetUpdate_{-1.0};
+	};
+
+}
@@ -0,0 +1,206 @@
+#include "PhysicalDeviceInfo.hpp"
+
+#include "Device.hpp"
+#include "Enumerate.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+namespace Vulkan {
+
+	namespace {
+		std::string ToLower(std::string value) {
+			std::transform(value.begin(), value.end(), value.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return value;
+		}
+
+		bool IsIndex(const std::string& value) {
+			return !value.empty() && std::all_of(value.begin(), value.end(), [](const unsigned char c) { return std::isdigit(c) != 0; });
+		}
+	}
+
+PhysicalDeviceInfo::PhysicalDeviceInfo(VkPhysicalDevice physicalDevice, const uint32_t instanceApiVersion, VkSurfaceKHR surface) :
+	physicalDevice_(physicalDevice)
+{
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties_);
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties_);
+
+	queueFamilies_ = GetEnumerateVector(physicalDevice, vkGetPhysicalDeviceQueueFamilyProperties);
+	extensions_ = GetEnumerateVector(physicalDevice, static_cast<const char*>(nullptr), vkEnumerateDeviceExtensionProperties);
+
+	presentSupport_.resize(queueFamilies_.size());
+	for (uint32_t i = 0; i != queueFamilies_.size(); ++i) {
+		Check(vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport_[i]), "query surface support");
+	}
+
+	apiVersion_ = std::min(properties_.apiVersion, instanceApiVersion);
+
+	VkPhysicalDeviceFeatures2 features = {};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+
+	features11_.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+	features12_.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {};
+	timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+
+	// The per version structures only exist from Vulkan 1.2 on
+	if (apiVersion_ >= VK_API_VERSION_1_2) {
+		features.pNext = &features11_;
+		features11_.pNext = &features12_;
+
+#ifdef VK_API_VERSION_1_3
+		features13_.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+		if (apiVersion_ >= VK_API_VERSION_1_3)
+			features12_.pNext = &features13_;
+#endif
+	}
+	else if (HasExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+		features.pNext = &timelineSemaphoreFeatures;
+	}
+
+	vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+	features_ = features.features;
+	timelineSemaphore_ = apiVersion_ >= VK_API_VERSION_1_2 ? features12_.timelineSemaphore : timelineSemaphoreFeatures.timelineSemaphore;
+
+	// The snapshot is copied around, do not keep pointers to its own members
+	features11_.pNext = nullptr;
+	features12_.pNext = nullptr;
+}
+
+bool PhysicalDeviceInfo::HasExtension(const char* const extension) const {
+	return std::any_of(extensions_.begin(), extensions_.end(), [extension](const VkExtensionProperties& properties)
+	{
+		return std::strcmp(extension, properties.extensionName) == 0;
+	});
+}
+
+bool PhysicalDeviceInfo::HasExtensions(const std::vector<const char*>& extensions) const {
+	return std::all_of(extensions.begin(), extensions.end(), [this](const char* const extension) { return HasExtension(extension); });
+}
+
+bool PhysicalDeviceInfo::HasQueue(const VkQueueFlags requiredBits, const VkQueueFlags excludedBits) const {
+	return std::any_of(queueFamilies_.begin(), queueFamilies_.end(), [requiredBits, excludedBits](const VkQueueFamilyProperties& queueFamily)
+	{
+		return queueFamily.queueCount > 0 && (queueFamily.queueFlags & requiredBits) == requiredBits && !(queueFamily.queueFlags & excludedBits);
+	});
+}
+
+bool PhysicalDeviceInfo::SupportsTimestamps() const {
+	if (properties_.limits.timestampComputeAndGraphics)
+		return true;
+
+	return std::any_of(queueFamilies_.begin(), queueFamilies_.end(), [](const VkQueueFamilyProperties& queueFamily)
+	{
+		return queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT && queueFamily.timestampValidBits != 0;
+	});
+}
+
+bool PhysicalDeviceInfo::CanPresent() const {
+	return std::any_of(presentSupport_.begin(), presentSupport_.end(), [](const VkBool32 supported) { return supported != VK_FALSE; });
+}
+
+VkDeviceSize PhysicalDeviceInfo::DeviceLocalMemory() const {
+	VkDeviceSize size = 0;
+
+	for (uint32_t i = 0; i != memoryProperties_.memoryHeapCount; ++i) {
+		if (memoryProperties_.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			size += memoryProperties_.memoryHeaps[i].size;
+	}
+
+	return size;
+}
+
+DeviceScore ScoreDevice(const PhysicalDeviceInfo& device) {
+	DeviceScore score;
+
+	if (!device.HasQueue(VK_QUEUE_GRAPHICS_BIT, 0))
+		score.Rejection = "no graphics queue";
+	else if (!device.CanPresent())
+		score.Rejection = "cannot present to the window surface";
+	else if (!device.HasExtensions(Device::RequiredExtensions))
+		score.Rejection = "missing required extensions";
+	else if (!device.Features().fillModeNonSolid || !device.Features().samplerAnisotropy || !device.SupportsTimelineSemaphore())
+		score.Rejection = "missing required features";
+
+	if (!score.IsEligible())
+		return score;
+
+	switch (device.Properties().deviceType) {
+	case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+		score.Value += 100000;
+		break;
+	case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+		score.Value += 50000;
+		break;
+	case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+		score.Value += 20000;
+		break;
+	case VK_PHYSICAL_DEVICE_TYPE_CPU:
+		score.Value += 1000;
+		break;
+	default:;
+	}
+
+	// Dedicated queues let compute and uploads overlap the graphics work
+	if (device.HasAsyncComputeQueue())
+		score.Value += 5000;
+	if (device.HasDedicatedTransferQueue())
+		score.Value += 3000;
+	if (device.SupportsTimestamps())
+		score.Value += 2000;
+
+	// One point per MiB of device local memory, up to 32 GiB, breaks ties between devices of the same kind
+	score.Value += static_cast<int64_t>(std::min<VkDeviceSize>(device.DeviceLocalMemory() / (1024 * 1024), 32 * 1024));
+
+	return score;
+}
+
+const PhysicalDeviceInfo& SelectDevice(const std::vector<PhysicalDeviceInfo>& devices, const std::string& override) {
+	if (!override.empty()) {
+		if (IsIndex(override)) {
+			const size_t index = std::stoul(override);
+			if (index >= devices.size())
+				throw std::invalid_argument("device index " + override + " is out of range");
+
+			const auto score = ScoreDevice(devices[index]);
+			if (!score.IsEligible())
+				throw std::runtime_error("device '" + std::string(devices[index].Name()) + "' cannot be used: " + score.Rejection);
+
+			return devices[index];
+		}
+
+		const auto name = ToLower(override);
+		const auto result = std::find_if(devices.begin(), devices.end(), [&name](const PhysicalDeviceInfo& device)
+		{
+			return ToLower(device.Name()).find(name) != std::string::npos && ScoreDevice(device).IsEligible();
+		});
+
+		if (result == devices.end())
+			throw std::runtime_error("cannot find a suitable device matching '" + override + "'");
+
+		return *result;
+	}
+
+	const PhysicalDeviceInfo* best = nullptr;
+	int64_t bestScore = 0;
+
+	for (const auto& device : devices) {
+		const auto score = ScoreDevice(device);
+
+		if (score.IsEligible() && (best == nullptr || score.Value > bestScore)) {
+			best = &device;
+			bestScore = score.Value;
+		}
+	}
+
+	if (best == nullptr)
+		throw std::runtime_error("cannot find a suitable device");
+
+	return *best;
+}
+
+}
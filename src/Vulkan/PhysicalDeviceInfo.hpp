@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <string>
+#include <vector>
+
+namespace Vulkan {
+
+	// Capabilities of a physical device, queried once. The feature chains of a core version
+	// are only filled when both the device and the instance support that version.
+	// Presentation support is queried against the surface the device will render to.
+	class PhysicalDeviceInfo final {
+	public:
+
+		PhysicalDeviceInfo(VkPhysicalDevice physicalDevice, uint32_t instanceApiVersion, VkSurfaceKHR surface);
+
+		VkPhysicalDevice Handle() const { return physicalDevice_; }
+		uint32_t ApiVersion() const { return apiVersion_; }
+		const char* Name() const { return properties_.deviceName; }
+
+		const VkPhysicalDeviceProperties& Properties() const { return properties_; }
+		const VkPhysicalDeviceFeatures& Features() const { return features_; }
+		const VkPhysicalDeviceVulkan11Features& Features11() const { return features11_; }
+		const VkPhysicalDeviceVulkan12Features& Features12() const { return features12_; }
+#ifdef VK_API_VERSION_1_3
+		const VkPhysicalDeviceVulkan13Features& Features13() const { return features13_; }
+#endif
+		const VkPhysicalDeviceMemoryProperties& MemoryProperties() const { return memoryProperties_; }
+		const std::vector<VkQueueFamilyProperties>& QueueFamilies() const { return queueFamilies_; }
+		const std::vector<VkExtensionProperties>& Extensions() const { return extensions_; }
+
+		bool HasExtension(const char* extension) const;
+		bool HasExtensions(const std::vector<const char*>& extensions) const;
+
+		// Whether a queue family has all the required bits and none of the excluded ones
+		bool HasQueue(VkQueueFlags requiredBits, VkQueueFlags excludedBits) const;
+		bool HasAsyncComputeQueue() const { return HasQueue(VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT); }
+		bool HasDedicatedTransferQueue() const { return HasQueue(VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT); }
+		bool SupportsTimestamps() const;
+		// From the core 1.2 features, or from VK_KHR_timeline_semaphore on older versions
+		bool SupportsTimelineSemaphore() const { return timelineSemaphore_; }
+
+		bool CanPresent(uint32_t queueFamilyIndex) const { return presentSupport_[queueFamilyIndex] != VK_FALSE; }
+		bool CanPresent() const;
+
+		// Total size of the device local heaps
+		VkDeviceSize DeviceLocalMemory() const;
+
+	private:
+
+		VkPhysicalDevice physicalDevice_;
+		uint32_t apiVersion_;
+
+		VkPhysicalDeviceProperties properties_{};
+		VkPhysicalDeviceFeatures features_{};
+		VkPhysicalDeviceVulkan11Features features11_{};
+		VkPhysicalDeviceVulkan12Features features12_{};
+#ifdef VK_API_VERSION_1_3
+		VkPhysicalDeviceVulkan13Features features13_{};
+#endif
+		VkPhysicalDeviceMemoryProperties memoryProperties_{};
+		std::vector<VkQueueFamilyProperties> queueFamilies_;
+		std::vector<VkExtensionProperties> extensions_;
+		std::vector<VkBool32> presentSupport_;
+		bool timelineSemaphore_{};
+	};
+
+	// Selection policy: devices missing something the framework requires are rejected,
+	// the others are ranked by their expected throughput.
+	struct DeviceScore {
+		int64_t Value{};
+		std::string Rejection;
+
+		bool IsEligible() const { return Rejection.empty(); }
+	};
+
+	DeviceScore ScoreDevice(const PhysicalDeviceInfo& device);
+
+	// The override is either a device index or part of a device name (case insensitive), empty picks the best score
+	const PhysicalDeviceInfo& SelectDevice(const std::vector<PhysicalDeviceInfo>& devices, const std::string& override);
+
+}
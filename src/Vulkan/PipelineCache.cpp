@@ -0,0 +1,89 @@
+#include "PipelineCache.hpp"
+
+#include "Device.hpp"
+#include "../Utilities/Log.hpp"
+
+#include <cstring>
+#include <fstream>
+
+namespace Vulkan {
+
+PipelineCache::PipelineCache(const class Device& device, const std::vector<char>& initialData) : device_(device) {
+	const bool compatible = IsCompatible(initialData);
+
+	if (!initialData.empty() && !compatible)
+		LOG_WARNING("pipeline cache was saved by another device or driver, starting from an empty cache");
+
+	VkPipelineCacheCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = compatible ? initialData.size() : 0;
+	createInfo.pInitialData = compatible ? initialData.data() : nullptr;
+
+	Check(device.Dispatch().vkCreatePipelineCache(device.Handle(), &createInfo, device.Allocator(), &pipelineCache_), "create pipeline cache");
+}
+
+PipelineCache::~PipelineCache() {
+	if (pipelineCache_ != nullptr) {
+		device_.Dispatch().vkDestroyPipelineCache(device_.Handle(), pipelineCache_, device_.Allocator());
+		pipelineCache_ = nullptr;
+	}
+}
+
+std::vector<char> PipelineCache::Data() const {
+	size_t size = 0;
+	Check(device_.Dispatch().vkGetPipelineCacheData(device_.Handle(), pipelineCache_, &size, nullptr), "get pipeline cache size");
+
+	std::vector<char> data(size);
+	Check(device_.Dispatch().vkGetPipelineCacheData(device_.Handle(), pipelineCache_, &size, data.data()), "get pipeline cache data");
+	data.resize(size);
+
+	return data;
+}
+
+std::vector<char> PipelineCache::ReadFile(const std::string& filename) {
+	std::ifstream file(filename, std::ios::ate | std::ios::binary);
+
+	if (!file.is_open())
+		return {};
+
+	const auto fileSize = static_cast<size_t>(file.tellg());
+	std::vector<char> buffer(fileSize);
+
+	file.seekg(0);
+	file.read(buffer.data(), fileSize);
+
+	return file ? buffer : std::vector<char>();
+}
+
+void PipelineCache::WriteFile(const std::string& filename) const {
+	const auto data = Data();
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	file.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+	if (!file)
+		LOG_WARNING("failed to write pipeline cache '{}'", filename);
+}
+
+bool PipelineCache::IsCompatible(const std::vector<char>& data) const {
+	// Header version one: header size, header version, vendor ID, device ID and cache UUID
+	constexpr size_t headerSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+
+	if (data.size() < headerSize)
+		return false;
+
+	uint32_t header[4];
+	std::memcpy(header, data.data(), sizeof(header));
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device_.PhysicalDevice(), &properties);
+
+	return
+		header[0] >= headerSize &&
+		header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		header[2] == properties.vendorID &&
+		header[3] == properties.deviceID &&
+		std::memcmp(data.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+}
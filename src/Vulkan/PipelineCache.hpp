@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <string>
+#include <vector>
+
+namespace Vulkan {
+	class Device;
+
+	// Driver side cache of compiled pipelines, persisted between runs.
+	class PipelineCache final {
+	public:
+
+		VULKAN_NON_COPIABLE(PipelineCache)
+
+		// Data saved by another driver or device is ignored, the cache then starts empty
+		PipelineCache(const Device& device, const std::vector<char>& initialData);
+		~PipelineCache();
+
+		const class Device& Device() const { return device_; }
+
+		std::vector<char> Data() const;
+
+		// Empty when the file does not exist yet
+		static std::vector<char> ReadFile(const std::string& filename);
+		// Failures are only logged, losing the cache is not an error
+		void WriteFile(const std::string& filename) const;
+
+	private:
+
+		bool IsCompatible(const std::vector<char>& data) const;
+
+		const class Device& device_;
+
+		VULKAN_HANDLE(VkPipelineCache, pipelineCache_)
+	};
+
+}
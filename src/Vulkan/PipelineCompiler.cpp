@@ -0,0 +1,143 @@
+#include "PipelineCompiler.hpp"
+
+#include "GraphicsPipeline.hpp"
+#include "../Utilities/Log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace Vulkan {
+
+	namespace {
+		double Round(const double milliseconds) {
+			return std::round(milliseconds * 100.0) / 100.0;
+		}
+
+		uint32_t DefaultThreadCount() {
+			const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+	}
+
+PipelineCompiler::PipelineCompiler(const PipelineCache& pipelineCache, PipelineManifest manifest, const uint32_t threadCount) :
+	pipelineCache_(pipelineCache),
+	manifest_(std::move(manifest))
+{
+	const uint32_t count = threadCount != 0 ? threadCount : DefaultThreadCount();
+
+	for (uint32_t i = 0; i != count; ++i) {
+		workers_.emplace_back([this]() { Run(); });
+	}
+}
+
+PipelineCompiler::~PipelineCompiler() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+
+	jobAvailable_.notify_all();
+
+	// Queued jobs are still compiled, their futures may be waited for by pipeline sets being destroyed
+	for (auto& worker : workers_) {
+		worker.join();
+	}
+}
+
+std::future<std::unique_ptr<GraphicsPipeline>> PipelineCompiler::Submit(std::string name, CreateFunction create) {
+	Job job{ std::move(name), std::move(create), {} };
+	auto result = job.Result.get_future();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		jobs_.push_back(std::move(job));
+	}
+
+	jobAvailable_.notify_one();
+	return result;
+}
+
+std::unique_ptr<GraphicsPipeline> PipelineCompiler::Compile(const std::string& name, const CreateFunction& create) {
+	const auto start = std::chrono::steady_clock::now();
+	auto pipeline = create();
+	const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	LOG_WARNING("[pipelines] '{}' compiled on first use in {} ms, it is prewarmed from the manifest on the next run", name, Round(milliseconds));
+	RecordTiming({ name, milliseconds, true });
+
+	return pipeline;
+}
+
+void PipelineCompiler::Wait() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	idle_.wait(lock, [this]() { return jobs_.empty() && running_ == 0; });
+}
+
+void PipelineCompiler::Report() {
+	std::vector<Timing> timings;
+	{
+		std::lock_guard<std::mutex> lock(timingMutex_);
+		timings.swap(timings_);
+	}
+
+	if (timings.empty())
+		return;
+
+	std::sort(timings.begin(), timings.end(), [](const Timing& a, const Timing& b) { return a.Milliseconds > b.Milliseconds; });
+
+	double total = 0.0;
+	for (const auto& timing : timings) {
+		total += timing.Milliseconds;
+	}
+
+	LOG_INFO("[pipelines] {} compiled on {} threads, {} ms of compilation, slowest '{}' {} ms",
+		timings.size(), ThreadCount(), Round(total), timings.front().Name, Round(timings.front().Milliseconds));
+
+	for (const auto& timing : timings) {
+		LOG_VERBOSE("[pipelines] - '{}': {} ms{}", timing.Name, Round(timing.Milliseconds), timing.OnFirstUse ? " (on first use)" : "");
+	}
+}
+
+void PipelineCompiler::Run() {
+	for (;;) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			jobAvailable_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+
+			if (jobs_.empty())
+				return;
+
+			job = std::move(jobs_.front());
+			jobs_.pop_front();
+			++running_;
+		}
+
+		try {
+			const auto start = std::chrono::steady_clock::now();
+			auto pipeline = job.Create();
+			const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			RecordTiming({ job.Name, milliseconds, false });
+			job.Result.set_value(std::move(pipeline));
+		}
+		catch (...) {
+			job.Result.set_exception(std::current_exception());
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			--running_;
+		}
+
+		idle_.notify_all();
+	}
+}
+
+void PipelineCompiler::RecordTiming(Timing timing) {
+	std::lock_guard<std::mutex> lock(timingMutex_);
+	timings_.push_back(std::move(timing));
+}
+
+}
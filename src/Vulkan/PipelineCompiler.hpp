@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include "PipelineManifest.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Vulkan {
+	class GraphicsPipeline;
+	class PipelineCache;
+
+	// Graphics pipeline compilation on worker threads, all sharing the driver pipeline cache (pipeline creation
+	// is internally synchronized on it). Pipelines are submitted while the scene is loaded and waited for before
+	// the first frame; every compilation is timed, and Report logs them. The manifest of the pipelines used
+	// lives here so every pipeline set records into the same one.
+	class PipelineCompiler final {
+	public:
+
+		using CreateFunction = std::function<std::unique_ptr<GraphicsPipeline>()>;
+
+		struct Timing {
+			std::string Name;
+			double Milliseconds;
+			// Compiled on the calling thread when first used, a frame hitch
+			bool OnFirstUse;
+		};
+
+		VULKAN_NON_COPIABLE(PipelineCompiler)
+
+		// One worker per hardware thread but the main one when threadCount is zero
+		PipelineCompiler(const PipelineCache& pipelineCache, PipelineManifest manifest, uint32_t threadCount = 0);
+		~PipelineCompiler();
+
+		const PipelineCache& Cache() const { return pipelineCache_; }
+		PipelineManifest& Manifest() { return manifest_; }
+		uint32_t ThreadCount() const { return static_cast<uint32_t>(workers_.size()); }
+
+		// Compile on a worker thread, the future holds the creation exception on failure
+		std::future<std::unique_ptr<GraphicsPipeline>> Submit(std::string name, CreateFunction create);
+		// Compile on the calling thread, for pipelines needed right away that were neither prewarmed nor submitted
+		std::unique_ptr<GraphicsPipeline> Compile(const std::string& name, const CreateFunction& create);
+
+		// Block until every submitted pipeline is compiled
+		void Wait();
+
+		// Log and clear the compile times since the last report
+		void Report();
+
+	private:
+
+		struct Job {
+			std::string Name;
+			CreateFunction Create;
+			std::promise<std::unique_ptr<GraphicsPipeline>> Result;
+		};
+
+		void Run();
+		void RecordTiming(Timing timing);
+
+		const PipelineCache& pipelineCache_;
+		PipelineManifest manifest_;
+
+		std::mutex mutex_;
+		std::condition_variable jobAvailable_;
+		std::condition_variable idle_;
+		std::deque<Job> jobs_;
+		uint32_t running_{};
+		bool stopping_{};
+
+		std::mutex timingMutex_;
+		std::vector<Timing> timings_;
+
+		std::vector<std::thread> workers_;
+	};
+
+}
@@ -4,21 +4,24 @@
 
 namespace Vulkan {
 
-PipelineLayout::PipelineLayout(const Device & device) : device_(device) {
+PipelineLayout::PipelineLayout(const Device & device) : PipelineLayout(device, {}, {})
+{}
+
+PipelineLayout::PipelineLayout(const Device& device, const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges) : device_(device) {
 
 	VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
 	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipelineLayoutInfo.setLayoutCount = 0; // Optionnel
-	pipelineLayoutInfo.pSetLayouts = nullptr; // Optionnel
-	pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-	pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
+	pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+	pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+	pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+	pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
 
-	Check(vkCreatePipelineLayout(device_.Handle(), &pipelineLayoutInfo, nullptr, &pipelineLayout_), "create pipeline layout");
+	Check(device_.Dispatch().vkCreatePipelineLayout(device_.Handle(), &pipelineLayoutInfo, device_.Allocator(), &pipelineLayout_), "create pipeline layout");
 }
 
 PipelineLayout::~PipelineLayout() {
 	if (pipelineLayout_ != nullptr) {
-		vkDestroyPipelineLayout(device_.Handle(), pipelineLayout_, nullptr);
+		device_.Dispatch().vkDestroyPipelineLayout(device_.Handle(), pipelineLayout_, device_.Allocator());
 		pipelineLayout_ = nullptr;
 	}
 }
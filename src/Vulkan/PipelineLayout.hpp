@@ -2,6 +2,8 @@
 
 #include "Vulkan.hpp"
 
+#include <vector>
+
 namespace Vulkan {
 
 	class Device;
@@ -12,6 +14,7 @@ namespace Vulkan {
 		VULKAN_NON_COPIABLE(PipelineLayout)
 
 		PipelineLayout(const Device& device);
+		PipelineLayout(const Device& device, const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges);
 		~PipelineLayout();
 
 	private:
@@ -0,0 +1,124 @@
+#include "PipelineManifest.hpp"
+
+#include "../Utilities/Log.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace Vulkan {
+
+	namespace {
+		const char* const Header = "pipeline-manifest 1";
+
+		bool ParseEntry(const std::string& line, std::string& set, PipelineManifest::Entry& entry) {
+			std::istringstream in(line);
+			uint32_t polygonMode, cullMode, frontFace, blendMode, depthTest;
+
+			if (!(in >> set >> polygonMode >> cullMode >> frontFace >> blendMode >> depthTest) || blendMode > static_cast<uint32_t>(BlendMode::Additive))
+				return false;
+
+			entry.first = PipelineState()
+				.WithPolygonMode(static_cast<VkPolygonMode>(polygonMode))
+				.WithCullMode(cullMode)
+				.WithFrontFace(static_cast<VkFrontFace>(frontFace))
+				.WithBlendMode(static_cast<BlendMode>(blendMode))
+				.WithDepthTest(depthTest != 0);
+			entry.second = ShaderVariant();
+
+			std::string constant;
+			while (in >> constant) {
+				uint32_t id, value;
+				char separator;
+				std::istringstream constantIn(constant);
+
+				if (!(constantIn >> id >> separator >> value) || separator != '=')
+					return false;
+
+				entry.second = entry.second.With(static_cast<ShaderFeature>(id), value);
+			}
+
+			return true;
+		}
+	}
+
+size_t PipelineManifest::Size() const {
+	size_t size = 0;
+	for (const auto& set : sets_) {
+		size += set.second.size();
+	}
+
+	return size;
+}
+
+const std::vector<PipelineManifest::Entry>& PipelineManifest::Entries(const std::string& set) const {
+	static const std::vector<Entry> none;
+	const auto entries = sets_.find(set);
+
+	return entries != sets_.end() ? entries->second : none;
+}
+
+void PipelineManifest::Record(const std::string& set, const PipelineState& state, const ShaderVariant& variant) {
+	auto& entries = sets_[set];
+	const Entry entry(state, variant);
+
+	if (std::find(entries.begin(), entries.end(), entry) == entries.end())
+		entries.push_back(entry);
+}
+
+std::string PipelineManifest::Describe(const std::string& set, const PipelineState& state, const ShaderVariant& variant) {
+	std::ostringstream out;
+	out << set
+		<< ' ' << static_cast<uint32_t>(state.PolygonMode())
+		<< ' ' << static_cast<uint32_t>(state.CullMode())
+		<< ' ' << static_cast<uint32_t>(state.FrontFace())
+		<< ' ' << static_cast<uint32_t>(state.Blend())
+		<< ' ' << (state.DepthTest() ? 1 : 0);
+
+	const auto specializationInfo = variant.SpecializationInfo();
+	const auto* const values = static_cast<const uint32_t*>(specializationInfo.pData);
+
+	for (uint32_t i = 0; i != specializationInfo.mapEntryCount; ++i) {
+		out << ' ' << specializationInfo.pMapEntries[i].constantID << '=' << values[i];
+	}
+
+	return out.str();
+}
+
+PipelineManifest PipelineManifest::ReadFile(const std::string& filename) {
+	PipelineManifest manifest;
+	std::ifstream file(filename);
+	std::string line;
+
+	// A manifest of another format version is ignored, like a pipeline cache of another driver
+	if (!file.is_open() || !std::getline(file, line) || line != Header)
+		return manifest;
+
+	while (std::getline(file, line)) {
+		std::string set;
+		Entry entry;
+
+		if (ParseEntry(line, set, entry))
+			manifest.Record(set, entry.first, entry.second);
+		else if (!line.empty())
+			LOG_WARNING("skipped malformed pipeline manifest line '{}'", line);
+	}
+
+	return manifest;
+}
+
+void PipelineManifest::WriteFile(const std::string& filename) const {
+	std::ofstream file(filename, std::ios::trunc);
+	file << Header << '\n';
+
+	for (const auto& set : sets_) {
+		for (const auto& entry : set.second) {
+			file << Describe(set.first, entry.first, entry.second) << '\n';
+		}
+	}
+
+	if (!file)
+		LOG_WARNING("failed to write pipeline manifest '{}'", filename);
+}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "PipelineState.hpp"
+#include "ShaderVariant.hpp"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Vulkan {
+
+	// Graphics pipelines a run used, recorded per pipeline set (a pair of shaders) and saved for the next run,
+	// which compiles them all in parallel before its first frame instead of on first use.
+	// One line per pipeline: set name, polygon mode, cull mode, front face, blend mode, depth test, then the
+	// specialization constants as id=value.
+	class PipelineManifest final {
+	public:
+
+		using Entry = std::pair<PipelineState, ShaderVariant>;
+
+		size_t Size() const;
+
+		// Entries read from the previous run, then the ones recorded by this one
+		const std::vector<Entry>& Entries(const std::string& set) const;
+		void Record(const std::string& set, const PipelineState& state, const ShaderVariant& variant);
+
+		// Text of a manifest line, also naming the pipeline in compile time reports
+		static std::string Describe(const std::string& set, const PipelineState& state, const ShaderVariant& variant);
+
+		// Empty when the file does not exist yet, malformed lines are skipped
+		static PipelineManifest ReadFile(const std::string& filename);
+		// Failures are only logged, losing the manifest is not an error
+		void WriteFile(const std::string& filename) const;
+
+	private:
+
+		std::map<std::string, std::vector<Entry>> sets_;
+	};
+
+}
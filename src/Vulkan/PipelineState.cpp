@@ -0,0 +1,88 @@
+#include "PipelineState.hpp"
+
+#include <cstdint>
+
+namespace Vulkan {
+
+	namespace {
+		// FNV-1a, folding one 32 bits field at a time
+		constexpr uint64_t FnvOffsetBasis = 14695981039346656037ull;
+		constexpr uint64_t FnvPrime = 1099511628211ull;
+
+		uint64_t HashCombine(uint64_t hash, const uint32_t value) {
+			for (int i = 0; i != 4; ++i) {
+				hash ^= (value >> (i * 8)) & 0xFF;
+				hash *= FnvPrime;
+			}
+
+			return hash;
+		}
+	}
+
+PipelineState::PipelineState() :
+	polygonMode_(VK_POLYGON_MODE_FILL),
+	cullMode_(VK_CULL_MODE_BACK_BIT),
+	frontFace_(VK_FRONT_FACE_COUNTER_CLOCKWISE),
+	blendMode_(BlendMode::Opaque),
+	depthTest_(false)
+{
+	UpdateHash();
+}
+
+PipelineState PipelineState::WithPolygonMode(const VkPolygonMode polygonMode) const {
+	PipelineState state(*this);
+	state.polygonMode_ = polygonMode;
+	state.UpdateHash();
+	return state;
+}
+
+PipelineState PipelineState::WithCullMode(const VkCullModeFlags cullMode) const {
+	PipelineState state(*this);
+	state.cullMode_ = cullMode;
+	state.UpdateHash();
+	return state;
+}
+
+PipelineState PipelineState::WithFrontFace(const VkFrontFace frontFace) const {
+	PipelineState state(*this);
+	state.frontFace_ = frontFace;
+	state.UpdateHash();
+	return state;
+}
+
+PipelineState PipelineState::WithBlendMode(const BlendMode blendMode) const {
+	PipelineState state(*this);
+	state.blendMode_ = blendMode;
+	state.UpdateHash();
+	return state;
+}
+
+PipelineState PipelineState::WithDepthTest(const bool depthTest) const {
+	PipelineState state(*this);
+	state.depthTest_ = depthTest;
+	state.UpdateHash();
+	return state;
+}
+
+bool PipelineState::operator == (const PipelineState& other) const {
+	return
+		hash_ == other.hash_ &&
+		polygonMode_ == other.polygonMode_ &&
+		cullMode_ == other.cullMode_ &&
+		frontFace_ == other.frontFace_ &&
+		blendMode_ == other.blendMode_ &&
+		depthTest_ == other.depthTest_;
+}
+
+void PipelineState::UpdateHash() {
+	uint64_t hash = FnvOffsetBasis;
+	hash = HashCombine(hash, static_cast<uint32_t>(polygonMode_));
+	hash = HashCombine(hash, static_cast<uint32_t>(cullMode_));
+	hash = HashCombine(hash, static_cast<uint32_t>(frontFace_));
+	hash = HashCombine(hash, static_cast<uint32_t>(blendMode_));
+	hash = HashCombine(hash, static_cast<uint32_t>(depthTest_));
+
+	hash_ = static_cast<size_t>(hash);
+}
+
+}
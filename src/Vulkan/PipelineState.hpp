@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <cstddef>
+#include <functional>
+
+namespace Vulkan {
+
+	// Color blending of the attachment, Alpha and Additive weigh the source by its alpha
+	enum class BlendMode {
+		Opaque,
+		Alpha,
+		Additive
+	};
+
+	// Fixed-function state a graphics pipeline variant is built from.
+	// The hash is computed once when the state changes, so cache lookups never rehash it.
+	class PipelineState final {
+	public:
+
+		PipelineState();
+
+		VkPolygonMode PolygonMode() const { return polygonMode_; }
+		VkCullModeFlags CullMode() const { return cullMode_; }
+		VkFrontFace FrontFace() const { return frontFace_; }
+		BlendMode Blend() const { return blendMode_; }
+		bool BlendEnable() const { return blendMode_ != BlendMode::Opaque; }
+		// Depth tested and written, nearer or equal fragments pass
+		bool DepthTest() const { return depthTest_; }
+		size_t Hash() const { return hash_; }
+
+		PipelineState WithPolygonMode(VkPolygonMode polygonMode) const;
+		PipelineState WithCullMode(VkCullModeFlags cullMode) const;
+		PipelineState WithFrontFace(VkFrontFace frontFace) const;
+		PipelineState WithBlendMode(BlendMode blendMode) const;
+		PipelineState WithDepthTest(bool depthTest) const;
+
+		bool operator == (const PipelineState& other) const;
+		bool operator != (const PipelineState& other) const { return !(*this == other); }
+
+	private:
+
+		void UpdateHash();
+
+		VkPolygonMode polygonMode_;
+		VkCullModeFlags cullMode_;
+		VkFrontFace frontFace_;
+		BlendMode blendMode_;
+		bool depthTest_;
+
+		size_t hash_{};
+	};
+
+}
+
+namespace std {
+
+	template <>
+	struct hash<Vulkan::PipelineState> {
+		size_t operator () (const Vulkan::PipelineState& state) const noexcept { return state.Hash(); }
+	};
+
+}
@@ -0,0 +1,105 @@
+#include "PipelineVariants.hpp"
+
+#include "PipelineCompiler.hpp"
+#include "PipelineManifest.hpp"
+#include "ShaderModule.hpp"
+
+#include <utility>
+
+namespace Vulkan {
+
+PipelineVariants::PipelineVariants(
+	const Device& device,
+	PipelineCompiler& pipelineCompiler,
+	std::string name,
+	const PipelineLayout& pipelineLayout,
+	const RenderPass* const renderPass,
+	const VkFormat colorFormat,
+	const VkFormat depthFormat,
+	const std::vector<char>& vertShaderCode,
+	const std::vector<char>& fragShaderCode,
+	VertexInput vertexInput) :
+	device_(device),
+	pipelineCompiler_(pipelineCompiler),
+	name_(std::move(name)),
+	pipelineLayout_(pipelineLayout),
+	renderPass_(renderPass),
+	colorFormat_(colorFormat),
+	depthFormat_(depthFormat),
+	vertexInput_(std::move(vertexInput))
+{
+	vertShader_.reset(new ShaderModule(device, vertShaderCode));
+	fragShader_.reset(new ShaderModule(device, fragShaderCode));
+
+	for (const auto& entry : pipelineCompiler.Manifest().Entries(name_)) {
+		Submit(Key{ entry.first, entry.second });
+	}
+}
+
+PipelineVariants::~PipelineVariants() {
+	// The compiler threads use the shader modules and the layout until the submitted pipelines are done
+	for (auto& pipeline : pipelines_) {
+		if (pipeline.second.Pending.valid())
+			pipeline.second.Pending.wait();
+	}
+
+	pipelines_.clear();
+	fragShader_.reset();
+	vertShader_.reset();
+}
+
+const GraphicsPipeline& PipelineVariants::Get(const PipelineState& state, const ShaderVariant& variant) {
+	const Key key{ state, variant };
+	auto pipeline = pipelines_.find(key);
+
+	if (pipeline == pipelines_.end()) {
+		auto compiled = pipelineCompiler_.Compile(PipelineManifest::Describe(name_, state, variant), [this, &key]() { return Create(key); });
+		pipeline = pipelines_.emplace(key, Entry()).first;
+		pipeline->second.Pipeline = std::move(compiled);
+	}
+
+	auto& entry = pipeline->second;
+
+	if (entry.Pending.valid())
+		entry.Pipeline = entry.Pending.get();
+
+	if (!entry.Recorded) {
+		pipelineCompiler_.Manifest().Record(name_, state, variant);
+		entry.Recorded = true;
+	}
+
+	return *entry.Pipeline;
+}
+
+void PipelineVariants::Prewarm(const std::vector<PipelineState>& states, const std::vector<ShaderVariant>& variants) {
+	for (const auto& state : states) {
+		for (const auto& variant : variants) {
+			Submit(Key{ state, variant });
+		}
+	}
+}
+
+void PipelineVariants::Submit(const Key& key) {
+	if (pipelines_.count(key) != 0)
+		return;
+
+	// Pipeline creation is free threaded, the pipeline cache is synchronized internally
+	pipelines_[key].Pending = pipelineCompiler_.Submit(PipelineManifest::Describe(name_, key.State, key.Variant), [this, key]() { return Create(key); });
+}
+
+std::unique_ptr<GraphicsPipeline> PipelineVariants::Create(const Key& key) const {
+	// Both stages read the same constants, a stage ignores the ids it does not declare
+	const auto specializationInfo = key.Variant.SpecializationInfo();
+	const auto* const specialization = key.Variant.IsEmpty() ? nullptr : &specializationInfo;
+
+	const std::vector<VkPipelineShaderStageCreateInfo> shaderStages =
+	{
+		vertShader_->CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT, specialization),
+		fragShader_->CreateShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT, specialization)
+	};
+
+	return std::make_unique<GraphicsPipeline>(
+		device_, pipelineCompiler_.Cache(), pipelineLayout_, renderPass_, colorFormat_, depthFormat_, shaderStages, key.State, vertexInput_);
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include "GraphicsPipeline.hpp"
+#include "PipelineState.hpp"
+#include "ShaderVariant.hpp"
+
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Vulkan {
+	class Device;
+	class PipelineCompiler;
+	class PipelineLayout;
+	class RenderPass;
+	class ShaderModule;
+
+	// Graphics pipeline permutations of one pair of shaders: every pipeline state and shader variant combination
+	// is created once, on first use or when prewarmed, and kept. Variants specialize both shader stages.
+	// Prewarmed pipelines compile on the compiler threads, starting with the ones the manifest recorded for this
+	// set; Get only waits for the pipeline it needs, and records it in the manifest the first time.
+	class PipelineVariants final {
+	public:
+
+		VULKAN_NON_COPIABLE(PipelineVariants)
+
+		PipelineVariants(
+			const Device& device,
+			PipelineCompiler& pipelineCompiler,
+			std::string name,
+			const PipelineLayout& pipelineLayout,
+			const RenderPass* renderPass,
+			VkFormat colorFormat,
+			VkFormat depthFormat,
+			const std::vector<char>& vertShaderCode,
+			const std::vector<char>& fragShaderCode,
+			VertexInput vertexInput = {});
+		~PipelineVariants();
+
+		const std::string& Name() const { return name_; }
+
+		const GraphicsPipeline& Get(const PipelineState& state, const ShaderVariant& variant = ShaderVariant());
+
+		// Submit every combination not created yet to the compiler, without waiting for them
+		void Prewarm(const std::vector<PipelineState>& states, const std::vector<ShaderVariant>& variants = { ShaderVariant() });
+
+	private:
+
+		struct Key {
+			PipelineState State;
+			ShaderVariant Variant;
+
+			bool operator == (const Key& other) const { return State == other.State && Variant == other.Variant; }
+		};
+
+		struct KeyHash {
+			size_t operator () (const Key& key) const noexcept { return key.State.Hash() ^ (key.Variant.Hash() * 31); }
+		};
+
+		struct Entry {
+			std::unique_ptr<GraphicsPipeline> Pipeline;
+			// Valid until the compiled pipeline is taken by Get
+			std::future<std::unique_ptr<GraphicsPipeline>> Pending;
+			bool Recorded{};
+		};
+
+		void Submit(const Key& key);
+		std::unique_ptr<GraphicsPipeline> Create(const Key& key) const;
+
+		const Device& device_;
+		PipelineCompiler& pipelineCompiler_;
+		const std::string name_;
+		const PipelineLayout& pipelineLayout_;
+		const RenderPass* const renderPass_;
+		const VkFormat colorFormat_;
+		const VkFormat depthFormat_;
+		const VertexInput vertexInput_;
+
+		std::unique_ptr<ShaderModule> vertShader_;
+		std::unique_ptr<ShaderModule> fragShader_;
+
+		std::unordered_map<Key, Entry, KeyHash> pipelines_;
+	};
+
+}
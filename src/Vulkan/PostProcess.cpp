@@ -0,0 +1,322 @@
+#include "PostProcess.hpp"
+
+#include "ComputePipeline.hpp"
+#include "DepthBuffer.hpp"
+#include "DescriptorPool.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+#include "FrameBuffer.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+#include "PipelineLayout.hpp"
+#include "Sampler.hpp"
+#include "ShaderModule.hpp"
+#include "SwapChain.hpp"
+
+#include <algorithm>
+
+namespace Vulkan {
+
+	namespace {
+		constexpr uint32_t WorkGroupSize = 8;
+		constexpr VkFormat OutputFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+		struct DownsampleConstants {
+			uint32_t Prefilter;
+			float Threshold;
+			float Knee;
+		};
+
+		struct UpsampleConstants {
+			float Radius;
+		};
+
+		struct CompositeConstants {
+			float Exposure;
+			float BloomStrength;
+			float Sharpness;
+			uint32_t EncodeSrgb;
+		};
+
+		uint32_t GroupCount(const uint32_t size) {
+			return (size + WorkGroupSize - 1) / WorkGroupSize;
+		}
+
+		VkDescriptorImageInfo SampledImage(const Sampler& sampler, const ImageView& imageView, const VkImageLayout layout) {
+			return { sampler.Handle(), imageView.Handle(), layout };
+		}
+
+		VkDescriptorImageInfo StorageImage(const ImageView& imageView) {
+			return { VK_NULL_HANDLE, imageView.Handle(), VK_IMAGE_LAYOUT_GENERAL };
+		}
+
+		VkWriteDescriptorSet Write(const VkDescriptorSet set, const uint32_t binding, const VkDescriptorType type, const VkDescriptorImageInfo& imageInfo) {
+			VkWriteDescriptorSet write = {};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = set;
+			write.dstBinding = binding;
+			write.descriptorCount = 1;
+			write.descriptorType = type;
+			write.pImageInfo = &imageInfo;
+			return write;
+		}
+
+		VkImageMemoryBarrier ImageBarrier(const VkImage image, const uint32_t mipLevels, const VkImageLayout oldLayout, const VkImageLayout newLayout, const VkAccessFlags srcAccess, const VkAccessFlags dstAccess) {
+			VkImageMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstAccessMask = dstAccess;
+			barrier.oldLayout = oldLayout;
+			barrier.newLayout = newLayout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image;
+			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1 };
+			return barrier;
+		}
+	}
+
+PostProcess::PostProcess(const SwapChain& swapChain, const PipelineCache& pipelineCache, const RenderPass* const renderPass, const DepthBuffer& depthBuffer, const uint32_t frameCount) :
+	swapChain_(swapChain)
+{
+	const auto& device = swapChain.Device();
+	const auto& extent = swapChain.Extent();
+
+	// Stop before the levels get too small to add anything
+	bloomLevels_ = 1;
+	while (bloomLevels_ != MaxBloomLevels) {
+		const auto next = BloomExtent(bloomLevels_);
+		if (std::min(next.width, next.height) < 4)
+			break;
+		++bloomLevels_;
+	}
+
+	sampler_.reset(new Sampler(device, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE));
+
+	filterSetLayout_.reset(new DescriptorSetLayout(device, {
+		{ 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+		{ 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr }
+	}));
+
+	compositeSetLayout_.reset(new DescriptorSetLayout(device, {
+		{ 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+		{ 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+		{ 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr }
+	}));
+
+	// Downsample and upsample share a layout, the range covers the larger of their constants
+	filterPipelineLayout_.reset(new PipelineLayout(device, { filterSetLayout_->Handle() }, { { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(DownsampleConstants) } }));
+	compositePipelineLayout_.reset(new PipelineLayout(device, { compositeSetLayout_->Handle() }, { { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CompositeConstants) } }));
+
+	{
+		const ShaderModule downsample(device, "../assets/shaders/bloom_downsample.comp.spv");
+		const ShaderModule upsample(device, "../assets/shaders/bloom_upsample.comp.spv");
+		const ShaderModule composite(device, "../assets/shaders/post_composite.comp.spv");
+
+		downsamplePipeline_.reset(new ComputePipeline(device, pipelineCache, *filterPipelineLayout_, downsample));
+		upsamplePipeline_.reset(new ComputePipeline(device, pipelineCache, *filterPipelineLayout_, upsample));
+		compositePipeline_.reset(new ComputePipeline(device, pipelineCache, *compositePipelineLayout_, composite));
+	}
+
+	bloom_.reset(new Image(
+		device, BloomExtent(0), bloomLevels_, HdrFormat, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		{ device.ComputeFamilyIndex() }, "bloom pyramid"));
+
+	for (uint32_t level = 0; level != bloomLevels_; ++level) {
+		bloomViews_.push_back(std::make_unique<ImageView>(device, bloom_->Handle(), HdrFormat, VK_IMAGE_ASPECT_COLOR_BIT, level));
+	}
+
+	// Per frame: every downsample and upsample step reads one combined image sampler and writes one storage image,
+	// the composite reads two and writes one
+	const uint32_t setsPerFrame = 2 * bloomLevels_;
+	descriptorPool_.reset(new DescriptorPool(device, {
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, frameCount * (setsPerFrame + 1) },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, frameCount * setsPerFrame }
+	}, frameCount * setsPerFrame, 0));
+
+	const std::vector<uint32_t> sharedFamilies = { device.GraphicsFamilyIndex(), device.ComputeFamilyIndex() };
+
+	frames_.resize(frameCount);
+	for (auto& frame : frames_) {
+		frame.Hdr.reset(new Image(
+			device, extent, 1, HdrFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			sharedFamilies, "hdr target"));
+		frame.HdrView.reset(new ImageView(device, frame.Hdr->Handle(), HdrFormat, VK_IMAGE_ASPECT_COLOR_BIT));
+
+		if (renderPass != nullptr)
+			frame.HdrFrameBuffer.reset(new FrameBuffer(*frame.HdrView, *renderPass, extent, &depthBuffer.ImageView()));
+
+		frame.Output.reset(new Image(
+			device, extent, 1, OutputFormat, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+			sharedFamilies, "post process output"));
+		frame.OutputView.reset(new ImageView(device, frame.Output->Handle(), OutputFormat, VK_IMAGE_ASPECT_COLOR_BIT));
+
+		CreateDescriptorSets(frame);
+	}
+}
+
+PostProcess::~PostProcess() {
+	frames_.clear();
+	descriptorPool_.reset();
+	bloomViews_.clear();
+	bloom_.reset();
+	compositePipeline_.reset();
+	upsamplePipeline_.reset();
+	downsamplePipeline_.reset();
+	compositePipelineLayout_.reset();
+	filterPipelineLayout_.reset();
+	compositeSetLayout_.reset();
+	filterSetLayout_.reset();
+	sampler_.reset();
+}
+
+VkImage PostProcess::HdrImage(const uint32_t frame) const {
+	return frames_[frame].Hdr->Handle();
+}
+
+void PostProcess::Record(VkCommandBuffer commandBuffer, const uint32_t frameIndex) {
+	const auto& dispatch = swapChain_.Device().Dispatch();
+	const auto& frame = frames_[frameIndex];
+	const auto& extent = swapChain_.Extent();
+
+	// The pyramid and the output are fully rewritten, their previous content is discarded
+	const VkImageMemoryBarrier toGeneral[] = {
+		ImageBarrier(bloom_->Handle(), bloomLevels_, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT),
+		ImageBarrier(frame.Output->Handle(), 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT)
+	};
+
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		0, nullptr, 0, nullptr, 2, toGeneral);
+
+	// Each step reads what the previous one wrote
+	VkMemoryBarrier stepBarrier = {};
+	stepBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	stepBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	stepBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+	const auto step = [&](const VkDescriptorSet set, const VkExtent2D size) {
+		dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, filterPipelineLayout_->Handle(), 0, 1, &set, 0, nullptr);
+		dispatch.vkCmdDispatch(commandBuffer, GroupCount(size.width), GroupCount(size.height), 1);
+		dispatch.vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+			1, &stepBarrier, 0, nullptr, 0, nullptr);
+	};
+
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, downsamplePipeline_->Handle());
+
+	for (uint32_t level = 0; level != bloomLevels_; ++level) {
+		const DownsampleConstants constants = { level == 0 ? 1u : 0u, settings_.BloomThreshold, settings_.BloomKnee };
+		dispatch.vkCmdPushConstants(commandBuffer, filterPipelineLayout_->Handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+		step(frame.DescriptorSets[level], BloomExtent(level));
+	}
+
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, upsamplePipeline_->Handle());
+
+	const UpsampleConstants upsampleConstants = { settings_.BloomRadius };
+	dispatch.vkCmdPushConstants(commandBuffer, filterPipelineLayout_->Handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(upsampleConstants), &upsampleConstants);
+
+	for (uint32_t i = 0; i + 1 < bloomLevels_; ++i) {
+		step(frame.DescriptorSets[bloomLevels_ + i], BloomExtent(bloomLevels_ - 2 - i));
+	}
+
+	const CompositeConstants compositeConstants = {
+		settings_.Exposure,
+		settings_.BloomStrength,
+		settings_.Sharpness,
+		swapChain_.Format() == VK_FORMAT_B8G8R8A8_SRGB || swapChain_.Format() == VK_FORMAT_R8G8B8A8_SRGB ? 0u : 1u
+	};
+
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, compositePipeline_->Handle());
+	dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, compositePipelineLayout_->Handle(), 0, 1, &frame.DescriptorSets.back(), 0, nullptr);
+	dispatch.vkCmdPushConstants(commandBuffer, compositePipelineLayout_->Handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(compositeConstants), &compositeConstants);
+	dispatch.vkCmdDispatch(commandBuffer, GroupCount(extent.width), GroupCount(extent.height), 1);
+
+	// Ready for the copy on the graphics queue, the semaphore between the submissions makes the writes visible
+	const VkImageMemoryBarrier toTransfer = ImageBarrier(
+		frame.Output->Handle(), 1, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, 0);
+
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toTransfer);
+}
+
+void PostProcess::CopyToSwapChain(VkCommandBuffer commandBuffer, const uint32_t frameIndex, const uint32_t imageIndex) {
+	const auto& dispatch = swapChain_.Device().Dispatch();
+	const auto& extent = swapChain_.Extent();
+	const VkImage image = swapChain_.Images()[imageIndex];
+
+	const VkImageMemoryBarrier toTransfer = ImageBarrier(
+		image, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toTransfer);
+
+	// A blit rather than a copy, it swizzles RGBA to the swap chain BGRA
+	VkImageBlit region = {};
+	region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.srcOffsets[1] = { static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1 };
+	region.dstSubresource = region.srcSubresource;
+	region.dstOffsets[1] = region.srcOffsets[1];
+
+	dispatch.vkCmdBlitImage(commandBuffer,
+		frames_[frameIndex].Output->Handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		1, &region, VK_FILTER_NEAREST);
+
+	// The overlay and the frame readbacks may follow, in the same command buffer
+	const VkImageMemoryBarrier toPresent = ImageBarrier(
+		image, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT);
+
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toPresent);
+}
+
+void PostProcess::CreateDescriptorSets(Frame& frame) {
+	const auto& device = swapChain_.Device();
+
+	frame.DescriptorSets = descriptorPool_->Allocate(*filterSetLayout_, 2 * bloomLevels_ - 1);
+	frame.DescriptorSets.push_back(descriptorPool_->Allocate(*compositeSetLayout_, 1).front());
+
+	// Image infos must stay in place until the update, every write points to one
+	std::vector<VkDescriptorImageInfo> imageInfos;
+	imageInfos.reserve(4 * bloomLevels_ + 1);
+	std::vector<VkWriteDescriptorSet> writes;
+
+	const auto add = [&](const VkDescriptorSet set, const uint32_t binding, const VkDescriptorType type, const VkDescriptorImageInfo& imageInfo) {
+		imageInfos.push_back(imageInfo);
+		writes.push_back(Write(set, binding, type, imageInfos.back()));
+	};
+
+	for (uint32_t level = 0; level != bloomLevels_; ++level) {
+		const auto set = frame.DescriptorSets[level];
+		add(set, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, level == 0
+			? SampledImage(*sampler_, *frame.HdrView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+			: SampledImage(*sampler_, *bloomViews_[level - 1], VK_IMAGE_LAYOUT_GENERAL));
+		add(set, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, StorageImage(*bloomViews_[level]));
+	}
+
+	for (uint32_t i = 0; i + 1 < bloomLevels_; ++i) {
+		const uint32_t level = bloomLevels_ - 2 - i;
+		const auto set = frame.DescriptorSets[bloomLevels_ + i];
+		add(set, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, SampledImage(*sampler_, *bloomViews_[level + 1], VK_IMAGE_LAYOUT_GENERAL));
+		add(set, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, StorageImage(*bloomViews_[level]));
+	}
+
+	const auto composite = frame.DescriptorSets.back();
+	add(composite, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, SampledImage(*sampler_, *frame.HdrView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+	add(composite, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, SampledImage(*sampler_, *bloomViews_[0], VK_IMAGE_LAYOUT_GENERAL));
+	add(composite, 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, StorageImage(*frame.OutputView));
+
+	device.Dispatch().vkUpdateDescriptorSets(device.Handle(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+VkExtent2D PostProcess::BloomExtent(const uint32_t level) const {
+	const auto& extent = swapChain_.Extent();
+	return { std::max(1u, (extent.width / 2) >> level), std::max(1u, (extent.height / 2) >> level) };
+}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Vulkan {
+	class ComputePipeline;
+	class DepthBuffer;
+	class DescriptorPool;
+	class DescriptorSetLayout;
+	class FrameBuffer;
+	class Image;
+	class ImageView;
+	class PipelineCache;
+	class PipelineLayout;
+	class RenderPass;
+	class Sampler;
+	class SwapChain;
+
+	// Post-processing chain run on the compute queue: bloom (a downsample then upsample pyramid), tonemapping and sharpening.
+	// The scene is rendered to an HDR target, one per frame in flight so the next frame geometry can be drawn while
+	// the chain still reads the previous one. The result goes to an LDR image the graphics queue then copies to
+	// the swap chain image: B8G8R8A8 swap chain images cannot be written by compute shaders on every device.
+	class PostProcess final {
+	public:
+
+		struct Settings {
+			float Exposure = 1.0f;
+			// Brightness above which the scene blooms, with a soft knee below it
+			float BloomThreshold = 0.8f;
+			float BloomKnee = 0.4f;
+			float BloomStrength = 0.06f;
+			// Upsample filter radius, in texels of the lower level
+			float BloomRadius = 1.0f;
+			// 0 to 1, the contrast adaptive sharpening is never fully off
+			float Sharpness = 0.3f;
+		};
+
+		VULKAN_NON_COPIABLE(PostProcess)
+
+		static constexpr VkFormat HdrFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+		static constexpr uint32_t MaxBloomLevels = 6;
+
+		// The render pass is the scene one (null with dynamic rendering), the HDR framebuffers are created for it
+		// along with the scene depth buffer
+		PostProcess(const SwapChain& swapChain, const PipelineCache& pipelineCache, const RenderPass* renderPass, const DepthBuffer& depthBuffer, uint32_t frameCount);
+		~PostProcess();
+
+		struct Settings& Settings() { return settings_; }
+
+		// HDR scene target of a frame in flight, left in shader read only layout by the scene rendering
+		VkImage HdrImage(uint32_t frame) const;
+		const ImageView& HdrImageView(uint32_t frame) const { return *frames_[frame].HdrView; }
+		// Null with dynamic rendering
+		const FrameBuffer* HdrFrameBuffer(uint32_t frame) const { return frames_[frame].HdrFrameBuffer.get(); }
+
+		// Record the chain in a compute queue command buffer, submitted after the frame scene rendering
+		void Record(VkCommandBuffer commandBuffer, uint32_t frame);
+		// Record the copy to the swap chain image (left in present layout) in a graphics queue command buffer,
+		// submitted after the chain
+		void CopyToSwapChain(VkCommandBuffer commandBuffer, uint32_t frame, uint32_t imageIndex);
+
+	private:
+
+		struct Frame {
+			std::unique_ptr<Image> Hdr;
+			std::unique_ptr<ImageView> HdrView;
+			std::unique_ptr<FrameBuffer> HdrFrameBuffer;
+			std::unique_ptr<Image> Output;
+			std::unique_ptr<ImageView> OutputView;
+			// Downsample steps, then upsample steps, then the composite
+			std::vector<VkDescriptorSet> DescriptorSets;
+		};
+
+		void CreateDescriptorSets(Frame& frame);
+		VkExtent2D BloomExtent(uint32_t level) const;
+
+		const SwapChain& swapChain_;
+		struct Settings settings_;
+		uint32_t bloomLevels_{};
+
+		std::unique_ptr<Sampler> sampler_;
+
+		std::unique_ptr<DescriptorSetLayout> filterSetLayout_;
+		std::unique_ptr<DescriptorSetLayout> compositeSetLayout_;
+		std::unique_ptr<PipelineLayout> filterPipelineLayout_;
+		std::unique_ptr<PipelineLayout> compositePipelineLayout_;
+		std::unique_ptr<ComputePipeline> downsamplePipeline_;
+		std::unique_ptr<ComputePipeline> upsamplePipeline_;
+		std::unique_ptr<ComputePipeline> compositePipeline_;
+		std::unique_ptr<DescriptorPool> descriptorPool_;
+
+		// Only used by the compute queue, frames are chained there so a single pyramid is enough
+		std::unique_ptr<Image> bloom_;
+		std::vector<std::unique_ptr<ImageView>> bloomViews_;
+
+		std::vector<Frame> frames_;
+	};
+
+}
@@ -0,0 +1,62 @@
+#include "QueueSubmission.hpp"
+#include "Device.hpp"
+#include "TimelineSemaphore.hpp"
+
+namespace Vulkan {
+
+// Binary semaphores ignore their entry in the timeline value arrays, zero is used as a placeholder.
+
+QueueSubmission& QueueSubmission::Wait(VkSemaphore semaphore, const VkPipelineStageFlags stage) {
+	waitSemaphores_.push_back(semaphore);
+	waitValues_.push_back(0);
+	waitStages_.push_back(stage);
+	return *this;
+}
+
+QueueSubmission& QueueSubmission::Wait(const TimelineSemaphore& timeline, const uint64_t value, const VkPipelineStageFlags stage) {
+	waitSemaphores_.push_back(timeline.Handle());
+	waitValues_.push_back(value);
+	waitStages_.push_back(stage);
+	return *this;
+}
+
+QueueSubmission& QueueSubmission::Signal(VkSemaphore semaphore) {
+	signalSemaphores_.push_back(semaphore);
+	signalValues_.push_back(0);
+	return *this;
+}
+
+QueueSubmission& QueueSubmission::Signal(const TimelineSemaphore& timeline, const uint64_t value) {
+	signalSemaphores_.push_back(timeline.Handle());
+	signalValues_.push_back(value);
+	return *this;
+}
+
+QueueSubmission& QueueSubmission::Execute(VkCommandBuffer commandBuffer) {
+	commandBuffers_.push_back(commandBuffer);
+	return *this;
+}
+
+void QueueSubmission::Submit(const Device& device, VkQueue queue, VkFence fence) const {
+	VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+	timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues_.size());
+	timelineInfo.pWaitSemaphoreValues = waitValues_.data();
+	timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues_.size());
+	timelineInfo.pSignalSemaphoreValues = signalValues_.data();
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores_.size());
+	submitInfo.pWaitSemaphores = waitSemaphores_.data();
+	submitInfo.pWaitDstStageMask = waitStages_.data();
+	submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers_.size());
+	submitInfo.pCommandBuffers = commandBuffers_.data();
+	submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores_.size());
+	submitInfo.pSignalSemaphores = signalSemaphores_.data();
+
+	Check(device.Dispatch().vkQueueSubmit(queue, 1, &submitInfo, fence), "submit to queue");
+}
+
+}
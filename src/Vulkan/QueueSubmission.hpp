@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <vector>
+
+namespace Vulkan {
+	class Device;
+	class TimelineSemaphore;
+
+	// Builder for a single vkQueueSubmit mixing binary semaphores (swap chain acquire/present)
+	// and timeline semaphores (frame, upload and cross-queue dependencies).
+	class QueueSubmission final {
+	public:
+
+		QueueSubmission& Wait(VkSemaphore semaphore, VkPipelineStageFlags stage);
+		QueueSubmission& Wait(const TimelineSemaphore& timeline, uint64_t value, VkPipelineStageFlags stage);
+		QueueSubmission& Signal(VkSemaphore semaphore);
+		QueueSubmission& Signal(const TimelineSemaphore& timeline, uint64_t value);
+		QueueSubmission& Execute(VkCommandBuffer commandBuffer);
+
+		void Submit(const Device& device, VkQueue queue, VkFence fence = VK_NULL_HANDLE) const;
+
+	private:
+
+		std::vector<VkSemaphore> waitSemaphores_;
+		std::vector<uint64_t> waitValues_;
+		std::vector<VkPipelineStageFlags> waitStages_;
+		std::vector<VkSemaphore> signalSemaphores_;
+		std::vector<uint64_t> signalValues_;
+		std::vector<VkCommandBuffer> commandBuffers_;
+	};
+
+}
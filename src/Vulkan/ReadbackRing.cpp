@@ -0,0 +1,140 @@
+#include "ReadbackRing.hpp"
+
+#include "Buffer.hpp"
+#include "Device.hpp"
+#include "TimelineSemaphore.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace Vulkan {
+
+ReadbackRing::ReadbackRing(
+	const Device& device,
+	const TimelineSemaphore& timeline,
+	const size_t size,
+	const VkDeviceSize bufferSize,
+	const VkBufferUsageFlags usage,
+	const char* const tag,
+	WriteFunction write) :
+	timeline_(timeline),
+	write_(std::move(write)),
+	states_(new std::atomic<State>[size])
+{
+	// Cached memory makes the reads of the writer thread fast, it is not always coherent though
+	for (size_t i = 0; i != size; ++i) {
+		auto slot = std::make_unique<Slot>();
+		slot->Index = i;
+		slot->Buffer.reset(new class Buffer(device, bufferSize, usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, tag, VK_MEMORY_PROPERTY_HOST_CACHED_BIT));
+		slot->Data = static_cast<const unsigned char*>(slot->Buffer->Memory().Map(0, VK_WHOLE_SIZE));
+
+		slots_.push_back(std::move(slot));
+		states_[i] = State::Free;
+	}
+
+	writer_ = std::thread([this]() { RunWriter(); });
+}
+
+ReadbackRing::~ReadbackRing() {
+	Stop();
+}
+
+void ReadbackRing::Stop() {
+	if (!writer_.joinable())
+		return;
+
+	// Finish the copies still in flight, then let the writer drain its queue
+	uint64_t lastValue = 0;
+	for (const auto& slot : slots_) {
+		if (states_[slot->Index] == State::InFlight)
+			lastValue = std::max(lastValue, slot->FrameValue);
+	}
+
+	timeline_.Wait(lastValue, std::numeric_limits<uint64_t>::max());
+	Collect();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+
+	wakeUp_.notify_one();
+	writer_.join();
+}
+
+ReadbackRing::Slot* ReadbackRing::Acquire() {
+	for (const auto& slot : slots_) {
+		if (states_[slot->Index] == State::Free) {
+			states_[slot->Index] = State::Acquired;
+			return slot.get();
+		}
+	}
+
+	dropped_.fetch_add(1, std::memory_order_relaxed);
+	return nullptr;
+}
+
+void ReadbackRing::Submit(Slot& slot, const uint64_t frameValue) {
+	slot.FrameValue = frameValue;
+	slot.Number = ++submitted_;
+	states_[slot.Index] = State::InFlight;
+}
+
+void ReadbackRing::Collect() {
+	uint64_t completedValue = 0;
+	bool queried = false;
+
+	for (const auto& slot : slots_) {
+		if (states_[slot->Index] != State::InFlight)
+			continue;
+
+		if (!queried) {
+			completedValue = timeline_.CompletedValue();
+			queried = true;
+		}
+
+		if (slot->FrameValue > completedValue)
+			continue;
+
+		slot->Buffer->Memory().Invalidate(0, VK_WHOLE_SIZE);
+		states_[slot->Index] = State::Writing;
+		ready_.push_back(slot.get());
+	}
+
+	if (ready_.empty())
+		return;
+
+	// Free slots are reused lowest index first, the index says nothing of the submission order
+	std::sort(ready_.begin(), ready_.end(), [](const Slot* a, const Slot* b) { return a->Number < b->Number; });
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		queue_.insert(queue_.end(), ready_.begin(), ready_.end());
+	}
+
+	ready_.clear();
+	wakeUp_.notify_one();
+}
+
+void ReadbackRing::RunWriter() {
+	for (;;) {
+		Slot* slot;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			wakeUp_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+
+			if (queue_.empty())
+				return;
+
+			slot = queue_.front();
+			queue_.pop_front();
+		}
+
+		write_(*slot);
+
+		states_[slot->Index] = State::Free;
+		written_.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+}
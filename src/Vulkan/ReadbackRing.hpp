@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Vulkan {
+	class Buffer;
+	class Device;
+	class TimelineSemaphore;
+
+	// Ring of persistently mapped host visible buffers, filled by the device and consumed on a writer thread.
+	// A buffer is acquired while recording a frame and handed to the writer once the timeline reaches that frame
+	// value, it is free again once written. Acquiring never waits: it fails when every buffer is still busy.
+	class ReadbackRing final {
+	public:
+
+		struct Slot {
+			size_t Index{};
+			std::unique_ptr<class Buffer> Buffer;
+			const unsigned char* Data{};
+			uint64_t FrameValue{};
+			// Sequence number of the submission, starting at one
+			uint64_t Number{};
+		};
+
+		// Called on the writer thread, the slot data stays valid until it returns
+		using WriteFunction = std::function<void(const Slot& slot)>;
+
+		VULKAN_NON_COPIABLE(ReadbackRing)
+
+		ReadbackRing(const Device& device, const TimelineSemaphore& timeline, size_t size, VkDeviceSize bufferSize, VkBufferUsageFlags usage, const char* tag, WriteFunction write);
+		~ReadbackRing();
+
+		size_t Size() const { return slots_.size(); }
+		const Slot& operator [] (const size_t i) const { return *slots_[i]; }
+
+		// Null when every buffer is in flight or being written, the frame is then counted as dropped
+		Slot* Acquire();
+		// The slot is written once the frame value is reached on the timeline
+		void Submit(Slot& slot, uint64_t frameValue);
+		// Hand the slots of the completed frames to the writer thread
+		void Collect();
+		// Wait for the frames in flight, write them and stop the writer; done on destruction at the latest
+		void Stop();
+
+		uint64_t Written() const { return written_.load(std::memory_order_relaxed); }
+		uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+	private:
+
+		enum class State {
+			Free,
+			Acquired,
+			InFlight,
+			Writing
+		};
+
+		void RunWriter();
+
+		const TimelineSemaphore& timeline_;
+		const WriteFunction write_;
+
+		std::vector<std::unique_ptr<Slot>> slots_;
+		std::unique_ptr<std::atomic<State>[]> states_;
+		uint64_t submitted_{};
+		// Slots completed since the last Collect, reused to keep them in submission order
+		std::vector<Slot*> ready_;
+
+		std::atomic<uint64_t> written_{};
+		std::atomic<uint64_t> dropped_{};
+
+		std::mutex mutex_;
+		std::condition_variable wakeUp_;
+		std::deque<Slot*> queue_;
+		bool stopping_{};
+		std::thread writer_;
+	};
+
+}
@@ -10,56 +10,96 @@ namespace Vulkan {
 RenderPass::RenderPass(
 	const class SwapChain& swapChain, 
 	const bool clearColorBuffer) :
-	swapChain_(swapChain)
+	RenderPass(swapChain.Device(), swapChain.Format(), VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, clearColorBuffer)
 {
+}
+
+RenderPass::RenderPass(
+	const class Device& device,
+	const VkFormat format,
+	const VkImageLayout finalLayout,
+	const bool clearColorBuffer,
+	const VkFormat depthFormat) :
+	device_(device),
+	format_(format),
+	depthFormat_(depthFormat)
+{
+	const bool hasDepth = depthFormat != VK_FORMAT_UNDEFINED;
+
 	VkAttachmentDescription colorAttachment = {};
-	colorAttachment.format = swapChain.Format();
+	colorAttachment.format = format;
 	colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-	colorAttachment.loadOp = clearColorBuffer ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colorAttachment.loadOp = clearColorBuffer ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
 	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	// Without clearing, the pass draws on top of an image a previous pass left in the same final layout
+	colorAttachment.initialLayout = clearColorBuffer ? VK_IMAGE_LAYOUT_UNDEFINED : finalLayout;
+	colorAttachment.finalLayout = finalLayout;
 
 
+	// Stored for the depth pyramid and for passes resuming the scene
+	VkAttachmentDescription depthAttachment = {};
+	depthAttachment.format = depthFormat;
+	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	depthAttachment.loadOp = clearColorBuffer ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.initialLayout = clearColorBuffer ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
 	VkAttachmentReference colorAttachmentRef = {};
 	colorAttachmentRef.attachment = 0;
 	colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+	VkAttachmentReference depthAttachmentRef = {};
+	depthAttachmentRef.attachment = 1;
+	depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
 	VkSubpassDescription subpass = {};
 	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 	subpass.colorAttachmentCount = 1;
 	subpass.pColorAttachments = &colorAttachmentRef;
+	subpass.pDepthStencilAttachment = hasDepth ? &depthAttachmentRef : nullptr;
 
 	VkSubpassDependency dependency = {};
 	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
 	dependency.dstSubpass = 0;
 	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependency.srcAccessMask = 0;
+	dependency.srcAccessMask = clearColorBuffer ? 0 : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | (clearColorBuffer ? 0 : VK_ACCESS_COLOR_ATTACHMENT_READ_BIT);
+
+	// The depth attachment is shared by the frames in flight, the previous frame depth tests must be done
+	if (hasDepth) {
+		dependency.srcStageMask |= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dependency.srcAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dependency.dstStageMask |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+		dependency.dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+	}
 
-	std::array<VkAttachmentDescription, 1> attachments =
+	std::array<VkAttachmentDescription, 2> attachments =
 	{ 
-		colorAttachment
+		colorAttachment,
+		depthAttachment
 	};
 
 	VkRenderPassCreateInfo renderPassInfo = {};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	renderPassInfo.attachmentCount = hasDepth ? 2 : 1;
 	renderPassInfo.pAttachments = attachments.data();
 	renderPassInfo.subpassCount = 1;
 	renderPassInfo.pSubpasses = &subpass;
 	renderPassInfo.dependencyCount = 1;
 	renderPassInfo.pDependencies = &dependency;
 
-	Check(vkCreateRenderPass(swapChain_.Device().Handle(), &renderPassInfo, nullptr, &renderPass_), "create render pass");
+	Check(device.Dispatch().vkCreateRenderPass(device.Handle(), &renderPassInfo, device.Allocator(), &renderPass_), "create render pass");
 }
 
 RenderPass::~RenderPass() {
 	if (renderPass_ != nullptr) {
-		vkDestroyRenderPass(swapChain_.Device().Handle(), renderPass_, nullptr);
+		device_.Dispatch().vkDestroyRenderPass(device_.Handle(), renderPass_, device_.Allocator());
 		renderPass_ = nullptr;
 	}
 }
@@ -4,7 +4,7 @@
 
 namespace Vulkan
 {
-	class DepthBuffer;
+	class Device;
 	class SwapChain;
 
 	class RenderPass final
@@ -14,13 +14,20 @@ namespace Vulkan
 		VULKAN_NON_COPIABLE(RenderPass)
 
 		RenderPass(const SwapChain& swapChain, bool clearColorBuffer);
+		// Single color attachment left in finalLayout, for offscreen targets. With a depth format, a depth attachment
+		// follows the color one and is left in the depth attachment layout; it is cleared along with the color.
+		RenderPass(const Device& device, VkFormat format, VkImageLayout finalLayout, bool clearColorBuffer, VkFormat depthFormat = VK_FORMAT_UNDEFINED);
 		~RenderPass();
 
-		const class SwapChain& SwapChain() const { return swapChain_; }
+		const class Device& Device() const { return device_; }
+		VkFormat Format() const { return format_; }
+		VkFormat DepthFormat() const { return depthFormat_; }
 
 	private:
 
-		const class SwapChain& swapChain_;
+		const class Device& device_;
+		const VkFormat format_;
+		const VkFormat depthFormat_;
 
 		VULKAN_HANDLE(VkRenderPass, renderPass_)
 	};
@@ -0,0 +1,31 @@
+#include "Sampler.hpp"
+
+#include "Device.hpp"
+
+namespace Vulkan {
+
+Sampler::Sampler(const class Device& device, const VkFilter filter, const VkSamplerAddressMode addressMode) :
+	device_(device)
+{
+	VkSamplerCreateInfo samplerInfo = {};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = filter;
+	samplerInfo.minFilter = filter;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerInfo.addressModeU = addressMode;
+	samplerInfo.addressModeV = addressMode;
+	samplerInfo.addressModeW = addressMode;
+	samplerInfo.maxLod = 0.0f;
+	samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+
+	Check(device.Dispatch().vkCreateSampler(device.Handle(), &samplerInfo, device.Allocator(), &sampler_), "create sampler");
+}
+
+Sampler::~Sampler() {
+	if (sampler_ != nullptr) {
+		device_.Dispatch().vkDestroySampler(device_.Handle(), sampler_, device_.Allocator());
+		sampler_ = nullptr;
+	}
+}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+namespace Vulkan {
+	class Device;
+
+	class Sampler final {
+	public:
+
+		VULKAN_NON_COPIABLE(Sampler)
+
+		Sampler(const Device& device, VkFilter filter, VkSamplerAddressMode addressMode);
+		~Sampler();
+
+		const class Device& Device() const { return device_; }
+
+	private:
+
+		const class Device& device_;
+
+		VULKAN_HANDLE(VkSampler, sampler_)
+	};
+
+}
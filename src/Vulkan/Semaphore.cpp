@@ -7,7 +7,7 @@ Semaphore::Semaphore(const class Device& device) : device_(device) {
 	VkSemaphoreCreateInfo semaphoreInfo = {};
 	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-	Check(vkCreateSemaphore(device.Handle(), &semaphoreInfo, nullptr, &semaphore_), "create semaphores");
+	Check(device.Dispatch().vkCreateSemaphore(device.Handle(), &semaphoreInfo, device.Allocator(), &semaphore_), "create semaphores");
 }
 
 Semaphore::Semaphore(Semaphore&& other) noexcept : device_(other.device_), semaphore_(other.semaphore_) {
@@ -16,7 +16,7 @@ Semaphore::Semaphore(Semaphore&& other) noexcept : device_(other.device_), semap
 
 Semaphore::~Semaphore() {
 	if (semaphore_ != nullptr) {
-		vkDestroySemaphore(device_.Handle(), semaphore_, nullptr);
+		device_.Dispatch().vkDestroySemaphore(device_.Handle(), semaphore_, device_.Allocator());
 		semaphore_ = nullptr;
 	}
 }
@@ -15,22 +15,23 @@ ShaderModule::ShaderModule(const class Device& device, const std::vector<char>&
 	createInfo.codeSize = code.size();
 	createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
 
-	Check(vkCreateShaderModule(device.Handle(), &createInfo, nullptr, &shaderModule_), "create shader module");
+	Check(device.Dispatch().vkCreateShaderModule(device.Handle(), &createInfo, device.Allocator(), &shaderModule_), "create shader module");
 }
 
 ShaderModule::~ShaderModule() {
 	if (shaderModule_ != nullptr) {
-		vkDestroyShaderModule(device_.Handle(), shaderModule_, nullptr);
+		device_.Dispatch().vkDestroyShaderModule(device_.Handle(), shaderModule_, device_.Allocator());
 		shaderModule_ = nullptr;
 	}
 }
 
-VkPipelineShaderStageCreateInfo ShaderModule::CreateShaderStage(VkShaderStageFlagBits stage) const {
+VkPipelineShaderStageCreateInfo ShaderModule::CreateShaderStage(VkShaderStageFlagBits stage, const VkSpecializationInfo* const specializationInfo) const {
 	VkPipelineShaderStageCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	createInfo.stage = stage;
 	createInfo.module = shaderModule_;
 	createInfo.pName = "main";
+	createInfo.pSpecializationInfo = specializationInfo;
 
 	return createInfo;
 }
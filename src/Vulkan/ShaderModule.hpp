@@ -18,12 +18,14 @@ namespace Vulkan {
 
 		const class Device& Device() const { return device_; }
 
-		VkPipelineShaderStageCreateInfo CreateShaderStage(VkShaderStageFlagBits stage) const;
-
-	private:
+		// The specialization info, when there is one, must stay alive until the pipeline is created
+		VkPipelineShaderStageCreateInfo CreateShaderStage(VkShaderStageFlagBits stage, const VkSpecializationInfo* specializationInfo = nullptr) const;
 
+		// SPIR-V file content, safe to call from any thread
 		static std::vector<char> ReadFile(const std::string& filename);
 
+	private:
+
 		const class Device& device_;
 
 		VULKAN_HANDLE(VkShaderModule, shaderModule_)
@@ -0,0 +1,83 @@
+#include "ShaderVariant.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Vulkan {
+
+	namespace {
+		// FNV-1a, folding one 32 bits field at a time
+		constexpr uint64_t FnvOffsetBasis = 14695981039346656037ull;
+		constexpr uint64_t FnvPrime = 1099511628211ull;
+
+		uint64_t HashCombine(uint64_t hash, const uint32_t value) {
+			for (int i = 0; i != 4; ++i) {
+				hash ^= (value >> (i * 8)) & 0xFF;
+				hash *= FnvPrime;
+			}
+
+			return hash;
+		}
+	}
+
+ShaderVariant::ShaderVariant() {
+	UpdateHash();
+}
+
+ShaderVariant ShaderVariant::With(const ShaderFeature feature, const uint32_t value) const {
+	ShaderVariant variant(*this);
+	const auto id = static_cast<uint32_t>(feature);
+	const auto entry = std::lower_bound(variant.entries_.begin(), variant.entries_.end(), id,
+		[](const VkSpecializationMapEntry& e, const uint32_t constantId) { return e.constantID < constantId; });
+	const auto index = static_cast<size_t>(entry - variant.entries_.begin());
+
+	if (entry != variant.entries_.end() && entry->constantID == id) {
+		variant.values_[index] = value;
+	}
+	else {
+		variant.entries_.insert(entry, { id, 0, sizeof(uint32_t) });
+		variant.values_.insert(variant.values_.begin() + index, value);
+
+		for (size_t i = 0; i != variant.entries_.size(); ++i) {
+			variant.entries_[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+		}
+	}
+
+	variant.UpdateHash();
+	return variant;
+}
+
+VkSpecializationInfo ShaderVariant::SpecializationInfo() const {
+	VkSpecializationInfo info = {};
+	info.mapEntryCount = static_cast<uint32_t>(entries_.size());
+	info.pMapEntries = entries_.data();
+	info.dataSize = values_.size() * sizeof(uint32_t);
+	info.pData = values_.data();
+
+	return info;
+}
+
+bool ShaderVariant::operator == (const ShaderVariant& other) const {
+	if (hash_ != other.hash_ || values_ != other.values_ || entries_.size() != other.entries_.size())
+		return false;
+
+	for (size_t i = 0; i != entries_.size(); ++i) {
+		if (entries_[i].constantID != other.entries_[i].constantID)
+			return false;
+	}
+
+	return true;
+}
+
+void ShaderVariant::UpdateHash() {
+	uint64_t hash = FnvOffsetBasis;
+
+	for (size_t i = 0; i != entries_.size(); ++i) {
+		hash = HashCombine(hash, entries_[i].constantID);
+		hash = HashCombine(hash, values_[i]);
+	}
+
+	hash_ = static_cast<size_t>(hash);
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace Vulkan {
+
+	// Specialization constant ids, every shader declaring a feature uses the same id
+	enum class ShaderFeature : uint32_t {
+		// LightingModel value
+		LightingModel = 0,
+		// Fragments under half coverage are discarded
+		AlphaTest = 1
+	};
+
+	enum class LightingModel : uint32_t {
+		Unlit,
+		// Ambient and a directional light
+		Directional,
+		// Directional plus the clustered point and spot lights
+		Clustered
+	};
+
+	// Feature values a shader permutation is specialized with, instead of branching on them at run time or
+	// compiling a SPIR-V file per combination. Features left unset keep the default of the shader.
+	// The hash is computed once when the variant changes, like the one of PipelineState.
+	class ShaderVariant final {
+	public:
+
+		ShaderVariant();
+
+		bool IsEmpty() const { return values_.empty(); }
+		size_t Hash() const { return hash_; }
+
+		ShaderVariant With(ShaderFeature feature, uint32_t value) const;
+		ShaderVariant With(LightingModel lightingModel) const { return With(ShaderFeature::LightingModel, static_cast<uint32_t>(lightingModel)); }
+
+		// Points into the variant, valid as long as it is alive and unchanged
+		VkSpecializationInfo SpecializationInfo() const;
+
+		bool operator == (const ShaderVariant& other) const;
+		bool operator != (const ShaderVariant& other) const { return !(*this == other); }
+
+	private:
+
+		void UpdateHash();
+
+		// Sorted by constant id, one 32 bits value each
+		std::vector<VkSpecializationMapEntry> entries_;
+		std::vector<uint32_t> values_;
+
+		size_t hash_{};
+	};
+
+}
+
+namespace std {
+
+	template <>
+	struct hash<Vulkan::ShaderVariant> {
+		size_t operator () (const Vulkan::ShaderVariant& variant) const noexcept { return variant.Hash(); }
+	};
+
+}
@@ -0,0 +1,185 @@
+#include "SpriteAtlas.hpp"
+
+#include "Buffer.hpp"
+#include "CommandBuffers.hpp"
+#include "CommandPool.hpp"
+#include "DescriptorPool.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+#include "QueueSubmission.hpp"
+#include "Sampler.hpp"
+#include "../Utilities/StbImage.hpp"
+#include "../Utilities/StbRectPack.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace Vulkan {
+
+	namespace {
+		constexpr VkFormat AtlasFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+		// Transparent gutter around every sprite, so linear filtering never reads a neighbour
+		constexpr int Padding = 1;
+
+		VkImageMemoryBarrier ImageBarrier(const VkImage image, const VkImageLayout oldLayout, const VkImageLayout newLayout, const VkAccessFlags srcAccess, const VkAccessFlags dstAccess) {
+			VkImageMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstAccessMask = dstAccess;
+			barrier.oldLayout = oldLayout;
+			barrier.newLayout = newLayout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image;
+			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+			return barrier;
+		}
+	}
+
+SpriteAtlas::SpriteAtlas(const class Device& device, const uint32_t size) :
+	device_(device),
+	size_(size)
+{
+}
+
+SpriteAtlas::~SpriteAtlas() {
+	descriptorPool_.reset();
+	descriptorSetLayout_.reset();
+	sampler_.reset();
+	imageView_.reset();
+	image_.reset();
+}
+
+uint32_t SpriteAtlas::Add(const uint32_t width, const uint32_t height, const unsigned char* const rgba) {
+	if (IsBuilt())
+		throw std::logic_error("sprite atlas has already been built");
+
+	if (width == 0 || height == 0 || width + 2 * Padding > size_ || height + 2 * Padding > size_)
+		throw std::invalid_argument("sprite does not fit in the atlas");
+
+	images_.emplace_back(rgba, rgba + size_t(width) * height * 4);
+	regions_.push_back(Region{ 0, 0, 0, 0, width, height });
+
+	return static_cast<uint32_t>(regions_.size() - 1);
+}
+
+uint32_t SpriteAtlas::AddFile(const std::string& filename) {
+	int width, height;
+	const std::unique_ptr<stbi_uc, void (*)(void*)> pixels(stbi_load(filename.c_str(), &width, &height, nullptr, 4), stbi_image_free);
+
+	if (!pixels)
+		throw std::runtime_error("failed to load sprite '" + filename + "'");
+
+	return Add(static_cast<uint32_t>(width), static_cast<uint32_t>(height), pixels.get());
+}
+
+void SpriteAtlas::Build(CommandPool& commandPool) {
+	if (IsBuilt())
+		throw std::logic_error("sprite atlas has already been built");
+
+	std::vector<stbrp_rect> rects(regions_.size());
+	for (size_t i = 0; i != rects.size(); ++i) {
+		rects[i].id = static_cast<int>(i);
+		rects[i].w = static_cast<stbrp_coord>(regions_[i].Width + 2 * Padding);
+		rects[i].h = static_cast<stbrp_coord>(regions_[i].Height + 2 * Padding);
+	}
+
+	// One node per column gives the best packing
+	std::vector<stbrp_node> nodes(size_);
+	stbrp_context context;
+	stbrp_init_target(&context, static_cast<int>(size_), static_cast<int>(size_), nodes.data(), static_cast<int>(nodes.size()));
+
+	if (!stbrp_pack_rects(&context, rects.data(), static_cast<int>(rects.size())))
+		throw std::runtime_error("sprites do not fit in a " + std::to_string(size_) + "x" + std::to_string(size_) + " atlas");
+
+	std::vector<unsigned char> pixels(size_t(size_) * size_ * 4);
+	const float scale = 1.0f / static_cast<float>(size_);
+
+	for (const auto& rect : rects) {
+		auto& region = regions_[rect.id];
+		const auto& image = images_[rect.id];
+		const uint32_t x = rect.x + Padding;
+		const uint32_t y = rect.y + Padding;
+
+		for (uint32_t row = 0; row != region.Height; ++row) {
+			std::memcpy(&pixels[(size_t(y + row) * size_ + x) * 4], &image[size_t(row) * region.Width * 4], size_t(region.Width) * 4);
+		}
+
+		region.U0 = x * scale;
+		region.V0 = y * scale;
+		region.U1 = (x + region.Width) * scale;
+		region.V1 = (y + region.Height) * scale;
+	}
+
+	images_.clear();
+	images_.shrink_to_fit();
+
+	Upload(commandPool, pixels);
+
+	sampler_.reset(new class Sampler(device_, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE));
+
+	descriptorSetLayout_.reset(new DescriptorSetLayout(device_, DescriptorBindings()));
+	descriptorPool_.reset(new DescriptorPool(device_, { { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 } }, 1, 0));
+	descriptorSet_ = descriptorPool_->Allocate(*descriptorSetLayout_, 1)[0];
+
+	VkDescriptorImageInfo imageInfo = { sampler_->Handle(), imageView_->Handle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+	VkWriteDescriptorSet write = {};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = descriptorSet_;
+	write.dstBinding = 0;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo = &imageInfo;
+
+	device_.Dispatch().vkUpdateDescriptorSets(device_.Handle(), 1, &write, 0, nullptr);
+}
+
+std::vector<VkDescriptorSetLayoutBinding> SpriteAtlas::DescriptorBindings() {
+	return { { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr } };
+}
+
+void SpriteAtlas::Upload(CommandPool& commandPool, const std::vector<unsigned char>& pixels) {
+	const auto& dispatch = device_.Dispatch();
+
+	image_.reset(new Image(
+		device_, { size_, size_ }, 1, AtlasFormat, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		{ device_.GraphicsFamilyIndex() }, "sprite atlas"));
+	imageView_.reset(new class ImageView(device_, image_->Handle(), AtlasFormat, VK_IMAGE_ASPECT_COLOR_BIT));
+
+	Buffer staging(device_, pixels.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, "sprite atlas staging");
+	std::memcpy(staging.Memory().Map(0, VK_WHOLE_SIZE), pixels.data(), pixels.size());
+	staging.Memory().Unmap();
+
+	CommandBuffers commandBuffers(commandPool, 1);
+	const auto commandBuffer = commandBuffers.Begin(0);
+
+	const auto toTransfer = ImageBarrier(image_->Handle(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toTransfer);
+
+	VkBufferImageCopy region = {};
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageExtent = { size_, size_, 1 };
+	dispatch.vkCmdCopyBufferToImage(commandBuffer, staging.Handle(), image_->Handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+	const auto toShader = ImageBarrier(image_->Handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toShader);
+
+	commandBuffers.End(0);
+
+	QueueSubmission()
+		.Execute(commandBuffer)
+		.Submit(device_, device_.GraphicsQueue());
+
+	// One-off upload when the atlas is built, stalling is fine here
+	device_.WaitIdle();
+}
+
+}
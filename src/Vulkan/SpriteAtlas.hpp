@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Vulkan {
+	class CommandPool;
+	class DescriptorPool;
+	class DescriptorSetLayout;
+	class Device;
+	class Image;
+	class ImageView;
+	class Sampler;
+
+	// Sprite images packed into a single RGBA8 texture with stb_rect_pack.
+	// Images are added on the host first, Build() packs them and uploads the texture once; sprites are then addressed by index.
+	class SpriteAtlas final {
+	public:
+
+		// Texture coordinates of a sprite and its size in pixels
+		struct Region {
+			float U0, V0, U1, V1;
+			uint32_t Width, Height;
+		};
+
+		VULKAN_NON_COPIABLE(SpriteAtlas)
+
+		SpriteAtlas(const Device& device, uint32_t size);
+		~SpriteAtlas();
+
+		const class Device& Device() const { return device_; }
+		uint32_t Size() const { return size_; }
+		uint32_t SpriteCount() const { return static_cast<uint32_t>(regions_.size()); }
+		bool IsBuilt() const { return image_ != nullptr; }
+
+		// The pixels are copied, the returned index is valid once the atlas is built
+		uint32_t Add(uint32_t width, uint32_t height, const unsigned char* rgba);
+		uint32_t AddFile(const std::string& filename);
+
+		// Throws when the sprites do not fit, they must then be spread over several atlases
+		void Build(CommandPool& commandPool);
+
+		const Region& operator [] (const uint32_t sprite) const { return regions_[sprite]; }
+
+		// A single combined image sampler at binding 0, visible to the fragment stage
+		static std::vector<VkDescriptorSetLayoutBinding> DescriptorBindings();
+		VkDescriptorSet DescriptorSet() const { return descriptorSet_; }
+
+	private:
+
+		void Upload(CommandPool& commandPool, const std::vector<unsigned char>& pixels);
+
+		const class Device& device_;
+		const uint32_t size_;
+
+		// Released once packed
+		std::vector<std::vector<unsigned char>> images_;
+		std::vector<Region> regions_;
+
+		std::unique_ptr<Image> image_;
+		std::unique_ptr<ImageView> imageView_;
+		std::unique_ptr<Sampler> sampler_;
+		std::unique_ptr<DescriptorSetLayout> descriptorSetLayout_;
+		std::unique_ptr<DescriptorPool> descriptorPool_;
+		VkDescriptorSet descriptorSet_{};
+	};
+
+}
@@ -0,0 +1,170 @@
+#include "SpriteBatch.hpp"
+
+#include "Buffer.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+#include "FrameStats.hpp"
+#include "GraphicsPipeline.hpp"
+#include "PipelineCompiler.hpp"
+#include "PipelineLayout.hpp"
+#include "PipelineVariants.hpp"
+#include "ShaderModule.hpp"
+#include "SpriteAtlas.hpp"
+#include "../Utilities/Log.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace Vulkan {
+
+SpriteBatch::SpriteBatch(
+	const Device& device,
+	PipelineCompiler& pipelineCompiler,
+	const RenderPass* const renderPass,
+	const VkFormat colorFormat,
+	const VkFormat depthFormat,
+	const uint32_t frameCount,
+	const uint32_t maxSprites) :
+	device_(device),
+	maxSprites_(maxSprites),
+	frameSize_(VkDeviceSize(maxSprites) * 4 * sizeof(Vertex))
+{
+	// Atlases own their descriptor set, allocated with an identical layout
+	descriptorSetLayout_.reset(new DescriptorSetLayout(device, SpriteAtlas::DescriptorBindings()));
+	pipelineLayout_.reset(new PipelineLayout(device, { descriptorSetLayout_->Handle() }, { { VK_SHADER_STAGE_VERTEX_BIT, 0, 2 * sizeof(float) } }));
+
+	VertexInput vertexInput;
+	vertexInput.Bindings = { { 0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX } };
+	vertexInput.Attributes =
+	{
+		{ 0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, X) },
+		{ 1, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, U) },
+		{ 2, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(Vertex, Color) }
+	};
+
+	pipelines_.reset(new PipelineVariants(
+		device, pipelineCompiler, "sprite", *pipelineLayout_, renderPass, colorFormat, depthFormat,
+		ShaderModule::ReadFile("../assets/shaders/sprite.vert.spv"), ShaderModule::ReadFile("../assets/shaders/sprite.frag.spv"), vertexInput));
+
+	// Opaque sprites are alpha tested, the blended ones keep their soft edges
+	for (const auto blendMode : { BlendMode::Opaque, BlendMode::Alpha, BlendMode::Additive }) {
+		const auto index = static_cast<size_t>(blendMode);
+		blendStates_[index] = PipelineState().WithCullMode(VK_CULL_MODE_NONE).WithBlendMode(blendMode);
+		blendVariants_[index] = blendMode == BlendMode::Opaque ? ShaderVariant().With(ShaderFeature::AlphaTest, 1) : ShaderVariant();
+		pipelines_->Prewarm({ blendStates_[index] }, { blendVariants_[index] });
+	}
+
+	// Host writes go straight to device local memory when the device exposes it to the host (resizable BAR, integrated GPUs)
+	const auto hostMemory = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+	vertexBuffer_.reset(new Buffer(device, frameSize_ * frameCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, hostMemory, "sprite vertices", VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+	vertices_ = static_cast<unsigned char*>(vertexBuffer_->Memory().Map(0, VK_WHOLE_SIZE));
+
+	// Two triangles per quad, drawn with a base vertex so every group starts from index 0
+	const VkDeviceSize indexCount = VkDeviceSize(maxSprites) * 6;
+	indexBuffer_.reset(new Buffer(device, indexCount * sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, hostMemory, "sprite indices", VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+
+	auto* const indices = static_cast<uint32_t*>(indexBuffer_->Memory().Map(0, VK_WHOLE_SIZE));
+	for (uint32_t sprite = 0; sprite != maxSprites; ++sprite) {
+		const uint32_t first = sprite * 4;
+		const uint32_t quad[6] = { first, first + 1, first + 2, first + 2, first + 3, first };
+		std::memcpy(indices + size_t(sprite) * 6, quad, sizeof(quad));
+	}
+	indexBuffer_->Memory().Unmap();
+}
+
+SpriteBatch::~SpriteBatch() {
+	indexBuffer_.reset();
+	vertexBuffer_.reset();
+	pipelines_.reset();
+	pipelineLayout_.reset();
+	descriptorSetLayout_.reset();
+}
+
+void SpriteBatch::Draw(const uint32_t layer, const SpriteAtlas& atlas, const uint32_t sprite, const Rect& rect, const uint32_t color, const BlendMode blendMode) {
+	if (layer >= layers_.size())
+		layers_.resize(layer + 1);
+
+	auto& groups = layers_[layer];
+	auto group = std::find_if(groups.begin(), groups.end(), [&](const Group& g) { return g.Atlas == &atlas && g.Blend == blendMode; });
+
+	if (group == groups.end())
+		group = groups.insert(groups.end(), Group{ &atlas, blendMode, {} });
+
+	const auto& region = atlas[sprite];
+	const float x0 = rect.X;
+	const float y0 = rect.Y;
+	const float x1 = rect.X + rect.Width;
+	const float y1 = rect.Y + rect.Height;
+
+	auto& vertices = group->Vertices;
+	vertices.push_back({ x0, y0, region.U0, region.V0, color });
+	vertices.push_back({ x1, y0, region.U1, region.V0, color });
+	vertices.push_back({ x1, y1, region.U1, region.V1, color });
+	vertices.push_back({ x0, y1, region.U0, region.V1, color });
+
+	++queued_;
+}
+
+void SpriteBatch::Render(VkCommandBuffer commandBuffer, const uint32_t frame, const VkExtent2D extent, FrameStats& frameStats) {
+	if (queued_ == 0)
+		return;
+
+	const auto& dispatch = device_.Dispatch();
+
+	// The region of this frame is free, its previous submission completed before the command buffer was reused
+	const VkDeviceSize frameOffset = frame * frameSize_;
+	auto* const destination = reinterpret_cast<Vertex*>(vertices_ + frameOffset);
+
+	const VkBuffer vertexBuffer = vertexBuffer_->Handle();
+	dispatch.vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &frameOffset);
+	dispatch.vkCmdBindIndexBuffer(commandBuffer, indexBuffer_->Handle(), 0, VK_INDEX_TYPE_UINT32);
+
+	// Pixels to normalized device coordinates
+	const float scale[2] = { 2.0f / static_cast<float>(extent.width), 2.0f / static_cast<float>(extent.height) };
+	dispatch.vkCmdPushConstants(commandBuffer, pipelineLayout_->Handle(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(scale), scale);
+
+	const GraphicsPipeline* boundPipeline = nullptr;
+	const SpriteAtlas* boundAtlas = nullptr;
+	uint32_t spriteCount = 0;
+
+	for (auto& layer : layers_) {
+		for (auto& group : layer) {
+			const uint32_t count = std::min(static_cast<uint32_t>(group.Vertices.size() / 4), maxSprites_ - spriteCount);
+
+			if (count != 0) {
+				std::memcpy(destination + size_t(spriteCount) * 4, group.Vertices.data(), size_t(count) * 4 * sizeof(Vertex));
+
+				const auto blend = static_cast<size_t>(group.Blend);
+				const auto* const pipeline = &pipelines_->Get(blendStates_[blend], blendVariants_[blend]);
+				if (pipeline != boundPipeline) {
+					dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->Handle());
+					boundPipeline = pipeline;
+				}
+
+				if (group.Atlas != boundAtlas) {
+					const VkDescriptorSet descriptorSet = group.Atlas->DescriptorSet();
+					dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout_->Handle(), 0, 1, &descriptorSet, 0, nullptr);
+					boundAtlas = group.Atlas;
+				}
+
+				dispatch.vkCmdDrawIndexed(commandBuffer, count * 6, 1, 0, static_cast<int32_t>(spriteCount * 4), 0);
+				frameStats.RecordDraw(count * 2);
+
+				spriteCount += count;
+			}
+
+			group.Vertices.clear();
+		}
+	}
+
+	if (spriteCount != queued_ && !reportedDrop_) {
+		LOG_WARNING("[sprites] {} sprites dropped, the batch holds {} per frame", queued_ - spriteCount, maxSprites_);
+		reportedDrop_ = true;
+	}
+
+	queued_ = 0;
+}
+
+}
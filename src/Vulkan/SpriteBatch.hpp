@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include "PipelineState.hpp"
+#include "ShaderVariant.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace Vulkan {
+	class Buffer;
+	class DescriptorSetLayout;
+	class Device;
+	class FrameStats;
+	class GraphicsPipeline;
+	class PipelineCompiler;
+	class PipelineLayout;
+	class PipelineVariants;
+	class RenderPass;
+	class SpriteAtlas;
+
+	// 2D sprites (HUD, diagnostics) drawn with as few draws as possible.
+	// Sprites are queued per layer; within a layer they are grouped by atlas and blend mode and every group
+	// is drawn with a single indexed draw. Vertices are copied into a persistently mapped ring, one region
+	// per frame in flight, quads share a static index buffer.
+	class SpriteBatch final {
+	public:
+
+		// Colors are packed as 0xAABBGGRR
+		static constexpr uint32_t White = 0xFFFFFFFF;
+
+		// Pixels, from the top left corner of the render target
+		struct Rect {
+			float X, Y, Width, Height;
+		};
+
+		VULKAN_NON_COPIABLE(SpriteBatch)
+
+		SpriteBatch(const Device& device, PipelineCompiler& pipelineCompiler, const RenderPass* renderPass, VkFormat colorFormat, VkFormat depthFormat, uint32_t frameCount, uint32_t maxSprites);
+		~SpriteBatch();
+
+		uint32_t MaxSprites() const { return maxSprites_; }
+		bool IsEmpty() const { return queued_ == 0; }
+
+		// Layers are drawn in increasing order, the order of sprites from different groups within a layer is not kept
+		void Draw(uint32_t layer, const SpriteAtlas& atlas, uint32_t sprite, const Rect& rect, uint32_t color = White, BlendMode blendMode = BlendMode::Alpha);
+
+		// Draw and clear the queued sprites, within the scene rendering once its viewport is set.
+		// Sprites past MaxSprites are dropped.
+		void Render(VkCommandBuffer commandBuffer, uint32_t frame, VkExtent2D extent, FrameStats& frameStats);
+
+	private:
+
+		struct Vertex {
+			float X, Y;
+			float U, V;
+			uint32_t Color;
+		};
+
+		struct Group {
+			const SpriteAtlas* Atlas;
+			BlendMode Blend;
+			std::vector<Vertex> Vertices;
+		};
+
+		using Layer = std::vector<Group>;
+
+		const Device& device_;
+		const uint32_t maxSprites_;
+		const VkDeviceSize frameSize_;
+
+		std::unique_ptr<DescriptorSetLayout> descriptorSetLayout_;
+		std::unique_ptr<PipelineLayout> pipelineLayout_;
+		std::unique_ptr<PipelineVariants> pipelines_;
+		// Pipeline of every blend mode, indexed by its value
+		std::array<PipelineState, 3> blendStates_;
+		std::array<ShaderVariant, 3> blendVariants_;
+
+		std::unique_ptr<Buffer> vertexBuffer_;
+		std::unique_ptr<Buffer> indexBuffer_;
+		unsigned char* vertices_{};
+
+		// Groups keep their vertex storage from one frame to the next
+		std::vector<Layer> layers_;
+		uint32_t queued_{};
+		bool reportedDrop_{};
+	};
+
+}
@@ -6,12 +6,12 @@
 namespace Vulkan {
 
 	Surface::Surface(const class Instance& instance) : instance_(instance) {
-		Check(glfwCreateWindowSurface(instance.Handle(), instance.Window().Handle(), nullptr, &surface_), "create window surface");
+		Check(glfwCreateWindowSurface(instance.Handle(), instance.Window().Handle(), instance.Allocator(), &surface_), "create window surface");
 	}
 
 	Surface::~Surface() {
 		if (surface_ != nullptr) {
-			vkDestroySurfaceKHR(instance_.Handle(), surface_, nullptr);
+			vkDestroySurfaceKHR(instance_.Handle(), surface_, instance_.Allocator());
 			surface_ = nullptr;
 		}
 	}
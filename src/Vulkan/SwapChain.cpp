@@ -39,7 +39,9 @@ namespace Vulkan {
 		createInfo.imageColorSpace = surfaceFormat.colorSpace;
 		createInfo.imageExtent = extent;
 		createInfo.imageArrayLayers = 1;
+		// Transfer source allows reading presented images back (frame capture), when the surface supports it
 		createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		createInfo.imageUsage |= details.Capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 		createInfo.preTransform = details.Capabilities.currentTransform;
 		createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 		createInfo.presentMode = actualPresentMode;
@@ -58,13 +60,14 @@ namespace Vulkan {
 			createInfo.pQueueFamilyIndices = nullptr; // Optional
 		}
 
-		Check(vkCreateSwapchainKHR(device.Handle(), &createInfo, nullptr, &swapChain_), "create swap chain!");
+		Check(device.Dispatch().vkCreateSwapchainKHR(device.Handle(), &createInfo, device.Allocator(), &swapChain_), "create swap chain!");
 
 		minImageCount_ = details.Capabilities.minImageCount;
 		presentMode_ = actualPresentMode;
+		imageUsage_ = createInfo.imageUsage;
 		format_ = surfaceFormat.format;
 		extent_ = extent;
-		images_ = GetEnumerateVector(device_.Handle(), swapChain_, vkGetSwapchainImagesKHR);
+		images_ = GetEnumerateVector(device_.Handle(), swapChain_, device_.Dispatch().vkGetSwapchainImagesKHR);
 		imageViews_.reserve(images_.size());
 
 		for (const auto image : images_) {
@@ -76,7 +79,7 @@ namespace Vulkan {
 		imageViews_.clear();
 
 		if (swapChain_ != nullptr) {
-			vkDestroySwapchainKHR(device_.Handle(), swapChain_, nullptr);
+			device_.Dispatch().vkDestroySwapchainKHR(device_.Handle(), swapChain_, device_.Allocator());
 			swapChain_ = nullptr;
 		}
 	}
@@ -25,6 +25,7 @@ namespace Vulkan {
 		const VkExtent2D& Extent() const { return extent_; }
 		VkFormat Format() const { return format_; }
 		VkPresentModeKHR PresentMode() const { return presentMode_; }
+		VkImageUsageFlags ImageUsage() const { return imageUsage_; }
 
 	private:
 
@@ -48,6 +49,7 @@ namespace Vulkan {
 
 		uint32_t minImageCount_;
 		VkPresentModeKHR presentMode_;
+		VkImageUsageFlags imageUsage_;
 		VkFormat format_;
 		VkExtent2D extent_{};
 		std::vector<VkImage> images_;
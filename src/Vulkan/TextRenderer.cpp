@@ -0,0 +1,408 @@
+#include "TextRenderer.hpp"
+
+#include "Buffer.hpp"
+#include "DescriptorPool.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+#include "FrameStats.hpp"
+#include "GraphicsPipeline.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+#include "PipelineCompiler.hpp"
+#include "PipelineLayout.hpp"
+#include "PipelineVariants.hpp"
+#include "Sampler.hpp"
+#include "ShaderModule.hpp"
+#include "../Utilities/StbTrueType.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace Vulkan {
+
+	namespace {
+		constexpr VkFormat AtlasFormat = VK_FORMAT_R8_UNORM;
+		constexpr unsigned char OnEdgeValue = 128;
+
+		PipelineState TextState() {
+			return PipelineState().WithCullMode(VK_CULL_MODE_NONE).WithBlendMode(BlendMode::Alpha);
+		}
+
+		// Code points of an UTF-8 string, invalid sequences decode to the replacement character
+		std::vector<uint32_t> DecodeUtf8(const std::string& text) {
+			std::vector<uint32_t> codePoints;
+			codePoints.reserve(text.size());
+
+			for (size_t i = 0; i != text.size();) {
+				const auto lead = static_cast<unsigned char>(text[i]);
+				const size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+
+				if (length == 0 || i + length > text.size()) {
+					codePoints.push_back(0xFFFD);
+					++i;
+					continue;
+				}
+
+				uint32_t codePoint = length == 1 ? lead : lead & (0x7F >> length);
+				bool isValid = true;
+
+				for (size_t j = 1; j != length; ++j) {
+					const auto continuation = static_cast<unsigned char>(text[i + j]);
+					isValid = isValid && (continuation >> 6) == 0x2;
+					codePoint = (codePoint << 6) | (continuation & 0x3F);
+				}
+
+				codePoints.push_back(isValid ? codePoint : 0xFFFD);
+				i += isValid ? length : 1;
+			}
+
+			return codePoints;
+		}
+
+		VkImageMemoryBarrier ImageBarrier(const VkImage image, const VkImageLayout oldLayout, const VkImageLayout newLayout, const VkAccessFlags srcAccess, const VkAccessFlags dstAccess) {
+			VkImageMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstAccessMask = dstAccess;
+			barrier.oldLayout = oldLayout;
+			barrier.newLayout = newLayout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image;
+			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+			return barrier;
+		}
+	}
+
+TextRenderer::TextRenderer(
+	const Device& device,
+	PipelineCompiler& pipelineCompiler,
+	const RenderPass* const renderPass,
+	const VkFormat colorFormat,
+	const VkFormat depthFormat,
+	const uint32_t frameCount,
+	const std::vector<char>& fontData) :
+	device_(device),
+	font_(new stbtt_fontinfo())
+{
+	const auto* const data = reinterpret_cast<const unsigned char*>(fontData.data());
+
+	if (!stbtt_InitFont(font_.get(), data, stbtt_GetFontOffsetForIndex(data, 0)))
+		throw std::runtime_error("failed to load font");
+
+	scale_ = stbtt_ScaleForPixelHeight(font_.get(), DistanceFieldSize);
+
+	// Cells fit the largest glyph of the font
+	int x0, y0, x1, y1;
+	stbtt_GetFontBoundingBox(font_.get(), &x0, &y0, &x1, &y1);
+	cellSize_ = static_cast<uint32_t>(std::ceil(std::max(x1 - x0, y1 - y0) * scale_)) + 2 * DistanceFieldPadding;
+	cellSize_ = std::min(cellSize_, AtlasSize / 8);
+	cellsPerRow_ = AtlasSize / cellSize_;
+
+	for (uint32_t cell = cellsPerRow_ * cellsPerRow_; cell != 0; --cell) {
+		freeCells_.push_back(cell - 1);
+	}
+
+	atlas_.reset(new Image(
+		device, { AtlasSize, AtlasSize }, 1, AtlasFormat, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		{ device.GraphicsFamilyIndex() }, "glyph atlas"));
+	atlasView_.reset(new ImageView(device, atlas_->Handle(), AtlasFormat, VK_IMAGE_ASPECT_COLOR_BIT));
+	sampler_.reset(new Sampler(device, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE));
+
+	descriptorSetLayout_.reset(new DescriptorSetLayout(device, {
+		{ 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }
+	}));
+	descriptorPool_.reset(new DescriptorPool(device, { { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 } }, 1, 0));
+	descriptorSet_ = descriptorPool_->Allocate(*descriptorSetLayout_, 1)[0];
+
+	VkDescriptorImageInfo imageInfo = { sampler_->Handle(), atlasView_->Handle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+	VkWriteDescriptorSet write = {};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = descriptorSet_;
+	write.dstBinding = 0;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo = &imageInfo;
+
+	device.Dispatch().vkUpdateDescriptorSets(device.Handle(), 1, &write, 0, nullptr);
+
+	pipelineLayout_.reset(new PipelineLayout(device, { descriptorSetLayout_->Handle() }, { { VK_SHADER_STAGE_VERTEX_BIT, 0, 2 * sizeof(float) } }));
+
+	// Same vertices as the sprites, the vertex shader is shared
+	VertexInput vertexInput;
+	vertexInput.Bindings = { { 0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX } };
+	vertexInput.Attributes =
+	{
+		{ 0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, X) },
+		{ 1, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, U) },
+		{ 2, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(Vertex, Color) }
+	};
+
+	pipelines_.reset(new PipelineVariants(
+		device, pipelineCompiler, "text", *pipelineLayout_, renderPass, colorFormat, depthFormat,
+		ShaderModule::ReadFile("../assets/shaders/sprite.vert.spv"), ShaderModule::ReadFile("../assets/shaders/text.frag.spv"), vertexInput));
+	pipelines_->Prewarm({ TextState() });
+
+	const auto hostMemory = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+	staging_.reset(new Buffer(device, VkDeviceSize(frameCount) * MaxUploadsPerFrame * cellSize_ * cellSize_, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, hostMemory, "glyph staging"));
+	stagingData_ = static_cast<unsigned char*>(staging_->Memory().Map(0, VK_WHOLE_SIZE));
+
+	vertexBuffer_.reset(new Buffer(device, VkDeviceSize(frameCount) * MaxGlyphsPerFrame * 4 * sizeof(Vertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, hostMemory, "text vertices", VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+	vertexData_ = static_cast<unsigned char*>(vertexBuffer_->Memory().Map(0, VK_WHOLE_SIZE));
+
+	indexBuffer_.reset(new Buffer(device, VkDeviceSize(MaxGlyphsPerFrame) * 6 * sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, hostMemory, "text indices", VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+
+	auto* const indices = static_cast<uint32_t*>(indexBuffer_->Memory().Map(0, VK_WHOLE_SIZE));
+	for (uint32_t glyph = 0; glyph != MaxGlyphsPerFrame; ++glyph) {
+		const uint32_t first = glyph * 4;
+		const uint32_t quad[6] = { first, first + 1, first + 2, first + 2, first + 3, first };
+		std::memcpy(indices + size_t(glyph) * 6, quad, sizeof(quad));
+	}
+	indexBuffer_->Memory().Unmap();
+}
+
+TextRenderer::~TextRenderer() {
+	indexBuffer_.reset();
+	vertexBuffer_.reset();
+	staging_.reset();
+	pipelines_.reset();
+	pipelineLayout_.reset();
+	descriptorPool_.reset();
+	descriptorSetLayout_.reset();
+	sampler_.reset();
+	atlasView_.reset();
+	atlas_.reset();
+}
+
+TextRenderer::GlyphRun TextRenderer::Shape(const std::string& text) const {
+	GlyphRun run;
+	int previous = 0;
+
+	for (const auto codePoint : DecodeUtf8(text)) {
+		const int index = stbtt_FindGlyphIndex(font_.get(), static_cast<int>(codePoint));
+
+		if (previous != 0)
+			run.Advance += stbtt_GetGlyphKernAdvance(font_.get(), previous, index) * scale_;
+
+		run.Glyphs.push_back({ static_cast<uint32_t>(index), run.Advance });
+
+		int advance, leftSideBearing;
+		stbtt_GetGlyphHMetrics(font_.get(), index, &advance, &leftSideBearing);
+		run.Advance += advance * scale_;
+
+		previous = index;
+	}
+
+	return run;
+}
+
+void TextRenderer::BeginFrame(const uint32_t frame) {
+	frame_ = frame;
+	++frameNumber_;
+	uploads_.clear();
+	glyphCount_ = 0;
+}
+
+void TextRenderer::Draw(const std::string& text, const float x, const float y, const float size, const uint32_t color) {
+	auto run = runs_.find(text);
+
+	if (run == runs_.end()) {
+		// Labels that change every frame would grow the cache without bound
+		if (runs_.size() == MaxCachedRuns)
+			runs_.clear();
+
+		run = runs_.emplace(text, Shape(text)).first;
+	}
+
+	Draw(run->second, x, y, size, color);
+}
+
+void TextRenderer::Draw(const GlyphRun& run, const float x, const float y, const float size, const uint32_t color) {
+	const float scale = size / DistanceFieldSize;
+	const float texelSize = 1.0f / AtlasSize;
+	auto* const vertices = reinterpret_cast<Vertex*>(vertexData_ + VkDeviceSize(frame_) * MaxGlyphsPerFrame * 4 * sizeof(Vertex));
+
+	for (const auto& runGlyph : run.Glyphs) {
+		if (glyphCount_ == MaxGlyphsPerFrame) {
+			++droppedGlyphs_;
+			continue;
+		}
+
+		const Glyph* const glyph = Resident(runGlyph.Index);
+
+		if (glyph == nullptr) {
+			++droppedGlyphs_;
+			continue;
+		}
+
+		if (glyph->IsEmpty)
+			continue;
+
+		const float x0 = x + (runGlyph.X + glyph->XOffset) * scale;
+		const float y0 = y + glyph->YOffset * scale;
+		const float x1 = x0 + glyph->Width * scale;
+		const float y1 = y0 + glyph->Height * scale;
+
+		const float u0 = (glyph->Cell % cellsPerRow_) * cellSize_ * texelSize;
+		const float v0 = (glyph->Cell / cellsPerRow_) * cellSize_ * texelSize;
+		const float u1 = u0 + glyph->Width * texelSize;
+		const float v1 = v0 + glyph->Height * texelSize;
+
+		// Written straight into the mapped ring, in order
+		Vertex* const quad = vertices + size_t(glyphCount_) * 4;
+		quad[0] = { x0, y0, u0, v0, color };
+		quad[1] = { x1, y0, u1, v0, color };
+		quad[2] = { x1, y1, u1, v1, color };
+		quad[3] = { x0, y1, u0, v1, color };
+
+		++glyphCount_;
+	}
+}
+
+const TextRenderer::Glyph* TextRenderer::Resident(const uint32_t index) {
+	auto& glyph = glyphs_[index];
+
+	if (!glyph.HasMetrics) {
+		glyph.IsEmpty = stbtt_IsGlyphEmpty(font_.get(), static_cast<int>(index)) != 0;
+		glyph.HasMetrics = glyph.IsEmpty;
+	}
+
+	if (glyph.IsEmpty)
+		return &glyph;
+
+	if (glyph.Cell != NoCell) {
+		glyph.LastUsedFrame = frameNumber_;
+		lru_.splice(lru_.begin(), lru_, glyph.Lru);
+		return &glyph;
+	}
+
+	if (uploads_.size() == MaxUploadsPerFrame)
+		return nullptr;
+
+	uint32_t cell;
+
+	if (!freeCells_.empty()) {
+		cell = freeCells_.back();
+		freeCells_.pop_back();
+	}
+	else {
+		// Glyphs already drawn this frame must keep their cell
+		auto& victim = glyphs_[lru_.back()];
+		if (victim.LastUsedFrame == frameNumber_)
+			return nullptr;
+
+		cell = victim.Cell;
+		victim.Cell = NoCell;
+		lru_.pop_back();
+	}
+
+	glyph.Cell = cell;
+	Rasterize(index, glyph);
+
+	if (glyph.IsEmpty) {
+		freeCells_.push_back(cell);
+		glyph.Cell = NoCell;
+		return &glyph;
+	}
+
+	glyph.LastUsedFrame = frameNumber_;
+	lru_.push_front(index);
+	glyph.Lru = lru_.begin();
+
+	return &glyph;
+}
+
+void TextRenderer::Rasterize(const uint32_t index, Glyph& glyph) {
+	int width, height, xOffset, yOffset;
+	unsigned char* const field = stbtt_GetGlyphSDF(
+		font_.get(), scale_, static_cast<int>(index), DistanceFieldPadding, OnEdgeValue, static_cast<float>(OnEdgeValue) / DistanceFieldPadding,
+		&width, &height, &xOffset, &yOffset);
+
+	glyph.HasMetrics = true;
+
+	if (field == nullptr) {
+		glyph.IsEmpty = true;
+		return;
+	}
+
+	glyph.Width = std::min(width, static_cast<int>(cellSize_));
+	glyph.Height = std::min(height, static_cast<int>(cellSize_));
+	glyph.XOffset = xOffset;
+	glyph.YOffset = yOffset;
+
+	// The whole cell is written, linear filtering at the glyph border never reads what a previous glyph left
+	const VkDeviceSize cellBytes = VkDeviceSize(cellSize_) * cellSize_;
+	const VkDeviceSize offset = (VkDeviceSize(frame_) * MaxUploadsPerFrame + uploads_.size()) * cellBytes;
+	unsigned char* const destination = stagingData_ + offset;
+
+	std::memset(destination, 0, cellBytes);
+	for (int row = 0; row != glyph.Height; ++row) {
+		std::memcpy(destination + size_t(row) * cellSize_, field + size_t(row) * width, glyph.Width);
+	}
+
+	stbtt_FreeSDF(field, nullptr);
+
+	VkBufferImageCopy copy = {};
+	copy.bufferOffset = offset;
+	copy.bufferRowLength = cellSize_;
+	copy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	copy.imageOffset = { static_cast<int32_t>((glyph.Cell % cellsPerRow_) * cellSize_), static_cast<int32_t>((glyph.Cell / cellsPerRow_) * cellSize_), 0 };
+	copy.imageExtent = { cellSize_, cellSize_, 1 };
+	uploads_.push_back(copy);
+
+	++rasterizedGlyphs_;
+}
+
+void TextRenderer::Upload(VkCommandBuffer commandBuffer) {
+	if (uploads_.empty())
+		return;
+
+	const auto& dispatch = device_.Dispatch();
+
+	// Cells may be reused while earlier frames still sample them, the barrier also waits for their fragment shaders
+	const auto toTransfer = ImageBarrier(
+		atlas_->Handle(),
+		atlasInitialized_ ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		0, VK_ACCESS_TRANSFER_WRITE_BIT);
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toTransfer);
+
+	dispatch.vkCmdCopyBufferToImage(commandBuffer, staging_->Handle(), atlas_->Handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(uploads_.size()), uploads_.data());
+
+	const auto toShader = ImageBarrier(atlas_->Handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toShader);
+
+	atlasInitialized_ = true;
+	uploads_.clear();
+}
+
+void TextRenderer::Render(VkCommandBuffer commandBuffer, const VkExtent2D extent, FrameStats& frameStats) {
+	if (glyphCount_ == 0)
+		return;
+
+	const auto& dispatch = device_.Dispatch();
+
+	const VkDeviceSize frameOffset = VkDeviceSize(frame_) * MaxGlyphsPerFrame * 4 * sizeof(Vertex);
+	const VkBuffer vertexBuffer = vertexBuffer_->Handle();
+
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines_->Get(TextState()).Handle());
+	dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout_->Handle(), 0, 1, &descriptorSet_, 0, nullptr);
+	dispatch.vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &frameOffset);
+	dispatch.vkCmdBindIndexBuffer(commandBuffer, indexBuffer_->Handle(), 0, VK_INDEX_TYPE_UINT32);
+
+	const float scale[2] = { 2.0f / static_cast<float>(extent.width), 2.0f / static_cast<float>(extent.height) };
+	dispatch.vkCmdPushConstants(commandBuffer, pipelineLayout_->Handle(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(scale), scale);
+
+	dispatch.vkCmdDrawIndexed(commandBuffer, glyphCount_ * 6, 1, 0, 0, 0);
+	frameStats.RecordDraw(glyphCount_ * 2);
+}
+
+}
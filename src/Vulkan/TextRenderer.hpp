@@ -0,0 +1,144 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct stbtt_fontinfo;
+
+namespace Vulkan {
+	class Buffer;
+	class DescriptorPool;
+	class DescriptorSetLayout;
+	class Device;
+	class FrameStats;
+	class Image;
+	class ImageView;
+	class PipelineCompiler;
+	class PipelineLayout;
+	class PipelineVariants;
+	class RenderPass;
+	class Sampler;
+
+	// Text drawn from a TrueType font with a signed distance field glyph cache.
+	// Glyphs are rasterized on first use into the cells of an atlas, the least recently used ones being evicted
+	// when it is full; only a few are rasterized per frame, the others appear on the next frames.
+	// Strings are shaped once into glyph runs, and all the text of a frame is drawn with a single indexed draw.
+	class TextRenderer final {
+	public:
+
+		// Glyph positions along the baseline, in pixels at the distance field size
+		struct GlyphRun {
+			struct Glyph {
+				uint32_t Index;
+				float X;
+			};
+
+			std::vector<Glyph> Glyphs;
+			float Advance{};
+		};
+
+		// Colors are packed as 0xAABBGGRR
+		static constexpr uint32_t White = 0xFFFFFFFF;
+
+		VULKAN_NON_COPIABLE(TextRenderer)
+
+		// The font data must outlive the renderer
+		TextRenderer(const Device& device, PipelineCompiler& pipelineCompiler, const RenderPass* renderPass, VkFormat colorFormat, VkFormat depthFormat, uint32_t frameCount, const std::vector<char>& fontData);
+		~TextRenderer();
+
+		GlyphRun Shape(const std::string& text) const;
+		// Width of the shaped text drawn at the given pixel size
+		static float Width(const GlyphRun& run, float size) { return run.Advance * size / DistanceFieldSize; }
+
+		// Start queuing the text of the frame in flight about to be recorded
+		void BeginFrame(uint32_t frame);
+
+		// (x, y) is the start of the baseline, in pixels from the top left corner. Strings are shaped on first use.
+		void Draw(const std::string& text, float x, float y, float size, uint32_t color = White);
+		void Draw(const GlyphRun& run, float x, float y, float size, uint32_t color = White);
+
+		// Copy the glyphs rasterized this frame into the atlas, outside of any render pass
+		void Upload(VkCommandBuffer commandBuffer);
+		// Draw the text of the frame, within the scene rendering once its viewport is set
+		void Render(VkCommandBuffer commandBuffer, VkExtent2D extent, FrameStats& frameStats);
+
+		// Glyphs that could not be drawn: atlas full of glyphs used this frame, upload budget or vertex ring exhausted
+		uint64_t DroppedGlyphs() const { return droppedGlyphs_; }
+		uint64_t RasterizedGlyphs() const { return rasterizedGlyphs_; }
+
+	private:
+
+		// Pixel size the distance fields are rasterized at, and the distance range around the edge they cover
+		static constexpr float DistanceFieldSize = 32.0f;
+		static constexpr int DistanceFieldPadding = 4;
+		static constexpr uint32_t AtlasSize = 1024;
+		static constexpr uint32_t MaxUploadsPerFrame = 64;
+		static constexpr uint32_t MaxGlyphsPerFrame = 32768;
+		static constexpr size_t MaxCachedRuns = 4096;
+		static constexpr uint32_t NoCell = ~0u;
+
+		struct Vertex {
+			float X, Y;
+			float U, V;
+			uint32_t Color;
+		};
+
+		struct Glyph {
+			uint32_t Cell{ NoCell };
+			uint64_t LastUsedFrame{};
+			// Position in the least recently used list, valid while the glyph holds a cell
+			std::list<uint32_t>::iterator Lru;
+			// Distance field bitmap size and offset from the pen position, at the distance field size
+			int Width{}, Height{}, XOffset{}, YOffset{};
+			bool IsEmpty{};
+			bool HasMetrics{};
+		};
+
+		// Null when the glyph cannot get a cell this frame
+		const Glyph* Resident(uint32_t index);
+		void Rasterize(uint32_t index, Glyph& glyph);
+
+		const Device& device_;
+		const std::unique_ptr<stbtt_fontinfo> font_;
+		float scale_{};
+		uint32_t cellSize_{};
+		uint32_t cellsPerRow_{};
+
+		std::unique_ptr<Image> atlas_;
+		std::unique_ptr<ImageView> atlasView_;
+		std::unique_ptr<Sampler> sampler_;
+		bool atlasInitialized_{};
+
+		std::unique_ptr<DescriptorSetLayout> descriptorSetLayout_;
+		std::unique_ptr<DescriptorPool> descriptorPool_;
+		VkDescriptorSet descriptorSet_{};
+		std::unique_ptr<PipelineLayout> pipelineLayout_;
+		std::unique_ptr<PipelineVariants> pipelines_;
+
+		// Persistently mapped, one region per frame in flight
+		std::unique_ptr<Buffer> staging_;
+		std::unique_ptr<Buffer> vertexBuffer_;
+		std::unique_ptr<Buffer> indexBuffer_;
+		unsigned char* stagingData_{};
+		unsigned char* vertexData_{};
+
+		std::unordered_map<uint32_t, Glyph> glyphs_;
+		// Glyph indices holding a cell, most recently used first
+		std::list<uint32_t> lru_;
+		std::vector<uint32_t> freeCells_;
+		std::unordered_map<std::string, GlyphRun> runs_;
+
+		uint32_t frame_{};
+		uint64_t frameNumber_{};
+		std::vector<VkBufferImageCopy> uploads_;
+		uint32_t glyphCount_{};
+		uint64_t droppedGlyphs_{};
+		uint64_t rasterizedGlyphs_{};
+	};
+
+}
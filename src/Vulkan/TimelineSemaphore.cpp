@@ -0,0 +1,62 @@
+#include "TimelineSemaphore.hpp"
+#include "Device.hpp"
+
+namespace Vulkan {
+
+TimelineSemaphore::TimelineSemaphore(const class Device& device, const uint64_t initialValue) :
+	device_(device),
+	pendingValue_(initialValue)
+{
+	VkSemaphoreTypeCreateInfoKHR typeInfo = {};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+	typeInfo.initialValue = initialValue;
+
+	VkSemaphoreCreateInfo semaphoreInfo = {};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &typeInfo;
+
+	Check(device.Dispatch().vkCreateSemaphore(device.Handle(), &semaphoreInfo, device.Allocator(), &semaphore_), "create timeline semaphore");
+}
+
+TimelineSemaphore::~TimelineSemaphore() {
+	if (semaphore_ != nullptr) {
+		device_.Dispatch().vkDestroySemaphore(device_.Handle(), semaphore_, device_.Allocator());
+		semaphore_ = nullptr;
+	}
+}
+
+uint64_t TimelineSemaphore::CompletedValue() const {
+	return device_.GetSemaphoreCounterValue(semaphore_);
+}
+
+bool TimelineSemaphore::Wait(const uint64_t value, const uint64_t timeout) const {
+	VkSemaphoreWaitInfoKHR waitInfo = {};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &semaphore_;
+	waitInfo.pValues = &value;
+
+	const auto result = device_.WaitSemaphores(waitInfo, timeout);
+
+	if (result == VK_TIMEOUT)
+		return false;
+
+	Check(result, "wait for timeline semaphore");
+	return true;
+}
+
+void TimelineSemaphore::Signal(const uint64_t value) {
+	VkSemaphoreSignalInfoKHR signalInfo = {};
+	signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO_KHR;
+	signalInfo.semaphore = semaphore_;
+	signalInfo.value = value;
+
+	device_.SignalSemaphore(signalInfo);
+
+	// Keep the pending value ahead of anything signaled from the host
+	uint64_t pending = pendingValue_;
+	while (pending < value && !pendingValue_.compare_exchange_weak(pending, value)) {}
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace Vulkan {
+	class Device;
+
+	// Semaphore holding a monotonically increasing 64 bits value (VK_KHR_timeline_semaphore).
+	// Each submission signals a new value, the host or other queues wait for a value to be reached.
+	class TimelineSemaphore final {
+	public:
+
+		VULKAN_NON_COPIABLE(TimelineSemaphore)
+
+		explicit TimelineSemaphore(const Device& device, uint64_t initialValue = 0);
+		~TimelineSemaphore();
+
+		const class Device& Device() const { return device_; }
+
+		// Reserve the next value to be signaled by a submission
+		uint64_t NextValue() { return ++pendingValue_; }
+		// Last value reserved with NextValue()
+		uint64_t PendingValue() const { return pendingValue_; }
+		// Last value reached on the device
+		uint64_t CompletedValue() const;
+
+		bool IsCompleted(uint64_t value) const { return CompletedValue() >= value; }
+		bool Wait(uint64_t value, uint64_t timeout) const;
+		void Signal(uint64_t value);
+
+	private:
+
+		const class Device& device_;
+
+		std::atomic<uint64_t> pendingValue_;
+
+		VULKAN_HANDLE(VkSemaphore, semaphore_)
+	};
+
+}
@@ -0,0 +1,77 @@
+#include "TimestampQueryPool.hpp"
+
+#include "Device.hpp"
+#include "Enumerate.hpp"
+
+namespace Vulkan {
+
+TimestampQueryPool::TimestampQueryPool(const class Device& device, const uint32_t queueFamilyIndex, const uint32_t frameCount, const uint32_t timestampsPerFrame) :
+	device_(device),
+	timestampsPerFrame_(timestampsPerFrame),
+	written_(frameCount, false),
+	results_(timestampsPerFrame * 2)
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties);
+
+	const auto queueFamilies = GetEnumerateVector(device.PhysicalDevice(), vkGetPhysicalDeviceQueueFamilyProperties);
+
+	validBits_ = queueFamilies[queueFamilyIndex].timestampValidBits;
+	period_ = properties.limits.timestampPeriod;
+
+	VkQueryPoolCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	createInfo.queryCount = frameCount * timestampsPerFrame;
+
+	Check(device.Dispatch().vkCreateQueryPool(device.Handle(), &createInfo, device.Allocator(), &queryPool_), "create timestamp query pool");
+}
+
+TimestampQueryPool::~TimestampQueryPool() {
+	if (queryPool_ != nullptr) {
+		device_.Dispatch().vkDestroyQueryPool(device_.Handle(), queryPool_, device_.Allocator());
+		queryPool_ = nullptr;
+	}
+}
+
+void TimestampQueryPool::Reset(VkCommandBuffer commandBuffer, const uint32_t frame) {
+	device_.Dispatch().vkCmdResetQueryPool(commandBuffer, queryPool_, frame * timestampsPerFrame_, timestampsPerFrame_);
+	written_[frame] = IsSupported();
+}
+
+void TimestampQueryPool::Write(VkCommandBuffer commandBuffer, const uint32_t frame, const uint32_t timestamp, const VkPipelineStageFlagBits stage) {
+	if (IsSupported())
+		device_.Dispatch().vkCmdWriteTimestamp(commandBuffer, stage, queryPool_, frame * timestampsPerFrame_ + timestamp);
+}
+
+bool TimestampQueryPool::Fetch(const uint32_t frame) {
+	if (!written_[frame])
+		return false;
+
+	// Each result is followed by its availability
+	const auto result = device_.Dispatch().vkGetQueryPoolResults(
+		device_.Handle(), queryPool_, frame * timestampsPerFrame_, timestampsPerFrame_,
+		results_.size() * sizeof(uint64_t), results_.data(), 2 * sizeof(uint64_t),
+		VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+	if (result == VK_NOT_READY)
+		return false;
+
+	Check(result, "get timestamp query results");
+
+	for (uint32_t i = 0; i != timestampsPerFrame_; ++i) {
+		if (results_[i * 2 + 1] == 0)
+			return false;
+	}
+
+	return true;
+}
+
+double TimestampQueryPool::Elapsed(const uint32_t begin, const uint32_t end) const {
+	const uint64_t mask = validBits_ >= 64 ? ~0ull : (1ull << validBits_) - 1;
+	const uint64_t ticks = (results_[end * 2] - results_[begin * 2]) & mask;
+
+	return static_cast<double>(ticks) * period_ / 1000000.0;
+}
+
+}
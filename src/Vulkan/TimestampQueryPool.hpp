@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+#include <vector>
+
+namespace Vulkan {
+	class Device;
+
+	// GPU timestamps, a fixed number per frame in flight.
+	// Results of a frame slot are fetched once the device is known to be done with its last use.
+	class TimestampQueryPool final {
+	public:
+
+		VULKAN_NON_COPIABLE(TimestampQueryPool)
+
+		TimestampQueryPool(const Device& device, uint32_t queueFamilyIndex, uint32_t frameCount, uint32_t timestampsPerFrame);
+		~TimestampQueryPool();
+
+		bool IsSupported() const { return validBits_ != 0; }
+
+		void Reset(VkCommandBuffer commandBuffer, uint32_t frame);
+		void Write(VkCommandBuffer commandBuffer, uint32_t frame, uint32_t timestamp, VkPipelineStageFlagBits stage);
+
+		// Read back the timestamps of a frame slot, false when they are not available
+		bool Fetch(uint32_t frame);
+		// Milliseconds between two fetched timestamps
+		double Elapsed(uint32_t begin, uint32_t end) const;
+
+	private:
+
+		const class Device& device_;
+		const uint32_t timestampsPerFrame_;
+
+		uint32_t validBits_{};
+		double period_{};
+		std::vector<bool> written_;
+		std::vector<uint64_t> results_;
+
+		VULKAN_HANDLE(VkQueryPool, queryPool_)
+	};
+
+}
@@ -0,0 +1,275 @@
+#include "VideoStream.hpp"
+
+#include "Buffer.hpp"
+#include "ComputePipeline.hpp"
+#include "DescriptorPool.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+#include "PipelineLayout.hpp"
+#include "ShaderModule.hpp"
+#include "SwapChain.hpp"
+#include "TimelineSemaphore.hpp"
+#include "../Utilities/Log.hpp"
+
+#include <csignal>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace Vulkan {
+
+	namespace {
+		// Each shader invocation converts a block of 8x2 pixels
+		constexpr uint32_t BlockWidth = 8;
+		constexpr uint32_t BlockHeight = 2;
+		constexpr uint32_t WorkGroupSize = 64;
+
+		struct PushConstants {
+			uint32_t SourceWidth;
+			uint32_t SourceHeight;
+			uint32_t Width;
+			uint32_t Height;
+			uint32_t Bgra;
+			uint32_t Yuv;
+		};
+
+		bool IsRgba8(const VkFormat format) {
+			return format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB;
+		}
+
+		bool IsBgra8(const VkFormat format) {
+			return format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+		}
+
+		size_t FrameSize(const VideoStream::Format format, const uint32_t width, const uint32_t height) {
+			const size_t pixels = size_t(width) * height;
+			return format == VideoStream::Format::Y4m ? pixels + pixels / 2 : pixels * 4;
+		}
+	}
+
+bool VideoStream::IsSupported(const SwapChain& swapChain) {
+	return (swapChain.ImageUsage() & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) && (IsRgba8(swapChain.Format()) || IsBgra8(swapChain.Format()));
+}
+
+VideoStream::VideoStream(
+	const class Device& device,
+	const PipelineCache& pipelineCache,
+	const TimelineSemaphore& timeline,
+	const std::string& path,
+	const Format format,
+	const VkExtent2D extent) :
+	device_(device),
+	timeline_(timeline),
+	path_(path),
+	format_(format),
+	width_(extent.width & ~(BlockWidth - 1)),
+	height_(extent.height & ~(BlockHeight - 1)),
+	frameSize_(FrameSize(format, width_, height_))
+{
+	if (width_ == 0 || height_ == 0)
+		throw std::runtime_error("video stream frames must be at least 8x2 pixels");
+
+	file_ = std::fopen(path.c_str(), "wb");
+	if (file_ == nullptr)
+		throw std::runtime_error("failed to open video stream '" + path + "'");
+
+	// Frames are written in large blocks, stdio buffering would only add a copy
+	std::setvbuf(file_, nullptr, _IONBF, 0);
+
+#ifdef SIGPIPE
+	// A reader closing the pipe must fail the write rather than terminate the application
+	std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+	if (format == Format::Y4m) {
+		std::ostringstream header;
+		header << "YUV4MPEG2 W" << width_ << " H" << height_ << " F" << FramesPerSecond << ":1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n";
+
+		const std::string text = header.str();
+		std::fwrite(text.data(), 1, text.size(), file_);
+	}
+
+	descriptorSetLayout_.reset(new DescriptorSetLayout(device, {
+		{ 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+		{ 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr }
+	}));
+
+	pipelineLayout_.reset(new class PipelineLayout(device, { descriptorSetLayout_->Handle() }, { { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants) } }));
+
+	{
+		const ShaderModule shaderModule(device, "../assets/shaders/video_convert.comp.spv");
+		pipeline_.reset(new ComputePipeline(device, pipelineCache, *pipelineLayout_, shaderModule));
+	}
+
+	descriptorPool_.reset(new DescriptorPool(device, { { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * RingSize } }, RingSize, 0));
+	descriptorSets_ = descriptorPool_->Allocate(*descriptorSetLayout_, RingSize);
+
+	// The shader writes whole words, the Y4M chroma planes are a multiple of 4 bytes given the block size
+	ring_.reset(new ReadbackRing(
+		device, timeline, RingSize, frameSize_, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "video stream",
+		[this](const ReadbackRing::Slot& slot) { Write(slot); }));
+
+	std::vector<VkDescriptorBufferInfo> bufferInfos(RingSize);
+	std::vector<VkWriteDescriptorSet> writes(RingSize);
+
+	for (size_t i = 0; i != RingSize; ++i) {
+		bufferInfos[i] = { (*ring_)[i].Buffer->Handle(), 0, VK_WHOLE_SIZE };
+
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = descriptorSets_[i];
+		writes[i].dstBinding = 1;
+		writes[i].descriptorCount = 1;
+		writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[i].pBufferInfo = &bufferInfos[i];
+	}
+
+	device.Dispatch().vkUpdateDescriptorSets(device.Handle(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+	LOG_INFO("video stream: {}x{} {} frames to '{}'", width_, height_, format == Format::Y4m ? "Y4M" : "RGBA", path);
+}
+
+VideoStream::~VideoStream() {
+	ring_->Stop();
+	std::fclose(file_);
+
+	LOG_INFO("video stream: {} frames written to '{}', {} dropped", Written(), path_, Dropped());
+}
+
+void VideoStream::SetSwapChain(const SwapChain* const swapChain) {
+	// The source buffer and the descriptor sets may still be used by the last frames
+	timeline_.Wait(lastFrameValue_, std::numeric_limits<uint64_t>::max());
+
+	swapChain_ = nullptr;
+	source_.reset();
+
+	if (swapChain == nullptr)
+		return;
+
+	if (!IsSupported(*swapChain)) {
+		LOG_WARNING("video stream: swap chain format {} cannot be streamed, frames are skipped", swapChain->Format());
+		return;
+	}
+
+	const auto& extent = swapChain->Extent();
+
+	source_.reset(new Buffer(
+		device_, VkDeviceSize(extent.width) * extent.height * 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "video stream source"));
+
+	const VkDescriptorBufferInfo bufferInfo = { source_->Handle(), 0, VK_WHOLE_SIZE };
+	std::vector<VkWriteDescriptorSet> writes(RingSize);
+
+	for (size_t i = 0; i != RingSize; ++i) {
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = descriptorSets_[i];
+		writes[i].dstBinding = 0;
+		writes[i].descriptorCount = 1;
+		writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[i].pBufferInfo = &bufferInfo;
+	}
+
+	device_.Dispatch().vkUpdateDescriptorSets(device_.Handle(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+	swapChain_ = swapChain;
+	bgra_ = IsBgra8(swapChain->Format());
+}
+
+void VideoStream::Record(VkCommandBuffer commandBuffer, const uint32_t imageIndex, const uint64_t frameValue) {
+	if (swapChain_ == nullptr || failed_)
+		return;
+
+	ReadbackRing::Slot* const slot = ring_->Acquire();
+	if (slot == nullptr)
+		return;
+
+	const auto& dispatch = device_.Dispatch();
+	const auto& extent = swapChain_->Extent();
+	const VkImage image = swapChain_->Images()[imageIndex];
+
+	// The previous frame conversion may still be reading the source buffer
+	VkImageMemoryBarrier toTransfer = {};
+	toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	toTransfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	toTransfer.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toTransfer.image = image;
+	toTransfer.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &toTransfer);
+
+	VkBufferImageCopy region = {};
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageExtent = { extent.width, extent.height, 1 };
+
+	dispatch.vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, source_->Handle(), 1, &region);
+
+	// Back to present layout, and make the copy visible to the conversion
+	VkImageMemoryBarrier toPresent = toTransfer;
+	toPresent.srcAccessMask = 0;
+	toPresent.dstAccessMask = 0;
+	toPresent.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	toPresent.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	VkBufferMemoryBarrier toCompute = {};
+	toCompute.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	toCompute.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	toCompute.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	toCompute.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toCompute.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toCompute.buffer = source_->Handle();
+	toCompute.offset = 0;
+	toCompute.size = VK_WHOLE_SIZE;
+
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		0, nullptr, 1, &toCompute, 1, &toPresent);
+
+	const PushConstants constants = { extent.width, extent.height, width_, height_, bgra_ ? 1u : 0u, format_ == Format::Y4m ? 1u : 0u };
+	const uint32_t blocks = (width_ / BlockWidth) * (height_ / BlockHeight);
+
+	dispatch.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_->Handle());
+	dispatch.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout_->Handle(), 0, 1, &descriptorSets_[slot->Index], 0, nullptr);
+	dispatch.vkCmdPushConstants(commandBuffer, pipelineLayout_->Handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+	dispatch.vkCmdDispatch(commandBuffer, (blocks + WorkGroupSize - 1) / WorkGroupSize, 1, 1);
+
+	// Make the converted frame visible to the host once the frame value is reached
+	VkBufferMemoryBarrier toHost = toCompute;
+	toHost.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	toHost.buffer = slot->Buffer->Handle();
+
+	dispatch.vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+		0, nullptr, 1, &toHost, 0, nullptr);
+
+	ring_->Submit(*slot, frameValue);
+	lastFrameValue_ = frameValue;
+}
+
+void VideoStream::Collect() {
+	ring_->Collect();
+}
+
+void VideoStream::Write(const ReadbackRing::Slot& slot) {
+	// Once the reader is gone (closed pipe, full disk) the remaining frames are skipped
+	if (failed_)
+		return;
+
+	static const char frameHeader[] = "FRAME\n";
+
+	const bool written =
+		(format_ != Format::Y4m || std::fwrite(frameHeader, 1, sizeof(frameHeader) - 1, file_) == sizeof(frameHeader) - 1) &&
+		std::fwrite(slot.Data, 1, frameSize_, file_) == frameSize_;
+
+	if (!written) {
+		failed_ = true;
+		LOG_ERROR("video stream: failed to write frame {} to '{}', streaming stopped", slot.Number, path_);
+	}
+}
+
+}
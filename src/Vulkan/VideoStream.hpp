@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include "ReadbackRing.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Vulkan {
+	class Buffer;
+	class ComputePipeline;
+	class DescriptorPool;
+	class DescriptorSetLayout;
+	class Device;
+	class PipelineCache;
+	class PipelineLayout;
+	class SwapChain;
+	class TimelineSemaphore;
+
+	// Streams every presented frame as raw video to a file or a named pipe, for an external encoder to read.
+	// The swap chain image is copied to a device local buffer, a compute pass converts it to the output format
+	// straight into a host visible ring buffer, and a writer thread hands the frame to the output in one write.
+	// Recording never waits: when the output falls behind and every buffer is busy, the frame is dropped.
+	class VideoStream final {
+	public:
+
+		enum class Format {
+			// YUV4MPEG2, planar 4:2:0 BT.709 limited range, readable by ffmpeg and most encoders
+			Y4m,
+			// Packed RGBA, 4 bytes per pixel and no header
+			Rgba
+		};
+
+		VULKAN_NON_COPIABLE(VideoStream)
+
+		static constexpr size_t RingSize = 4;
+		static constexpr uint32_t FramesPerSecond = 60;
+
+		// The swap chain must be created with transfer source usage and use an 8 bits RGBA or BGRA format
+		static bool IsSupported(const SwapChain& swapChain);
+
+		// The frame size is fixed for the whole stream, later swap chains are cropped or padded with black to it
+		VideoStream(const Device& device, const PipelineCache& pipelineCache, const TimelineSemaphore& timeline, const std::string& path, Format format, VkExtent2D extent);
+		~VideoStream();
+
+		VkExtent2D Extent() const { return { width_, height_ }; }
+
+		// Swap chain the next frames are copied from, null while it is recreated
+		void SetSwapChain(const SwapChain* swapChain);
+
+		// Convert the swap chain image (in present layout) at the end of a frame that signals frameValue on the timeline
+		void Record(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint64_t frameValue);
+		// Hand the frames completed on the device to the writer thread
+		void Collect();
+
+		uint64_t Written() const { return ring_->Written(); }
+		uint64_t Dropped() const { return ring_->Dropped(); }
+
+	private:
+
+		void Write(const ReadbackRing::Slot& slot);
+
+		const class Device& device_;
+		const TimelineSemaphore& timeline_;
+		const std::string path_;
+		const Format format_;
+		const uint32_t width_;
+		const uint32_t height_;
+		const size_t frameSize_;
+
+		std::FILE* file_{};
+		// Set by the writer thread once the output cannot be written anymore
+		std::atomic<bool> failed_{};
+
+		const SwapChain* swapChain_{};
+		bool bgra_{};
+		uint64_t lastFrameValue_{};
+
+		std::unique_ptr<DescriptorSetLayout> descriptorSetLayout_;
+		std::unique_ptr<class PipelineLayout> pipelineLayout_;
+		std::unique_ptr<ComputePipeline> pipeline_;
+		std::unique_ptr<DescriptorPool> descriptorPool_;
+		std::vector<VkDescriptorSet> descriptorSets_;
+
+		// Copy of the swap chain image, sized for the current swap chain
+		std::unique_ptr<Buffer> source_;
+
+		// Stopped first on destruction, its writer thread uses the output file
+		std::unique_ptr<ReadbackRing> ring_;
+	};
+
+}
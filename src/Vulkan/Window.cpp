@@ -1,14 +1,32 @@
 #include "Window.hpp"
 
+#include "../Utilities/Log.hpp"
 #include "../Utilities/StbImage.hpp"
 
-#include <iostream>
+#include <future>
+#include <memory>
 
 namespace Vulkan {
 
 	namespace {
+		struct Icon {
+			int Width{};
+			int Height{};
+			std::unique_ptr<stbi_uc, void (*)(void*)> Pixels{ nullptr, stbi_image_free };
+		};
+
+		Icon DecodeIcon(const char* const filename) {
+			Icon icon;
+			icon.Pixels.reset(stbi_load(filename, &icon.Width, &icon.Height, nullptr, 4));
+
+			if (!icon.Pixels)
+				throw std::runtime_error("failed to load icon");
+
+			return icon;
+		}
+
 		void GlfwErrorCallback(const int error, const char* const description) {
-			std::cerr << "ERROR: GLFW: " << description << " (code: " << error << ")" << std::endl;
+			LOG_ERROR("GLFW: {} (code: {})", description, error);
 		}
 
 		void GlfwKeyCallback(GLFWwindow* window, const int key, const int scancode, const int action, const int mods) {
@@ -43,6 +61,9 @@ namespace Vulkan {
 	}
 
 	Window::Window(const WindowConfig& config) : config_(config) {
+		// Decoding does not involve GLFW, it overlaps with its initialization and the window creation
+		auto iconDecoding = std::async(std::launch::async, DecodeIcon, "../assets/textures/VulkanIcon.png");
+
 		glfwSetErrorCallback(GlfwErrorCallback);
 
 		if (!glfwInit())
@@ -60,13 +81,14 @@ namespace Vulkan {
 		if (window_ == nullptr)
 			throw std::runtime_error("failed to create window");
 
+		const Icon decodedIcon = iconDecoding.get();
+
 		GLFWimage icon;
-		icon.pixels = stbi_load("../assets/textures/VulkanIcon.png", &icon.width, &icon.height, nullptr, 4);
-		if (icon.pixels == nullptr)
-			throw std::runtime_error("failed to load icon");
+		icon.width = decodedIcon.Width;
+		icon.height = decodedIcon.Height;
+		icon.pixels = decodedIcon.Pixels.get();
 
 		glfwSetWindowIcon(window_, 1, &icon);
-		stbi_image_free(icon.pixels);
 
 		if (config.CursorDisabled)
 			glfwSetInputMode(window_, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -132,6 +154,10 @@ namespace Vulkan {
 		return size.height == 0 && size.width == 0;
 	}
 
+	void Window::PollEvents() const {
+		glfwPollEvents();
+	}
+
 	void Window::Run() {
 		glfwSetTime(0.0);
 
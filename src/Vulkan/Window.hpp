@@ -41,6 +41,7 @@ namespace Vulkan {
 		// Methods
 		void Close();
 		bool IsMinimized() const;
+		void PollEvents() const;
 		void Run();
 		void WaitForEvents() const;
 
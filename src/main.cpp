@@ -1,20 +1,96 @@
 #include "TriangleApp.hpp"
 
 #include "Vulkan/Version.hpp"
+#include "Vulkan/DispatchBenchmark.hpp"
+#include "Vulkan/ParticleBenchmark.hpp"
 #include "Vulkan/WindowConfig.hpp"
-#include "Vulkan/Enumerate.hpp"
+#include "Vulkan/Instance.hpp"
+#include "Vulkan/PhysicalDeviceInfo.hpp"
 #include "Vulkan/Strings.hpp"
+#include "Vulkan/Surface.hpp"
 #include "Vulkan/SwapChain.hpp"
-#include "Vulkan/Strings.hpp"
 
-#include <Utilities/Console.hpp>
+#include <Utilities/Log.hpp>
 
 #include <stdexcept>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <string>
 
 
 namespace {
 
+	struct Options {
+		bool LowLatency{};
+		bool Stats{};
+		bool HostAllocator{};
+		bool PostProcessing{};
+		std::string LogFile;
+		std::string Device;
+		std::string Benchmark;
+		std::string Stream;
+		std::string Font;
+		std::string Model;
+		uint32_t Sprites{};
+		uint32_t Particles{};
+		uint32_t City{};
+		uint32_t Lights{};
+		Vulkan::VideoStream::Format StreamFormat{ Vulkan::VideoStream::Format::Y4m };
+	};
+
+	Vulkan::VideoStream::Format ParseStreamFormat(const std::string& name) {
+		if (name == "y4m")
+			return Vulkan::VideoStream::Format::Y4m;
+		if (name == "rgba")
+			return Vulkan::VideoStream::Format::Rgba;
+
+		throw std::invalid_argument("unknown stream format '" + name + "' (expected y4m or rgba)");
+	}
+
+	Options ParseOptions(const int argc, const char* argv[]) {
+		Options options;
+
+		for (int i = 1; i < argc; ++i) {
+			const std::string argument(argv[i]);
+
+			if (argument == "--low-latency")
+				options.LowLatency = true;
+			else if (argument == "--stats")
+				options.Stats = true;
+			else if (argument == "--host-allocator")
+				options.HostAllocator = true;
+			else if (argument == "--post-process")
+				options.PostProcessing = true;
+			else if (argument == "--log" && i + 1 < argc)
+				options.LogFile = argv[++i];
+			else if (argument == "--device" && i + 1 < argc)
+				options.Device = argv[++i];
+			else if (argument == "--benchmark" && i + 1 < argc)
+				options.Benchmark = argv[++i];
+			else if (argument == "--stream" && i + 1 < argc)
+				options.Stream = argv[++i];
+			else if (argument == "--stream-format" && i + 1 < argc)
+				options.StreamFormat = ParseStreamFormat(argv[++i]);
+			else if (argument == "--font" && i + 1 < argc)
+				options.Font = argv[++i];
+			else if (argument == "--model" && i + 1 < argc)
+				options.Model = argv[++i];
+			else if (argument == "--sprites" && i + 1 < argc)
+				options.Sprites = static_cast<uint32_t>(std::stoul(argv[++i]));
+			else if (argument == "--particles" && i + 1 < argc)
+				options.Particles = static_cast<uint32_t>(std::stoul(argv[++i]));
+			else if (argument == "--city" && i + 1 < argc)
+				options.City = static_cast<uint32_t>(std::stoul(argv[++i]));
+			else if (argument == "--lights" && i + 1 < argc)
+				options.Lights = static_cast<uint32_t>(std::stoul(argv[++i]));
+			else
+				throw std::invalid_argument("unknown command line argument '" + argument + "'");
+		}
+
+		return options;
+	}
+
 	void PrintVulkanSdkInformation() {
 		std::cout << "Vulkan SDK Header Version: " << VK_HEADER_VERSION << std::endl;
 	}
@@ -28,26 +104,50 @@ namespace {
 		}
 	}
 
-	void PrintVulkanDevices(const Vulkan::Application& application) {
-		std::cout << "Vulkan Devices: " << std::endl;
+	std::vector<Vulkan::PhysicalDeviceInfo> GetVulkanDevices(Vulkan::Application& application) {
+		const auto phase = application.StartupTimer().Measure("device queries");
+		const uint32_t apiVersion = application.Instance().ApiVersion();
+		VkSurfaceKHR surface = application.Surface().Handle();
+
+		// Each snapshot is a few dozen driver queries, devices are queried concurrently
+		std::vector<std::future<Vulkan::PhysicalDeviceInfo>> queries;
 
 		for (const auto& device : application.PhysicalDevices()) {
-			VkPhysicalDeviceProperties prop;
-			vkGetPhysicalDeviceProperties(device, &prop);
+			queries.push_back(std::async(std::launch::async, [device, apiVersion, surface]() { return Vulkan::PhysicalDeviceInfo(device, apiVersion, surface); }));
+		}
+
+		std::vector<Vulkan::PhysicalDeviceInfo> devices;
+
+		for (auto& query : queries) {
+			devices.push_back(query.get());
+		}
+
+		return devices;
+	}
+
+	void PrintVulkanDevices(const std::vector<Vulkan::PhysicalDeviceInfo>& devices) {
+		std::cout << "Vulkan Devices: " << std::endl;
 
-			VkPhysicalDeviceFeatures features;
-			vkGetPhysicalDeviceFeatures(device, &features);
+		for (size_t i = 0; i != devices.size(); ++i) {
+			const auto& prop = devices[i].Properties();
+			const auto score = Vulkan::ScoreDevice(devices[i]);
 
 			const Vulkan::Version vulkanVersion(prop.apiVersion);
 			const Vulkan::Version driverVersion(prop.driverVersion, prop.vendorID);
 
-			std::cout << "- [" << prop.deviceID << "] ";
+			std::cout << "- " << i << ": [" << prop.deviceID << "] ";
 			std::cout << Vulkan::toString(prop.vendorID) << " '" << prop.deviceName;
 			std::cout << "' (";
 			std::cout << prop.deviceType << ": ";
 			std::cout << "vulkan " << vulkanVersion << ", ";
-			std::cout << "driver " << driverVersion;
-			std::cout << ")" << std::endl;
+			std::cout << "driver " << driverVersion << ", ";
+			std::cout << devices[i].DeviceLocalMemory() / (1024 * 1024) << " MB";
+			std::cout << ") ";
+
+			if (score.IsEligible())
+				std::cout << "score " << score.Value << std::endl;
+			else
+				std::cout << "unsuitable: " << score.Rejection << std::endl;
 		}
 	}
 
@@ -59,36 +159,52 @@ namespace {
 		std::cout << "- present mode: " << Vulkan::toString(swapChain.PresentMode()) << std::endl;
 	}
 
-	void SetVulkanDevice(Vulkan::Application& application) {
-		const auto& physicalDevices = application.PhysicalDevices();
-		const auto result = std::find_if(physicalDevices.begin(), physicalDevices.end(), [](const VkPhysicalDevice& device)
-			{
-				// We want a device with geometry shader support
-				VkPhysicalDeviceFeatures deviceFeatures;
-				vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+	void PrintDispatchBenchmark(const Vulkan::Application& application) {
+		std::cout << "Dispatch benchmark (ns per call): " << std::endl;
 
-				if (!deviceFeatures.geometryShader)
-					return false;
+		for (const auto& result : Vulkan::RunDispatchBenchmark(application.Device(), 1 << 20)) {
+			std::cout << "- " << std::left << std::setw(20) << result.Command << std::right << std::fixed << std::setprecision(2);
+			std::cout << "loader " << std::setw(8) << result.LoaderNanoseconds << ", ";
+			std::cout << "direct " << std::setw(8) << result.DirectNanoseconds << std::defaultfloat << std::endl;
+		}
+	}
 
-				// We want a device with a graphics queue
-				const auto queueFamilies = Vulkan::GetEnumerateVector(device, vkGetPhysicalDeviceQueueFamilyProperties);
-				const auto hasGraphicsQueue = std::find_if(queueFamilies.begin(), queueFamilies.end(), [](const VkQueueFamilyProperties& queueFamily)
-					{
-						return queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT;
-					});
+	void PrintParticleBenchmark(const Vulkan::Application& application) {
+		std::cout << "Particle benchmark (simulation, emission and compaction per step): " << std::endl;
 
-				return hasGraphicsQueue != queueFamilies.end();
-			});
+		for (const auto& result : Vulkan::RunParticleBenchmark(application.Device(), { 1u << 20, 4u << 20, 16u << 20 }, 300)) {
+			std::cout << "- " << std::setw(3) << (result.Capacity >> 20) << "M particles: " << std::fixed << std::setprecision(2);
+			std::cout << std::setw(8) << result.StepMilliseconds << " ms per step, ";
+			std::cout << std::setw(8) << result.ParticlesPerSecond / 1e6 << " M particles/s ";
+			std::cout << "(" << result.AliveCount << " alive)" << std::defaultfloat << std::endl;
+		}
+	}
 
-		if (result == physicalDevices.end())
-			throw std::runtime_error("cannot find a suitable device");
+	void RunBenchmark(const Vulkan::Application& application, const std::string& benchmark) {
+		if (benchmark == "dispatch")
+			PrintDispatchBenchmark(application);
+		else if (benchmark == "particles")
+			PrintParticleBenchmark(application);
+		else
+			throw std::invalid_argument("unknown benchmark '" + benchmark + "' (expected dispatch or particles)");
+	}
 
-		application.SetPhysicalDevice(*result);
+	void SetVulkanDevice(Vulkan::Application& application, const std::vector<Vulkan::PhysicalDeviceInfo>& devices, const std::string& override) {
+		const auto& device = Vulkan::SelectDevice(devices, override);
+
+		std::cout << "Selected device: '" << device.Name() << "'" << std::endl;
+
+		application.SetPhysicalDevice(device);
 	}
 }
 
 int main(int argc, const char* argv[]) noexcept {
 	try {
+		const Options options = ParseOptions(argc, argv);
+
+		if (!options.LogFile.empty())
+			Utilities::Log::Open(options.LogFile);
+
 		const Vulkan::WindowConfig windowConfig
 		{
 			"Vulkan Triangle",
@@ -99,14 +215,42 @@ int main(int argc, const char* argv[]) noexcept {
 			true
 		};
 
-		TriangleApp application(windowConfig);
+		TriangleApp application(windowConfig, options.LowLatency, options.HostAllocator);
 
 		PrintVulkanSdkInformation();
 		PrintVulkanInstanceInformation(application);
-		PrintVulkanDevices(application);
-		SetVulkanDevice(application);
+
+		const auto devices = GetVulkanDevices(application);
+		PrintVulkanDevices(devices);
+
+		application.SetPostProcessing(options.PostProcessing);
+		application.SetSpriteCount(options.Sprites);
+		application.SetParticleCount(options.Particles);
+		application.SetCitySize(options.City);
+		application.SetLightCount(options.Lights);
+
+		if (!options.Font.empty())
+			application.SetFont(options.Font);
+
+		if (!options.Model.empty())
+			application.SetModel(options.Model);
+
+		// A named pipe works too, e.g. mkfifo frames.y4m && ffmpeg -i frames.y4m out.mp4
+		if (!options.Stream.empty())
+			application.SetVideoStream(options.Stream, options.StreamFormat);
+
+		SetVulkanDevice(application, devices, options.Device);
 		PrintVulkanSwapChainInformation(application);
 
+		if (!options.Benchmark.empty()) {
+			RunBenchmark(application, options.Benchmark);
+			return EXIT_SUCCESS;
+		}
+
+		// Low latency runs always report their input to present latency
+		if (options.Stats || options.LowLatency)
+			application.SetStatsInterval(1.0);
+
 		application.Run();
 
 		return EXIT_SUCCESS;
@@ -114,20 +258,15 @@ int main(int argc, const char* argv[]) noexcept {
 	}
 
 	catch (const std::exception& exception) {
-		Utilities::Console::Write(Utilities::Severity::Fatal, [&exception]()
-			{
-				std::cerr << "FATAL: " << exception.what() << std::endl;
-			});
+		LOG_FATAL("{}", exception.what());
 	}
 
 	catch (...)
 	{
-		Utilities::Console::Write(Utilities::Severity::Fatal, []()
-			{
-				std::cerr << "FATAL: caught unhandled exception" << std::endl;
-			});
+		LOG_FATAL("caught unhandled exception");
 	}
-	
+
+	Utilities::Log::Flush();
 
 	return EXIT_FAILURE;
 }